@@ -145,6 +145,7 @@ xmp_check_function(popen "stdio.h" HAVE_POPEN)
 xmp_check_function(fnmatch "fnmatch.h" HAVE_FNMATCH)
 xmp_check_function(umask "sys/stat.h" HAVE_UMASK)
 xmp_check_function(mkstemp "stdlib.h" HAVE_MKSTEMP)
+xmp_check_function(mmap "sys/mman.h" HAVE_MMAP)
 
 check_include_file(unistd.h HAVE_UNISTD_H)
 check_include_file(sys/wait.h HAVE_SYS_WAIT_H)
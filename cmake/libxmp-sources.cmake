@@ -26,6 +26,7 @@ set(LIBXMP_SRC_LIST
     src/hmn_extras.c
     src/extras.c
     src/smix.c
+    src/bus.c
     src/path.c
     src/filetype.c
     src/memio.c
@@ -206,6 +207,7 @@ set(LIBXMP_SRC_LIST_LITE
     src/lite/lite-filetype.c
     src/lite/lite-hio.c
     src/lite/lite-smix.c
+    src/lite/lite-bus.c
     src/lite/lite-memio.c
     src/lite/lite-rng.c
     src/lite/lite-win32.c
@@ -0,0 +1,135 @@
+/* Format detection benchmark for libxmp */
+/* This file is in public domain */
+
+/* Tests the given modules repeatedly and reports the time spent per
+ * test. Each loader test function is only called if the module contains
+ * one of the magic strings of the loader, or if the loader has no
+ * reliable magic; loaders late in the loader list are detected faster
+ * than with a linear scan of all loaders.
+ *
+ * The results of the tests are reduced to a hash, so they can be
+ * compared with a copy of the library built with LIBXMP_NO_FORMAT_MAGIC
+ * defined, which tests all loaders in order. Run the benchmark with both
+ * libraries on the same set of modules (e.g. all files in test-dev/data):
+ * both runs must report the same number of recognized modules and the
+ * same result hash. With -v, the format and time of each module are
+ * listed. With -f, modules are tested from files instead of memory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <xmp.h>
+
+static unsigned long hash_str(unsigned long h, const char *s)
+{
+	/* FNV-1a */
+	do {
+		h ^= (unsigned char)*s;
+		h = (h * 16777619UL) & 0xffffffffUL;
+	} while (*s++);
+
+	return h;
+}
+
+static void *read_file(const char *name, long *size)
+{
+	FILE *f;
+	void *data;
+
+	if ((f = fopen(name, "rb")) == NULL)
+		return NULL;
+
+	if (fseek(f, 0, SEEK_END) < 0 || (*size = ftell(f)) <= 0 ||
+	    fseek(f, 0, SEEK_SET) < 0) {
+		fclose(f);
+		return NULL;
+	}
+
+	if ((data = malloc(*size)) != NULL) {
+		if (fread(data, 1, *size, f) != (size_t)*size) {
+			free(data);
+			data = NULL;
+		}
+	}
+	fclose(f);
+
+	return data;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-f] [-l loops] [-v] module...\n", name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct xmp_test_info ti;
+	unsigned long hash = 2166136261UL;
+	int loops = 1000, from_file = 0, verbose = 0;
+	int tests = 0, found = 0;
+	double secs, total = 0;
+	clock_t start, end;
+	void *data = NULL;
+	long size = 0;
+	int i, j, ret;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-f")) {
+			from_file = 1;
+		} else if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+			loops = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-v")) {
+			verbose = 1;
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (i >= argc || loops < 1)
+		usage(argv[0]);
+
+	for (; i < argc; i++) {
+		if (!from_file && (data = read_file(argv[i], &size)) == NULL)
+			continue;
+
+		ret = -1;
+		start = clock();
+		for (j = 0; j < loops; j++) {
+			if (from_file) {
+				ret = xmp_test_module(argv[i], &ti);
+			} else {
+				ret = xmp_test_module_from_memory(data, size, &ti);
+			}
+		}
+		end = clock();
+		free(data);
+		data = NULL;
+
+		secs = (double)(end - start) / CLOCKS_PER_SEC;
+		total += secs;
+		tests++;
+
+		if (ret == 0) {
+			found++;
+			hash = hash_str(hash, ti.type);
+			hash = hash_str(hash, ti.name);
+		} else {
+			hash = hash_str(hash, "");
+		}
+
+		if (verbose) {
+			printf("%10.2f us  %-32.32s %s\n", secs * 1e6 / loops,
+			       ret == 0 ? ti.type : "-", argv[i]);
+		}
+	}
+
+	printf("modules:          %d (%d recognized)\n", tests, found);
+	printf("result hash:      %08lx\n", hash);
+	printf("time:             %.3f s\n", total);
+	if (tests > 0)
+		printf("per test:         %.2f us\n", total * 1e6 / (tests * (double)loops));
+
+	return 0;
+}
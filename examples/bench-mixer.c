@@ -0,0 +1,241 @@
+/* Mixer benchmark for libxmp */
+/* This file is in public domain */
+
+/* Renders a module as fast as possible and reports the time spent per
+ * tick and per active voice. Use a module with many voices in use, such
+ * as an IT module with new note actions, and a high number of mixer
+ * voices to measure the per-voice overhead of the software mixer. Short
+ * ticks, as used in modules with a high BPM, can be simulated with the
+ * tempo factor: a factor of 0.25 makes each tick four times shorter.
+ *
+ * If no module is given, a 64-channel IT module is generated in memory.
+ * It plays a note on every channel in every row with the "continue" new
+ * note action, so all mixer voices are in use after a few rows. With -f,
+ * the instrument has a looped filter envelope, so all voices use the
+ * resonant filter and its coefficients change on every tick.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <xmp.h>
+
+#define CHANNELS	64
+#define ROWS		64
+#define SMP_LEN		2000
+
+static void put16(unsigned char *p, int val)
+{
+	p[0] = val & 0xff;
+	p[1] = (val >> 8) & 0xff;
+}
+
+static void put32(unsigned char *p, long val)
+{
+	put16(p, val & 0xffff);
+	put16(p + 2, (val >> 16) & 0xffff);
+}
+
+/* Generate an IT module with one instrument, one looped sample and one
+ * pattern with a note in every row of every channel. */
+static unsigned char *make_module(int filter, long *size)
+{
+	long ins_ofs, smp_ofs, pat_ofs, data_ofs, pat_len;
+	unsigned char *m, *p;
+	int row, chn;
+
+	ins_ofs = 192 + 2 + 12;
+	smp_ofs = ins_ofs + 554;
+	pat_ofs = smp_ofs + 80;
+	pat_len = ROWS * (CHANNELS * 4 + 1);
+	data_ofs = pat_ofs + 8 + pat_len;
+	*size = data_ofs + SMP_LEN;
+
+	if ((m = (unsigned char *)calloc(1, *size)) == NULL)
+		return NULL;
+
+	/* Module header */
+	memcpy(m, "IMPM", 4);
+	memcpy(m + 4, "voice benchmark", 15);
+	put16(m + 32, 2);		/* orders */
+	put16(m + 34, 1);		/* instruments */
+	put16(m + 36, 1);		/* samples */
+	put16(m + 38, 1);		/* patterns */
+	put16(m + 40, 0x0214);
+	put16(m + 42, 0x0214);
+	put16(m + 44, 0x0d);		/* stereo, instruments, linear */
+	m[48] = 128;			/* global volume */
+	m[49] = 48;			/* mix volume */
+	m[50] = 6;			/* speed */
+	m[51] = 125;			/* tempo */
+	m[52] = 128;			/* separation */
+	memset(m + 64, 32, 64);		/* channel pan */
+	memset(m + 128, 64, 64);	/* channel volume */
+	m[192] = 0;
+	m[193] = 255;
+	put32(m + 194, ins_ofs);
+	put32(m + 198, smp_ofs);
+	put32(m + 202, pat_ofs);
+
+	/* Instrument, continue new note action */
+	p = m + ins_ofs;
+	memcpy(p, "IMPI", 4);
+	p[17] = 1;			/* NNA continue */
+	put16(p + 20, 0);		/* fadeout */
+	p[23] = 60;
+	p[24] = 128;			/* global volume */
+	p[25] = 32 | 0x80;		/* no default pan */
+	for (row = 0; row < 120; row++) {
+		p[64 + row * 2] = row;
+		p[64 + row * 2 + 1] = 1;
+	}
+
+	/* Filter envelope sweeping the whole cutoff range */
+	if (filter) {
+		p[58] = 0x80 | 127;	/* initial cutoff */
+		p[59] = 0x80 | 96;	/* initial resonance */
+		p += 468;
+		p[0] = 0x83;		/* envelope on, loop, filter */
+		p[1] = 3;		/* points */
+		p[3] = 2;		/* loop end */
+		p[6] = (unsigned char)-32;
+		p[9] = 32;
+		put16(p + 10, 8);
+		p[12] = (unsigned char)-32;
+		put16(p + 13, 16);
+	}
+
+	/* Looped 8-bit sample */
+	p = m + smp_ofs;
+	memcpy(p, "IMPS", 4);
+	p[17] = 64;			/* global volume */
+	p[18] = 0x11;			/* sample present, looped */
+	p[19] = 64;			/* volume */
+	p[46] = 1;			/* signed samples */
+	p[47] = 32;
+	put32(p + 48, SMP_LEN);
+	put32(p + 52, 0);
+	put32(p + 56, SMP_LEN);
+	put32(p + 60, 8363);
+	put32(p + 72, data_ofs);
+	for (row = 0; row < SMP_LEN; row++) {
+		m[data_ofs + row] = (row * 17) & 0x3f;
+	}
+
+	/* Pattern */
+	p = m + pat_ofs;
+	put16(p, pat_len);
+	put16(p + 2, ROWS);
+	p += 8;
+	for (row = 0; row < ROWS; row++) {
+		for (chn = 0; chn < CHANNELS; chn++) {
+			*p++ = (chn + 1) | 0x80;
+			*p++ = 0x03;		/* note and instrument */
+			*p++ = 36 + (row * 7 + chn * 5) % 48;
+			*p++ = 1;
+		}
+		*p++ = 0;
+	}
+
+	return m;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-f] [-i interp] [-l loops] [-t tempo_factor] "
+		"[-v voices] [module]\n", name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct xmp_frame_info fi;
+	xmp_context ctx;
+	int interp = XMP_INTERP_LINEAR;
+	int voices = 256, loops = 1, filter = 0;
+	double factor = 1.0, secs;
+	double ticks = 0, voice_ticks = 0, samples = 0;
+	clock_t start, end;
+	unsigned char *data;
+	long size;
+	int i, ret;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-f")) {
+			filter = 1;
+		} else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+			interp = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+			loops = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+			factor = atof(argv[++i]);
+		} else if (!strcmp(argv[i], "-v") && i + 1 < argc) {
+			voices = atoi(argv[++i]);
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (i + 1 < argc)
+		usage(argv[0]);
+
+	if ((ctx = xmp_create_context()) == NULL)
+		return 1;
+
+	if (i < argc) {
+		ret = xmp_load_module(ctx, argv[i]);
+	} else {
+		if ((data = make_module(filter, &size)) == NULL)
+			return 1;
+		ret = xmp_load_module_from_memory(ctx, data, size);
+		free(data);
+	}
+	if (ret < 0) {
+		fprintf(stderr, "%s: error loading module\n", argv[0]);
+		return 1;
+	}
+
+	xmp_set_player(ctx, XMP_PLAYER_VOICES, voices);
+
+	if (xmp_start_player(ctx, 44100, 0) < 0) {
+		fprintf(stderr, "%s: error starting player\n", argv[0]);
+		return 1;
+	}
+
+	xmp_set_player(ctx, XMP_PLAYER_INTERP, interp);
+	if (xmp_set_tempo_factor(ctx, factor) < 0) {
+		fprintf(stderr, "%s: invalid tempo factor\n", argv[0]);
+		return 1;
+	}
+
+	start = clock();
+	while (xmp_play_frame(ctx) == 0) {
+		xmp_get_frame_info(ctx, &fi);
+		if (fi.loop_count >= loops)
+			break;
+		ticks++;
+		voice_ticks += fi.virt_used;
+		samples += fi.buffer_size / 4;
+	}
+	end = clock();
+
+	secs = (double)(end - start) / CLOCKS_PER_SEC;
+
+	printf("ticks:            %.0f (%.0f samples/tick)\n", ticks,
+	       ticks > 0 ? samples / ticks : 0);
+	printf("active voices:    %.1f per tick\n",
+	       ticks > 0 ? voice_ticks / ticks : 0);
+	printf("time:             %.3f s (%.1fx realtime)\n", secs,
+	       secs > 0 ? samples / 44100 / secs : 0);
+	if (ticks > 0)
+		printf("per tick:         %.2f us\n", secs * 1e6 / ticks);
+	if (voice_ticks > 0)
+		printf("per voice/tick:   %.1f ns\n", secs * 1e9 / voice_ticks);
+
+	xmp_end_player(ctx);
+	xmp_release_module(ctx);
+	xmp_free_context(ctx);
+
+	return 0;
+}
@@ -0,0 +1,240 @@
+/* Voice allocation benchmark for libxmp */
+/* This file is in public domain */
+
+/* Plays synthetic "NNA storm" modules without mixing and reports the time
+ * spent per row and per note. The modules are IT modules with a note in
+ * every row of every channel and new note actions that keep the previous
+ * notes playing in the background, so all mixer voices are in use and
+ * most new notes must steal a background voice:
+ *
+ *   cont   notes continue playing (NNA continue)
+ *   off    notes are released and decay with the volume envelope
+ *   fade   notes fade out (NNA fade)
+ *
+ * Frames are played by seeking, which advances the player and the voices
+ * without mixing, so the time measured is mostly spent in the player and
+ * in the virtual channel and voice allocation code.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <xmp.h>
+
+#define CHANNELS	64
+#define ROWS		64
+#define ORDERS		8
+#define SPEED		3
+#define SMP_LEN		2000
+
+static void put16(unsigned char *p, int val)
+{
+	p[0] = val & 0xff;
+	p[1] = (val >> 8) & 0xff;
+}
+
+static void put32(unsigned char *p, long val)
+{
+	put16(p, val & 0xffff);
+	put16(p + 2, (val >> 16) & 0xffff);
+}
+
+/* Generate an IT module with one instrument using the given new note
+ * action, one looped sample and one pattern with a note in every row of
+ * every channel. */
+static unsigned char *make_module(int nna, long *size)
+{
+	long ord_ofs, ins_ofs, smp_ofs, pat_ofs, data_ofs, pat_len;
+	unsigned char *m, *p;
+	int row, chn;
+
+	ord_ofs = 192;
+	ins_ofs = ord_ofs + ORDERS + 1 + 12;
+	smp_ofs = ins_ofs + 554;
+	pat_ofs = smp_ofs + 80;
+	pat_len = ROWS * (CHANNELS * 5 + 1);
+	data_ofs = pat_ofs + 8 + pat_len;
+	*size = data_ofs + SMP_LEN;
+
+	if ((m = (unsigned char *)calloc(1, *size)) == NULL)
+		return NULL;
+
+	/* Module header */
+	memcpy(m, "IMPM", 4);
+	memcpy(m + 4, "voice allocation benchmark", 26);
+	put16(m + 32, ORDERS + 1);	/* orders */
+	put16(m + 34, 1);		/* instruments */
+	put16(m + 36, 1);		/* samples */
+	put16(m + 38, 1);		/* patterns */
+	put16(m + 40, 0x0214);
+	put16(m + 42, 0x0214);
+	put16(m + 44, 0x0d);		/* stereo, instruments, linear */
+	m[48] = 128;			/* global volume */
+	m[49] = 48;			/* mix volume */
+	m[50] = SPEED;			/* speed */
+	m[51] = 125;			/* tempo */
+	m[52] = 128;			/* separation */
+	memset(m + 64, 32, 64);		/* channel pan */
+	memset(m + 128, 64, 64);	/* channel volume */
+	memset(m + ord_ofs, 0, ORDERS);
+	m[ord_ofs + ORDERS] = 255;
+	put32(m + ord_ofs + ORDERS + 1, ins_ofs);
+	put32(m + ord_ofs + ORDERS + 5, smp_ofs);
+	put32(m + ord_ofs + ORDERS + 9, pat_ofs);
+
+	/* Instrument */
+	p = m + ins_ofs;
+	memcpy(p, "IMPI", 4);
+	p[17] = nna;
+	put16(p + 20, nna == 3 ? 64 : 0);	/* fadeout */
+	p[23] = 60;
+	p[24] = 128;			/* global volume */
+	p[25] = 32 | 0x80;		/* no default pan */
+	for (row = 0; row < 120; row++) {
+		p[64 + row * 2] = row;
+		p[64 + row * 2 + 1] = 1;
+	}
+
+	/* Volume envelope with sustain, decays when the note is released */
+	if (nna == 2) {
+		p += 304;
+		p[0] = 0x05;		/* envelope on, sustain loop */
+		p[1] = 3;		/* points */
+		p[4] = p[5] = 1;	/* sustain point */
+		p[6] = 64;
+		p[9] = 64;
+		put16(p + 10, 4);
+		p[12] = 0;
+		put16(p + 13, 64);
+	}
+
+	/* Looped 8-bit sample */
+	p = m + smp_ofs;
+	memcpy(p, "IMPS", 4);
+	p[17] = 64;			/* global volume */
+	p[18] = 0x11;			/* sample present, looped */
+	p[19] = 64;			/* volume */
+	p[46] = 1;			/* signed samples */
+	p[47] = 32;
+	put32(p + 48, SMP_LEN);
+	put32(p + 52, 0);
+	put32(p + 56, SMP_LEN);
+	put32(p + 60, 8363);
+	put32(p + 72, data_ofs);
+	for (row = 0; row < SMP_LEN; row++) {
+		m[data_ofs + row] = (row * 17) & 0x3f;
+	}
+
+	/* Pattern, with a different volume for each note */
+	p = m + pat_ofs;
+	put16(p, pat_len);
+	put16(p + 2, ROWS);
+	p += 8;
+	for (row = 0; row < ROWS; row++) {
+		for (chn = 0; chn < CHANNELS; chn++) {
+			*p++ = (chn + 1) | 0x80;
+			*p++ = 0x07;		/* note, instrument, volume */
+			*p++ = 36 + (row * 7 + chn * 5) % 48;
+			*p++ = 1;
+			*p++ = 1 + (row * 13 + chn * 29) % 64;
+		}
+		*p++ = 0;
+	}
+
+	return m;
+}
+
+static int run(const char *name, int nna, int voices, int loops)
+{
+	struct xmp_frame_info fi;
+	xmp_context ctx;
+	double secs, rows = 0, voice_rows = 0;
+	clock_t start, end;
+	unsigned char *data;
+	long size;
+	int i, j, ret, order_time;
+
+	if ((ctx = xmp_create_context()) == NULL)
+		return -1;
+
+	if ((data = make_module(nna, &size)) == NULL)
+		return -1;
+	ret = xmp_load_module_from_memory(ctx, data, size);
+	free(data);
+	if (ret < 0) {
+		fprintf(stderr, "error loading module\n");
+		return -1;
+	}
+
+	xmp_set_player(ctx, XMP_PLAYER_VOICES, voices);
+
+	if (xmp_start_player(ctx, 44100, 0) < 0) {
+		fprintf(stderr, "error starting player\n");
+		return -1;
+	}
+
+	xmp_get_frame_info(ctx, &fi);
+	order_time = fi.total_time / ORDERS;
+
+	start = clock();
+	for (i = 0; i < loops; i++) {
+		for (j = 0; j < ORDERS; j++) {
+			xmp_seek_time_frame(ctx, j * order_time + order_time - 1);
+			xmp_get_frame_info(ctx, &fi);
+			rows += fi.row;
+			voice_rows += fi.row * fi.virt_used;
+		}
+	}
+	end = clock();
+
+	secs = (double)(end - start) / CLOCKS_PER_SEC;
+
+	printf("%-6s %6d %10.1f %12.2f %12.1f\n", name, voices,
+	       rows > 0 ? voice_rows / rows : 0,
+	       rows > 0 ? secs * 1e6 / rows : 0,
+	       rows > 0 ? secs * 1e9 / (rows * CHANNELS) : 0);
+
+	xmp_end_player(ctx);
+	xmp_release_module(ctx);
+	xmp_free_context(ctx);
+
+	return 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-l loops] [-v voices] [cont|off|fade]\n",
+		name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	static const char *const names[] = { "cont", "off", "fade" };
+	int voices = 256, loops = 20;
+	int i, j;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+			loops = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-v") && i + 1 < argc) {
+			voices = atoi(argv[++i]);
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (i + 1 < argc)
+		usage(argv[0]);
+
+	printf("module voices   in use/row   us per row  ns per note\n");
+
+	for (j = 0; j < 3; j++) {
+		if (i < argc && strcmp(argv[i], names[j]))
+			continue;
+		if (run(names[j], j + 1, voices, loops) < 0)
+			return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,224 @@
+/* Multi-threaded sample decoder for libxmp */
+/* This file is in public domain */
+
+/* Loads a module with XMP_SMPCTL_LAZY, which keeps compressed samples
+ * (IT 2.14/2.15 compressed samples, Ogg Vorbis samples in OXM modules)
+ * without decoding them, and then decodes the samples on a pool of
+ * threads with xmp_decode_sample(). Each sample is decoded from its own
+ * copy of the compressed data, so different samples of the same module
+ * can be decoded concurrently. The module is also loaded serially, and
+ * the time of both loads is reported.
+ *
+ * With -c, the samples decoded in parallel are compared against the
+ * samples of the serial load.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include <xmp.h>
+
+#define MAX_THREADS	64
+
+struct pool {
+	xmp_context ctx;
+	int num_samples;
+	int next;		/* next sample to decode */
+	int error;
+	pthread_mutex_t lock;
+};
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void *decode_samples(void *arg)
+{
+	struct pool *pool = (struct pool *)arg;
+	int smp;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		smp = pool->next++;
+		pthread_mutex_unlock(&pool->lock);
+
+		if (smp >= pool->num_samples)
+			break;
+
+		if (xmp_decode_sample(pool->ctx, smp) < 0) {
+			pthread_mutex_lock(&pool->lock);
+			pool->error = 1;
+			pthread_mutex_unlock(&pool->lock);
+		}
+	}
+
+	return NULL;
+}
+
+static int sample_size(const struct xmp_sample *xxs)
+{
+	int size = xxs->len;
+
+	if (xxs->flg & XMP_SAMPLE_16BIT)
+		size *= 2;
+	if (xxs->flg & XMP_SAMPLE_STEREO)
+		size *= 2;
+
+	return size;
+}
+
+static int compare_samples(xmp_context c1, xmp_context c2)
+{
+	struct xmp_module_info info1, info2;
+	int i, diff = 0;
+
+	xmp_get_module_info(c1, &info1);
+	xmp_get_module_info(c2, &info2);
+
+	for (i = 0; i < info1.mod->smp; i++) {
+		struct xmp_sample *xxs1 = &info1.mod->xxs[i];
+		struct xmp_sample *xxs2 = &info2.mod->xxs[i];
+
+		if (xxs1->len != xxs2->len || xxs1->flg != xxs2->flg ||
+		    (xxs1->data == NULL) != (xxs2->data == NULL) ||
+		    (xxs1->data != NULL && memcmp(xxs1->data, xxs2->data,
+						  sample_size(xxs1)) != 0)) {
+			printf("sample %d differs\n", i);
+			diff++;
+		}
+	}
+
+	return diff;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-c] [-j threads] [-l loops] module\n",
+		name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct xmp_module_info info;
+	pthread_t thread[MAX_THREADS];
+	struct pool pool;
+	xmp_context serial = NULL, parallel = NULL;
+	int threads = 4, loops = 1, compare = 0;
+	double start, t_serial = 0, t_load = 0, t_decode = 0;
+	void *data;
+	long size;
+	FILE *f;
+	int i, j, n, ret = 0;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-c")) {
+			compare = 1;
+		} else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+			threads = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+			loops = atoi(argv[++i]);
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (i + 1 != argc || threads < 1 || threads > MAX_THREADS || loops < 1)
+		usage(argv[0]);
+
+	if ((f = fopen(argv[i], "rb")) == NULL) {
+		perror(argv[i]);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size <= 0 || (data = malloc(size)) == NULL ||
+	    fread(data, 1, size, f) != (size_t)size) {
+		fprintf(stderr, "%s: can't read %s\n", argv[0], argv[i]);
+		return 1;
+	}
+	fclose(f);
+
+	if (pthread_mutex_init(&pool.lock, NULL) != 0)
+		return 1;
+
+	for (j = 0; j < loops; j++) {
+		/* Serial load, samples are decoded by the loader */
+		if (serial != NULL)
+			xmp_free_context(serial);
+		if ((serial = xmp_create_context()) == NULL)
+			return 1;
+
+		start = now();
+		if (xmp_load_module_from_memory(serial, data, size) < 0) {
+			fprintf(stderr, "%s: error loading %s\n", argv[0], argv[i]);
+			return 1;
+		}
+		t_serial += now() - start;
+
+		/* Lazy load, then decode the samples in parallel */
+		if (parallel != NULL)
+			xmp_free_context(parallel);
+		if ((parallel = xmp_create_context()) == NULL)
+			return 1;
+		xmp_set_player(parallel, XMP_PLAYER_SMPCTL, XMP_SMPCTL_LAZY);
+
+		start = now();
+		if (xmp_load_module_from_memory(parallel, data, size) < 0) {
+			fprintf(stderr, "%s: error loading %s\n", argv[0], argv[i]);
+			return 1;
+		}
+		t_load += now() - start;
+
+		xmp_get_module_info(parallel, &info);
+		pool.ctx = parallel;
+		pool.num_samples = info.mod->smp;
+		pool.next = 0;
+		pool.error = 0;
+
+		start = now();
+		for (n = 0; n < threads; n++) {
+			if (pthread_create(&thread[n], NULL, decode_samples,
+					   &pool) != 0)
+				break;
+		}
+		if (n == 0) {
+			/* No threads available, decode in this thread */
+			decode_samples(&pool);
+		}
+		while (n > 0)
+			pthread_join(thread[--n], NULL);
+		t_decode += now() - start;
+
+		if (pool.error) {
+			fprintf(stderr, "%s: error decoding samples\n", argv[0]);
+			ret = 1;
+		}
+	}
+
+	printf("samples:          %d\n", info.mod->smp);
+	printf("serial load:      %.2f ms\n", t_serial * 1000 / loops);
+	printf("parallel load:    %.2f ms (%.2f ms load, %.2f ms decode, "
+	       "%d threads)\n", (t_load + t_decode) * 1000 / loops,
+	       t_load * 1000 / loops, t_decode * 1000 / loops, threads);
+
+	if (compare) {
+		n = compare_samples(serial, parallel);
+		printf("compare:          %s\n", n ? "mismatch" : "identical");
+		if (n)
+			ret = 1;
+	}
+
+	xmp_free_context(serial);
+	xmp_free_context(parallel);
+	pthread_mutex_destroy(&pool.lock);
+	free(data);
+
+	return ret;
+}
@@ -0,0 +1,481 @@
+/* Real-time frontend for libxmp with a render thread */
+/* This file is in public domain */
+
+/* The module is rendered ahead of playback by a worker thread running
+ * xmp_play_frame() into a single-producer, single-consumer ring buffer,
+ * and the audio callback only copies from the ring. Loading modules,
+ * seeking or rendering an expensive tick happen outside the callback,
+ * so they don't cause underruns as long as the ring holds enough audio.
+ *
+ * The player context is only used by the worker thread. Control requests
+ * from the main thread are queued as commands in a second ring and are
+ * applied between frames. After a position change the audio already in
+ * the ring is dropped, so the new position is heard right away.
+ *
+ * Commands are read from standard input, one per line:
+ *   n / p        next / previous position
+ *   g <pos>      go to position
+ *   m <chn>      toggle channel mute
+ *   i <chn> <note> <ins>  play a note
+ *   t <factor>   set tempo factor
+ *   q            quit
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include "SDL.h"
+#include <xmp.h>
+
+#define RATE		44100
+#define FRAME_BYTES	4	/* 16-bit stereo */
+#define MAX_COMMANDS	64
+
+enum {
+	CMD_NEXT_POSITION,
+	CMD_PREV_POSITION,
+	CMD_SET_POSITION,
+	CMD_CHANNEL_MUTE,
+	CMD_INJECT_EVENT,
+	CMD_TEMPO_FACTOR,
+	CMD_STOP
+};
+
+struct command {
+	int type;
+	int arg1;
+	int arg2;
+	double factor;
+	struct xmp_event event;
+};
+
+/* Audio ring. The worker thread only advances head and the audio
+ * callback only advances tail; both counters grow without wrapping
+ * and are reduced modulo the (power of two) ring size when used.
+ */
+struct ring {
+	unsigned char *data;
+	size_t size;
+	size_t fill;		/* amount of audio to render ahead */
+	atomic_size_t head;
+	atomic_size_t tail;
+	atomic_size_t skip_to;	/* drop audio queued before this offset */
+};
+
+struct player {
+	xmp_context ctx;
+	struct ring audio;
+
+	/* Commands from the main thread to the worker thread */
+	struct command cmd[MAX_COMMANDS];
+	atomic_uint cmd_head;
+	atomic_uint cmd_tail;
+
+	/* Worker state published for the main thread */
+	atomic_int pos;
+	atomic_int row;
+	atomic_int done;
+	atomic_int underruns;
+
+	pthread_t thread;
+};
+
+static size_t ring_used(struct ring *r)
+{
+	return atomic_load_explicit(&r->head, memory_order_acquire) -
+		atomic_load_explicit(&r->tail, memory_order_relaxed);
+}
+
+/* Called by the worker thread only */
+static void ring_write(struct ring *r, const unsigned char *buf, size_t len)
+{
+	size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+	size_t offset = head & (r->size - 1);
+	size_t n = r->size - offset;
+
+	if (n > len)
+		n = len;
+	memcpy(r->data + offset, buf, n);
+	memcpy(r->data, buf + n, len - n);
+
+	atomic_store_explicit(&r->head, head + len, memory_order_release);
+}
+
+/* Called by the audio callback only */
+static size_t ring_read(struct ring *r, unsigned char *buf, size_t len)
+{
+	size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+	size_t skip, head, offset, n;
+
+	/* skip_to is a past value of head, so load it first: head is then
+	 * never behind it */
+	skip = atomic_load_explicit(&r->skip_to, memory_order_acquire);
+	head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+	if ((ptrdiff_t)(skip - tail) > 0)
+		tail = skip;
+	if (len > head - tail)
+		len = head - tail;
+
+	offset = tail & (r->size - 1);
+	n = r->size - offset;
+	if (n > len)
+		n = len;
+	memcpy(buf, r->data + offset, n);
+	memcpy(buf + n, r->data, len - n);
+
+	atomic_store_explicit(&r->tail, tail + len, memory_order_release);
+
+	return len;
+}
+
+/* Called by the main thread only. Returns -1 if the queue is full. */
+static int send_command(struct player *pl, const struct command *c)
+{
+	unsigned int head = atomic_load_explicit(&pl->cmd_head, memory_order_relaxed);
+	unsigned int tail = atomic_load_explicit(&pl->cmd_tail, memory_order_acquire);
+
+	if (head - tail >= MAX_COMMANDS)
+		return -1;
+
+	pl->cmd[head % MAX_COMMANDS] = *c;
+	atomic_store_explicit(&pl->cmd_head, head + 1, memory_order_release);
+
+	return 0;
+}
+
+/* Apply the queued commands in the worker thread, between frames.
+ * Returns 1 if playback should stop. */
+static int apply_commands(struct player *pl)
+{
+	unsigned int tail = atomic_load_explicit(&pl->cmd_tail, memory_order_relaxed);
+	unsigned int head = atomic_load_explicit(&pl->cmd_head, memory_order_acquire);
+	struct ring *r = &pl->audio;
+	int stop = 0, flush = 0;
+
+	for (; tail != head; tail++) {
+		struct command *c = &pl->cmd[tail % MAX_COMMANDS];
+
+		switch (c->type) {
+		case CMD_NEXT_POSITION:
+			xmp_next_position(pl->ctx);
+			flush = 1;
+			break;
+		case CMD_PREV_POSITION:
+			xmp_prev_position(pl->ctx);
+			flush = 1;
+			break;
+		case CMD_SET_POSITION:
+			xmp_set_position(pl->ctx, c->arg1);
+			flush = 1;
+			break;
+		case CMD_CHANNEL_MUTE:
+			xmp_channel_mute(pl->ctx, c->arg1, c->arg2);
+			break;
+		case CMD_INJECT_EVENT:
+			xmp_inject_event(pl->ctx, c->arg1, &c->event);
+			break;
+		case CMD_TEMPO_FACTOR:
+			xmp_set_tempo_factor(pl->ctx, c->factor);
+			break;
+		case CMD_STOP:
+			stop = 1;
+			break;
+		}
+	}
+	atomic_store_explicit(&pl->cmd_tail, tail, memory_order_release);
+
+	/* Audio rendered before a position change is not played */
+	if (flush) {
+		atomic_store_explicit(&r->skip_to,
+			atomic_load_explicit(&r->head, memory_order_relaxed),
+			memory_order_release);
+	}
+
+	return stop;
+}
+
+static void *render_thread(void *arg)
+{
+	struct player *pl = (struct player *)arg;
+	struct ring *r = &pl->audio;
+	struct xmp_frame_info fi;
+
+	for (;;) {
+		if (apply_commands(pl))
+			break;
+
+		if (xmp_play_frame(pl->ctx) < 0)
+			break;
+		xmp_get_frame_info(pl->ctx, &fi);
+		if (fi.loop_count > 0)
+			break;
+
+		/* Wait until the ring needs more audio and the whole
+		 * frame fits in it */
+		while (ring_used(r) >= r->fill ||
+		       r->size - ring_used(r) < (size_t)fi.buffer_size) {
+			usleep(1000);
+		}
+		ring_write(r, fi.buffer, fi.buffer_size);
+
+		atomic_store_explicit(&pl->pos, fi.pos, memory_order_relaxed);
+		atomic_store_explicit(&pl->row, fi.row, memory_order_relaxed);
+	}
+
+	atomic_store_explicit(&pl->done, 1, memory_order_release);
+
+	return NULL;
+}
+
+static void fill_audio(void *udata, Uint8 *stream, int len)
+{
+	struct player *pl = (struct player *)udata;
+	size_t n;
+
+	n = ring_read(&pl->audio, stream, len);
+	if (n < (size_t)len) {
+		memset(stream + n, 0, len - n);
+		if (!atomic_load_explicit(&pl->done, memory_order_relaxed))
+			atomic_fetch_add_explicit(&pl->underruns, 1,
+						  memory_order_relaxed);
+	}
+}
+
+static int sdl_init(struct player *pl, int samples)
+{
+	SDL_AudioSpec a;
+
+	if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+		fprintf(stderr, "sdl: can't initialize: %s\n", SDL_GetError());
+		return -1;
+	}
+
+	a.freq = RATE;
+	a.format = AUDIO_S16;
+	a.channels = 2;
+	a.samples = samples;
+	a.callback = fill_audio;
+	a.userdata = pl;
+
+	if (SDL_OpenAudio(&a, NULL) < 0) {
+		fprintf(stderr, "%s\n", SDL_GetError());
+		return -1;
+	}
+
+	return 0;
+}
+
+static void sdl_deinit(void)
+{
+	SDL_CloseAudio();
+}
+
+static int sdl_poll_exit(void)
+{
+	SDL_Event ev;
+
+	while (SDL_PollEvent(&ev)) {
+		switch (ev.type) {
+		case SDL_QUIT:
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Read a command line from standard input without blocking. Returns 1
+ * to quit. */
+static int input_closed;
+
+static int read_command(struct player *pl, int *mute)
+{
+	struct timeval tv;
+	struct command c;
+	fd_set fds;
+	char line[80];
+	int chn, note, ins;
+
+	tv.tv_sec = 0;
+	tv.tv_usec = 10000;
+
+	if (input_closed) {
+		select(0, NULL, NULL, NULL, &tv);
+		return 0;
+	}
+
+	FD_ZERO(&fds);
+	FD_SET(0, &fds);
+
+	if (select(1, &fds, NULL, NULL, &tv) <= 0)
+		return 0;
+	if (fgets(line, sizeof(line), stdin) == NULL) {
+		input_closed = 1;
+		return 0;
+	}
+
+	memset(&c, 0, sizeof(struct command));
+
+	switch (line[0]) {
+	case 'n':
+		c.type = CMD_NEXT_POSITION;
+		break;
+	case 'p':
+		c.type = CMD_PREV_POSITION;
+		break;
+	case 'g':
+		c.type = CMD_SET_POSITION;
+		c.arg1 = atoi(line + 1);
+		break;
+	case 'i':
+		if (sscanf(line + 1, "%d %d %d", &chn, &note, &ins) != 3)
+			return 0;
+		c.type = CMD_INJECT_EVENT;
+		c.arg1 = chn;
+		c.event.note = note;
+		c.event.ins = ins;
+		break;
+	case 'm':
+		chn = atoi(line + 1);
+		if (chn < 0 || chn >= XMP_MAX_CHANNELS)
+			return 0;
+		mute[chn] = !mute[chn];
+		c.type = CMD_CHANNEL_MUTE;
+		c.arg1 = chn;
+		c.arg2 = mute[chn];
+		break;
+	case 't':
+		c.type = CMD_TEMPO_FACTOR;
+		c.factor = atof(line + 1);
+		break;
+	case 'q':
+		return 1;
+	default:
+		return 0;
+	}
+
+	if (send_command(pl, &c) < 0)
+		fprintf(stderr, "command queue full\n");
+
+	return 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-b buffer_ms] [-s samples] module...\n",
+		name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct player pl;
+	struct xmp_module_info mi;
+	struct command stop;
+	int mute[XMP_MAX_CHANNELS];
+	int buffer_ms = 100, samples = 64, quit = 0;
+	size_t size;
+	int i;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+			buffer_ms = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+			samples = atoi(argv[++i]);
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (i >= argc || buffer_ms <= 0 || samples <= 0)
+		usage(argv[0]);
+
+	memset(&pl, 0, sizeof(struct player));
+
+	/* Render up to buffer_ms ahead. The ring must also hold the largest
+	 * frame on top of that, at the slowest tempo. */
+	pl.audio.fill = (size_t)RATE * FRAME_BYTES * buffer_ms / 1000;
+	for (size = 1; size < pl.audio.fill + XMP_MAX_FRAMESIZE * 2; size <<= 1);
+	if ((pl.audio.data = malloc(size)) == NULL) {
+		fprintf(stderr, "%s: out of memory\n", argv[0]);
+		exit(1);
+	}
+	pl.audio.size = size;
+
+	pl.ctx = xmp_create_context();
+	xmp_set_player(pl.ctx, XMP_PLAYER_DEFPAN, 50);
+
+	if (sdl_init(&pl, samples) < 0) {
+		fprintf(stderr, "%s: can't initialize sound\n", argv[0]);
+		exit(1);
+	}
+
+	for (; i < argc && !quit; i++) {
+		if (xmp_load_module(pl.ctx, argv[i]) < 0) {
+			fprintf(stderr, "%s: error loading %s\n", argv[0],
+				argv[i]);
+			continue;
+		}
+
+		if (xmp_start_player(pl.ctx, RATE, 0) == 0) {
+			xmp_get_module_info(pl.ctx, &mi);
+			printf("%s (%s)\n", mi.mod->name, mi.mod->type);
+
+			memset(mute, 0, sizeof(mute));
+			atomic_store(&pl.done, 0);
+			atomic_store(&pl.underruns, 0);
+
+			if (pthread_create(&pl.thread, NULL, render_thread, &pl) != 0) {
+				fprintf(stderr, "%s: can't create thread\n",
+					argv[0]);
+				xmp_end_player(pl.ctx);
+				xmp_release_module(pl.ctx);
+				break;
+			}
+
+			/* Let the worker fill the ring before starting playback */
+			while (!atomic_load(&pl.done) &&
+			       ring_used(&pl.audio) < pl.audio.fill) {
+				usleep(1000);
+			}
+			SDL_PauseAudio(0);
+
+			/* Play until the worker is done and the ring is empty */
+			while (!atomic_load(&pl.done) || ring_used(&pl.audio) > 0) {
+				if (read_command(&pl, mute) || sdl_poll_exit()) {
+					quit = 1;
+					break;
+				}
+				printf("%3d/%3d %3d  underruns: %d\r",
+					atomic_load(&pl.pos), mi.mod->len,
+					atomic_load(&pl.row),
+					atomic_load(&pl.underruns));
+				fflush(stdout);
+			}
+
+			/* The stop command can't be lost: the worker consumes
+			 * the queue after every frame. */
+			memset(&stop, 0, sizeof(struct command));
+			stop.type = CMD_STOP;
+			while (!atomic_load(&pl.done) && send_command(&pl, &stop) < 0)
+				usleep(1000);
+			pthread_join(pl.thread, NULL);
+
+			SDL_PauseAudio(1);
+			xmp_end_player(pl.ctx);
+		}
+
+		xmp_release_module(pl.ctx);
+		printf("\n");
+	}
+
+	xmp_free_context(pl.ctx);
+	sdl_deinit();
+	free(pl.audio.data);
+
+	return 0;
+}
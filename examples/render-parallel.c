@@ -0,0 +1,349 @@
+/* Offline multi-threaded renderer for libxmp */
+/* This file is in public domain */
+
+/* Splits the first sequence of a module into segments at order boundaries
+ * and renders each segment in its own player context on its own thread.
+ * Each worker starts a few seconds before its segment (pre-roll) so that
+ * voices, envelopes and effect memory settle before output is kept. The
+ * segments are then stitched together into a single raw PCM stream
+ * (signed 16-bit, stereo, native endian).
+ *
+ * With -c, the module is also rendered serially and the stitched output
+ * is compared against it, reporting the difference at each seam. Modules
+ * using random effects or relying on state older than the pre-roll will
+ * not match exactly.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <xmp.h>
+
+#define MAX_SEGMENTS	64
+
+struct pcm {
+	char *data;
+	size_t size;
+	size_t alloc;
+};
+
+struct segment {
+	int start_pos;		/* first order of the segment */
+	int start_time;		/* start time of the first order, in ms */
+	int end_pos;		/* first order of the next segment, or -1 */
+	int preroll_time;	/* time to start rendering from, in ms */
+	struct pcm out;
+	int error;
+	int threaded;
+	pthread_t thread;
+};
+
+static const void *mod_data;
+static long mod_size;
+static int rate = 44100;
+
+static int pcm_append(struct pcm *p, const void *buf, size_t size)
+{
+	if (p->size + size > p->alloc) {
+		size_t alloc = p->alloc ? p->alloc : 1 << 20;
+		char *data;
+
+		while (p->size + size > alloc)
+			alloc *= 2;
+		if ((data = realloc(p->data, alloc)) == NULL)
+			return -1;
+		p->data = data;
+		p->alloc = alloc;
+	}
+	memcpy(p->data + p->size, buf, size);
+	p->size += size;
+	return 0;
+}
+
+static xmp_context create_player(void)
+{
+	xmp_context ctx;
+
+	if ((ctx = xmp_create_context()) == NULL)
+		return NULL;
+
+	if (xmp_load_module_from_memory(ctx, mod_data, mod_size) < 0) {
+		xmp_free_context(ctx);
+		return NULL;
+	}
+
+	if (xmp_start_player(ctx, rate, 0) < 0) {
+		xmp_release_module(ctx);
+		xmp_free_context(ctx);
+		return NULL;
+	}
+
+	return ctx;
+}
+
+static void destroy_player(xmp_context ctx)
+{
+	xmp_end_player(ctx);
+	xmp_release_module(ctx);
+	xmp_free_context(ctx);
+}
+
+static void *render_segment(void *arg)
+{
+	struct segment *seg = (struct segment *)arg;
+	struct xmp_frame_info fi;
+	xmp_context ctx;
+	int pos, started = 0;
+
+	if ((ctx = create_player()) == NULL) {
+		seg->error = 1;
+		return NULL;
+	}
+
+	/* Seeks land on order boundaries, so the pre-roll may start at the
+	 * first order of the segment itself (e.g. with -p 0) and leave no
+	 * warm-up. Start from the order played before it in that case. */
+	pos = xmp_seek_time(ctx, seg->preroll_time);
+	if (pos == seg->start_pos && seg->start_time > 0) {
+		pos = xmp_seek_time(ctx, seg->start_time - 1);
+		if (pos == seg->start_pos && pos > 0)
+			xmp_set_position(ctx, pos - 1);
+	}
+
+	/* Frames are discarded until the player reaches the first order
+	 * of this segment, and rendering stops as soon as it reaches the
+	 * first order of the next one. */
+
+	while (xmp_play_frame(ctx) == 0) {
+		xmp_get_frame_info(ctx, &fi);
+		if (fi.loop_count > 0)
+			break;
+
+		if (!started) {
+			if (fi.pos != seg->start_pos)
+				continue;
+			started = 1;
+		}
+
+		if (fi.pos == seg->end_pos)
+			break;
+
+		if (pcm_append(&seg->out, fi.buffer, fi.buffer_size) < 0) {
+			seg->error = 1;
+			break;
+		}
+	}
+
+	destroy_player(ctx);
+
+	return NULL;
+}
+
+static int render_serial(struct pcm *out)
+{
+	struct xmp_frame_info fi;
+	xmp_context ctx;
+
+	if ((ctx = create_player()) == NULL)
+		return -1;
+
+	while (xmp_play_frame(ctx) == 0) {
+		xmp_get_frame_info(ctx, &fi);
+		if (fi.loop_count > 0)
+			break;
+		if (pcm_append(out, fi.buffer, fi.buffer_size) < 0)
+			break;
+	}
+
+	destroy_player(ctx);
+
+	return 0;
+}
+
+/* Use the order start times recorded by the module scan to split the
+ * sequence into segments of roughly the same duration. */
+static int split_module(struct segment *seg, int num, int preroll)
+{
+	struct xmp_frame_info fi;
+	xmp_context ctx;
+	int i, n, pos;
+
+	if ((ctx = create_player()) == NULL)
+		return -1;
+
+	xmp_get_frame_info(ctx, &fi);
+
+	for (n = i = 0; i < num; i++) {
+		pos = xmp_seek_time(ctx, (int)((double)fi.total_time * i / num));
+		if (pos < 0)
+			break;
+		if (n > 0 && pos == seg[n - 1].start_pos)
+			continue;
+
+		xmp_get_frame_info(ctx, &fi);
+		if (n > 0 && fi.time <= seg[n - 1].start_time)
+			continue;
+
+		memset(&seg[n], 0, sizeof(struct segment));
+		seg[n].start_pos = pos;
+		seg[n].start_time = fi.time;
+		seg[n].end_pos = -1;
+		if (n > 0) {
+			seg[n - 1].end_pos = pos;
+			seg[n].preroll_time = fi.time > preroll ?
+						fi.time - preroll : 0;
+		}
+		n++;
+	}
+
+	destroy_player(ctx);
+
+	return n;
+}
+
+static void check_seams(const struct segment *seg, int num,
+			const struct pcm *stitched, const struct pcm *serial)
+{
+	const short *a = (const short *)stitched->data;
+	const short *b = (const short *)serial->data;
+	size_t len = stitched->size < serial->size ?
+				stitched->size : serial->size;
+	size_t offset = 0, end, j;
+	int i;
+
+	len /= sizeof(short);
+
+	for (i = 0; i < num; i++) {
+		int max = 0;
+
+		end = offset + seg[i].out.size / sizeof(short);
+		if (end > len)
+			end = len;
+		for (j = offset; j < end; j++) {
+			int d = abs(a[j] - b[j]);
+			if (d > max)
+				max = d;
+		}
+		fprintf(stderr, "segment %2d: pos %3d, %7d ms, max diff %d\n",
+			i, seg[i].start_pos, seg[i].start_time, max);
+		offset = end;
+	}
+
+	if (stitched->size != serial->size) {
+		fprintf(stderr, "length mismatch: %lu bytes, serial %lu bytes\n",
+			(unsigned long)stitched->size,
+			(unsigned long)serial->size);
+	}
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-c] [-j threads] [-p preroll_ms] [-r rate] "
+		"module [output.raw]\n", name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct segment seg[MAX_SEGMENTS];
+	struct pcm stitched, serial;
+	int threads = 4, preroll = 4000, check = 0;
+	int i, num;
+	const char *outname = NULL;
+	FILE *f;
+	char *buf;
+	long size;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-c")) {
+			check = 1;
+		} else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+			threads = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+			preroll = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+			rate = atoi(argv[++i]);
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (i >= argc)
+		usage(argv[0]);
+	if (threads < 1 || threads > MAX_SEGMENTS)
+		threads = 1;
+
+	/* Read the module once and share the image between all workers */
+	if ((f = fopen(argv[i], "rb")) == NULL) {
+		perror(argv[i]);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size <= 0 || (buf = malloc(size)) == NULL ||
+	    fread(buf, 1, size, f) != (size_t)size) {
+		fprintf(stderr, "%s: can't read %s\n", argv[0], argv[i]);
+		fclose(f);
+		return 1;
+	}
+	fclose(f);
+	mod_data = buf;
+	mod_size = size;
+
+	if (i + 1 < argc)
+		outname = argv[i + 1];
+
+	if ((num = split_module(seg, threads, preroll)) <= 0) {
+		fprintf(stderr, "%s: error loading %s\n", argv[0], argv[i]);
+		return 1;
+	}
+
+	for (i = 0; i < num; i++) {
+		if (pthread_create(&seg[i].thread, NULL, render_segment,
+				   &seg[i]) == 0) {
+			seg[i].threaded = 1;
+		} else {
+			render_segment(&seg[i]);
+		}
+	}
+
+	memset(&stitched, 0, sizeof(struct pcm));
+	for (i = 0; i < num; i++) {
+		if (seg[i].threaded)
+			pthread_join(seg[i].thread, NULL);
+		if (seg[i].error) {
+			fprintf(stderr, "%s: error rendering segment %d\n",
+				argv[0], i);
+			return 1;
+		}
+		if (pcm_append(&stitched, seg[i].out.data, seg[i].out.size) < 0) {
+			fprintf(stderr, "%s: out of memory\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (check) {
+		memset(&serial, 0, sizeof(struct pcm));
+		if (render_serial(&serial) == 0)
+			check_seams(seg, num, &stitched, &serial);
+		free(serial.data);
+	}
+
+	if (outname != NULL) {
+		if ((f = fopen(outname, "wb")) == NULL) {
+			perror(outname);
+			return 1;
+		}
+		fwrite(stitched.data, 1, stitched.size, f);
+		fclose(f);
+	}
+
+	for (i = 0; i < num; i++)
+		free(seg[i].out.data);
+	free(stitched.data);
+	free(buf);
+
+	return 0;
+}
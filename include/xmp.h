@@ -67,6 +67,7 @@ extern "C" {
 #define XMP_FORMAT_UNSIGNED	(1 << 1) /* Mix to unsigned samples */
 #define XMP_FORMAT_MONO		(1 << 2) /* Mix to mono instead of stereo */
 #define XMP_FORMAT_32BIT	(1 << 3) /* Mix to 32-bit int instead of 16 */
+#define XMP_FORMAT_FLOAT	(1 << 4) /* Mix to 32-bit float instead of 16 */
 
 /* player parameters */
 #define XMP_PLAYER_AMP		0	/* Amplification factor */
@@ -83,6 +84,12 @@ extern "C" {
 #define XMP_PLAYER_MODE 	11	/* Player personality */
 #define XMP_PLAYER_MIXER_TYPE	12	/* Current mixer (read only) */
 #define XMP_PLAYER_VOICES	13	/* Maximum number of mixer voices */
+#define XMP_PLAYER_DEPACK_CACHE	14	/* Depacked module cache size in KB */
+#define XMP_PLAYER_DEFER_SCAN	15	/* Scan module on first use */
+#define XMP_PLAYER_SHARE_TRACKS	16	/* Share identical pattern tracks */
+#define XMP_PLAYER_CULL_VOLUME	17	/* Stop voices below this volume */
+#define XMP_PLAYER_VOICE_BUDGET	18	/* Maximum voices mixed per frame */
+#define XMP_PLAYER_CULLED	19	/* Number of voices culled */
 
 /* interpolation types */
 #define XMP_INTERP_NEAREST	0	/* Nearest neighbor */
@@ -124,6 +131,10 @@ extern "C" {
 
 /* sample flags */
 #define XMP_SMPCTL_SKIP		(1 << 0) /* Don't load samples */
+#define XMP_SMPCTL_LAZY		(1 << 1) /* Decode samples on first use */
+
+/* batch test flags */
+#define XMP_BATCH_SCAN		(1 << 0) /* Compute module duration */
 
 /* limits */
 #define XMP_MAX_KEYS		121	/* Number of valid keys */
@@ -298,6 +309,17 @@ struct xmp_test_info {
 	char type[XMP_NAME_SIZE];	/* Module format */
 };
 
+struct xmp_batch_info {
+	const char *path;		/* Module file name, or NULL */
+	const void *mem;		/* Module data, if path is NULL */
+	long size;			/* Module data size */
+	int error;			/* 0 or error code */
+	char name[XMP_NAME_SIZE];	/* Module title */
+	char type[XMP_NAME_SIZE];	/* Module format */
+	int chn;			/* Number of channels */
+	int time;			/* Duration in ms, or -1 */
+};
+
 struct xmp_module_info {
 	unsigned char md5[16];		/* MD5 message digest */
 	int vol_base;			/* Volume scale */
@@ -351,7 +373,24 @@ struct xmp_callbacks {
 	int		(*close_func)(void *priv);
 };
 
+struct xmp_allocator {
+	void		*(*alloc)(unsigned long size, void *priv);
+	void		*(*resize)(void *ptr, unsigned long size, void *priv);
+	void		(*release)(void *ptr, void *priv);
+	void		*priv;
+};
+
+struct xmp_memory_usage {
+	unsigned long patterns;		/* Patterns, tracks and instruments */
+	unsigned long samples;		/* Sample data */
+	unsigned long scan;		/* Module scan data */
+	unsigned long mixer;		/* Mixer buffers and player voices */
+	unsigned long depack_cache;	/* Depacked module cache */
+	unsigned long total;		/* Sum of the above */
+};
+
 typedef char *xmp_context;
+typedef char *xmp_bus;
 
 LIBXMP_EXPORT_VAR extern const char *xmp_version;
 LIBXMP_EXPORT_VAR extern const unsigned int xmp_vercode;
@@ -359,6 +398,7 @@ LIBXMP_EXPORT_VAR extern const unsigned int xmp_vercode;
 LIBXMP_EXPORT int         xmp_syserrno        (void);
 
 LIBXMP_EXPORT xmp_context xmp_create_context  (void);
+LIBXMP_EXPORT xmp_context xmp_create_context_with_allocator (const struct xmp_allocator *);
 LIBXMP_EXPORT void        xmp_free_context    (xmp_context);
 
 LIBXMP_EXPORT int         xmp_load_module     (xmp_context, const char *);
@@ -370,16 +410,20 @@ LIBXMP_EXPORT int         xmp_test_module     (const char *, struct xmp_test_inf
 LIBXMP_EXPORT int         xmp_test_module_from_memory (const void *, long, struct xmp_test_info *);
 LIBXMP_EXPORT int         xmp_test_module_from_file (void *, struct xmp_test_info *);
 LIBXMP_EXPORT int         xmp_test_module_from_callbacks (void *, struct xmp_callbacks, struct xmp_test_info *);
+LIBXMP_EXPORT int         xmp_test_module_batch (struct xmp_batch_info *, int, int);
 
 LIBXMP_EXPORT void        xmp_scan_module     (xmp_context);
 LIBXMP_EXPORT void        xmp_release_module  (xmp_context);
+LIBXMP_EXPORT int         xmp_decode_sample   (xmp_context, int);
 
 LIBXMP_EXPORT int         xmp_start_player    (xmp_context, int, int);
 LIBXMP_EXPORT int         xmp_play_frame      (xmp_context);
 LIBXMP_EXPORT int         xmp_play_buffer     (xmp_context, void *, int, int);
+LIBXMP_EXPORT int         xmp_render_samples  (xmp_context, void *, int, int);
 LIBXMP_EXPORT void        xmp_get_frame_info  (xmp_context, struct xmp_frame_info *);
 LIBXMP_EXPORT void        xmp_end_player      (xmp_context);
 LIBXMP_EXPORT void        xmp_inject_event    (xmp_context, int, struct xmp_event *);
+LIBXMP_EXPORT int         xmp_inject_event_at (xmp_context, int, struct xmp_event *, int);
 LIBXMP_EXPORT void        xmp_get_module_info (xmp_context, struct xmp_module_info *);
 LIBXMP_EXPORT const char *const *xmp_get_format_list (void);
 LIBXMP_EXPORT int         xmp_next_position   (xmp_context);
@@ -394,11 +438,14 @@ LIBXMP_EXPORT void        xmp_stop_module     (xmp_context);
 LIBXMP_EXPORT void        xmp_restart_module  (xmp_context);
 LIBXMP_EXPORT int         xmp_seek_time       (xmp_context, int);
 LIBXMP_EXPORT int         xmp_seek_time_frame (xmp_context, int);
+LIBXMP_EXPORT int         xmp_save_state      (xmp_context, void *, int);
+LIBXMP_EXPORT int         xmp_restore_state   (xmp_context, const void *, int);
 LIBXMP_EXPORT int         xmp_channel_mute    (xmp_context, int, int);
 LIBXMP_EXPORT int         xmp_channel_vol     (xmp_context, int, int);
 LIBXMP_EXPORT int         xmp_set_player      (xmp_context, int, int);
 LIBXMP_EXPORT int         xmp_get_player      (xmp_context, int);
 LIBXMP_EXPORT int         xmp_set_instrument_path (xmp_context, const char *);
+LIBXMP_EXPORT int         xmp_get_memory_usage (xmp_context, struct xmp_memory_usage *);
 
 /* External sample mixer API */
 LIBXMP_EXPORT int         xmp_start_smix       (xmp_context, int, int);
@@ -409,6 +456,14 @@ LIBXMP_EXPORT int         xmp_smix_channel_pan (xmp_context, int, int);
 LIBXMP_EXPORT int         xmp_smix_load_sample (xmp_context, int, const char *);
 LIBXMP_EXPORT int         xmp_smix_release_sample (xmp_context, int);
 
+/* Mixing bus API */
+LIBXMP_EXPORT xmp_bus     xmp_create_bus      (int, int);
+LIBXMP_EXPORT void        xmp_free_bus        (xmp_bus);
+LIBXMP_EXPORT int         xmp_bus_attach      (xmp_bus, xmp_context, int);
+LIBXMP_EXPORT int         xmp_bus_detach      (xmp_bus, xmp_context);
+LIBXMP_EXPORT int         xmp_bus_set_gain    (xmp_bus, xmp_context, int, int);
+LIBXMP_EXPORT int         xmp_bus_render      (xmp_bus, void *, int);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,258 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2026 Claudio Matsuoka and Hipolito Carraro Jr
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Mixing bus: render several player contexts into a single output
+ * stream. Each context mixes its frames into its own 32-bit buffer as
+ * usual, and the bus adds them together with a gain for each context
+ * before converting the sum to the output format in a single pass.
+ */
+
+#include "common.h"
+#include "player.h"
+#include "mixer.h"
+
+#define MAX_BUS_INPUTS	16
+#define BUS_FRAMES	1024		/* sample frames mixed at a time */
+#define GAIN_SHIFT	16
+#define GAIN_UNITY	(1 << GAIN_SHIFT)
+
+struct bus_input {
+	struct context_data *ctx;
+	int gain;		/* current gain, GAIN_UNITY is 100% */
+	int target;		/* gain at the end of the fade */
+	int step;		/* gain change per sample frame */
+	int fade;		/* sample frames left in the fade */
+};
+
+struct bus_data {
+	int rate;
+	int format;
+	int output_chn;
+	int sample_size;
+	int num_inputs;
+	struct bus_input input[MAX_BUS_INPUTS];
+	int32 buf32[BUS_FRAMES * 2];
+};
+
+static int gain_value(int gain)
+{
+	return (int)((int64)gain * GAIN_UNITY / 100);
+}
+
+static struct bus_input *find_input(struct bus_data *bus,
+				    struct context_data *ctx)
+{
+	int i;
+
+	for (i = 0; i < bus->num_inputs; i++) {
+		if (bus->input[i].ctx == ctx)
+			return &bus->input[i];
+	}
+
+	return NULL;
+}
+
+xmp_bus xmp_create_bus(int rate, int format)
+{
+	struct bus_data *bus;
+
+	if (rate < XMP_MIN_SRATE || rate > XMP_MAX_SRATE)
+		return NULL;
+
+	bus = (struct bus_data *) calloc(1, sizeof(struct bus_data));
+	if (bus == NULL)
+		return NULL;
+
+	bus->rate = rate;
+	bus->format = format;
+	bus->output_chn = (format & XMP_FORMAT_MONO) ? 1 : 2;
+
+	if (format & (XMP_FORMAT_FLOAT | XMP_FORMAT_32BIT)) {
+		bus->sample_size = 4;
+	} else if (format & XMP_FORMAT_8BIT) {
+		bus->sample_size = 1;
+	} else {
+		bus->sample_size = 2;
+	}
+
+	return (xmp_bus)bus;
+}
+
+void xmp_free_bus(xmp_bus opaque)
+{
+	free(opaque);
+}
+
+int xmp_bus_attach(xmp_bus opaque, xmp_context c, int gain)
+{
+	struct bus_data *bus = (struct bus_data *)opaque;
+	struct context_data *ctx = (struct context_data *)c;
+	struct bus_input *in;
+
+	if (gain < 0 || gain > 100)
+		return -XMP_ERROR_INVALID;
+
+	if (find_input(bus, ctx) != NULL)
+		return -XMP_ERROR_INVALID;
+
+	if (bus->num_inputs >= MAX_BUS_INPUTS)
+		return -XMP_ERROR_INVALID;
+
+	in = &bus->input[bus->num_inputs++];
+	in->ctx = ctx;
+	in->gain = in->target = gain_value(gain);
+	in->step = 0;
+	in->fade = 0;
+
+	return 0;
+}
+
+int xmp_bus_detach(xmp_bus opaque, xmp_context c)
+{
+	struct bus_data *bus = (struct bus_data *)opaque;
+	struct bus_input *in;
+
+	in = find_input(bus, (struct context_data *)c);
+	if (in == NULL)
+		return -XMP_ERROR_INVALID;
+
+	bus->num_inputs--;
+	memmove(in, in + 1, (char *)&bus->input[bus->num_inputs] - (char *)in);
+
+	return 0;
+}
+
+int xmp_bus_set_gain(xmp_bus opaque, xmp_context c, int gain, int fade)
+{
+	struct bus_data *bus = (struct bus_data *)opaque;
+	struct bus_input *in;
+
+	if (gain < 0 || gain > 100 || fade < 0)
+		return -XMP_ERROR_INVALID;
+
+	in = find_input(bus, (struct context_data *)c);
+	if (in == NULL)
+		return -XMP_ERROR_INVALID;
+
+	in->target = gain_value(gain);
+	if (fade > 0) {
+		in->step = (in->target - in->gain) / fade;
+		in->fade = fade;
+	} else {
+		in->gain = in->target;
+		in->fade = 0;
+	}
+
+	return 0;
+}
+
+/* Add count sample frames of a context to the bus buffer, applying the
+ * context gain and amplification.
+ */
+static void add_input(struct bus_input *in, int32 *dest, const int32 *src,
+		      int count, int chn, int amp)
+{
+	int shift = GAIN_SHIFT - amp;
+	int gain = in->gain;
+
+	for (; count--; ) {
+		if (in->fade > 0) {
+			gain = --in->fade > 0 ? gain + in->step : in->target;
+		}
+
+		*dest++ += (int32)(((int64)*src++ * gain) >> shift);
+		if (chn > 1) {
+			*dest++ += (int32)(((int64)*src++ * gain) >> shift);
+		}
+	}
+
+	in->gain = gain;
+}
+
+/* Skip the fade of a context that has nothing to render */
+static void skip_fade(struct bus_input *in, int count)
+{
+	if (in->fade > count) {
+		in->fade -= count;
+		in->gain += in->step * count;
+	} else if (in->fade > 0) {
+		in->fade = 0;
+		in->gain = in->target;
+	}
+}
+
+static void render_input(struct bus_data *bus, struct bus_input *in, int num)
+{
+	struct context_data *ctx = in->ctx;
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	int32 *dest = bus->buf32;
+	int count;
+
+	/* Contexts not playing or with a different output are silent */
+	if (ctx->state < XMP_STATE_PLAYING || s->freq != bus->rate ||
+	    s->output_chn != bus->output_chn) {
+		skip_fade(in, num);
+		return;
+	}
+
+	while (num > 0) {
+		if (libxmp_render_frame(ctx) < 0) {
+			skip_fade(in, num);
+			break;
+		}
+
+		count = MIN(num, p->render_data.size - p->render_data.pos);
+		add_input(in, dest, s->buf32 + p->render_data.pos * s->output_chn,
+			  count, s->output_chn, s->amplify);
+		p->render_data.pos += count;
+		dest += count * s->output_chn;
+		num -= count;
+	}
+}
+
+int xmp_bus_render(xmp_bus opaque, void *buffer, int num)
+{
+	struct bus_data *bus = (struct bus_data *)opaque;
+	char *out = (char *)buffer;
+	int i, count;
+
+	if (num < 0)
+		return -XMP_ERROR_INVALID;
+
+	while (num > 0) {
+		count = MIN(num, BUS_FRAMES);
+
+		memset(bus->buf32, 0, count * bus->output_chn * sizeof(int32));
+		for (i = 0; i < bus->num_inputs; i++) {
+			render_input(bus, &bus->input[i], count);
+		}
+
+		libxmp_downmix(out, bus->buf32, count * bus->output_chn,
+			       bus->format, 0);
+
+		out += count * bus->output_chn * bus->sample_size;
+		num -= count;
+	}
+
+	return 0;
+}
@@ -461,6 +461,7 @@ int libxmp_snprintf (char *, size_t, const char *, ...) LIBXMP_ATTRIB_PRINTF(3,4
 #define MAX_SAMPLES		1024
 #define MAX_INSTRUMENTS		255
 #define MAX_PATTERNS		256
+#define MAX_TIMED_EVENTS	64
 
 #define IS_PLAYER_MODE_MOD()	(m->read_event_type == READ_EVENT_MOD)
 #define IS_PLAYER_MODE_FT2()	(m->read_event_type == READ_EVENT_FT2)
@@ -495,11 +496,19 @@ struct smix_data {
 	struct xmp_sample *xxs;
 };
 
+struct module_data;
+struct pool_chunk;
+
 /* This will be added to the sample structure in the next API revision */
 struct extra_sample_data {
 	double c5spd;
 	int sus;
 	int sue;
+	/* Compressed sample data decoded on first use, see XMP_SMPCTL_LAZY */
+	uint8 *packed;
+	int packed_len;
+	int (*unpack)(struct module_data *, struct xmp_sample *,
+		      const uint8 *, int);
 };
 
 struct midi_macro {
@@ -544,15 +553,21 @@ struct module_data {
 	int period_type;
 	int smpctl;			/* sample control flags */
 	int defpan;			/* default pan setting */
+	int defer_scan;			/* scan module on first use */
+	int share_tracks;		/* share identical tracks */
 	struct ord_data xxo_info[XMP_MAX_MOD_LENGTH];
 	int num_sequences;
 	struct xmp_sequence seq_data[MAX_SEQUENCES];
 	char *instrument_path;
+	struct depack_cache *depack_cache; /* depacked module cache */
 	void *extra;			/* format-specific extra fields */
 	uint8 **scan_cnt;		/* scan counters */
+	struct pool_chunk *pool;	/* patterns, tracks and subinstruments */
+	int tracks_packed;		/* shared tracks moved to the pool */
 	struct extra_sample_data *xtra;
 	struct midi_macro_data *midi;
 	int compare_vblank;
+	struct xmp_allocator allocator;	/* user allocator, if any */
 };
 
 struct pattern_loop {
@@ -635,16 +650,36 @@ struct player_data {
 		struct virt_channel *virt_channel;
 
 		struct mixer_voice *voice_array;
+
+		/* Voice allocation heaps, see virtual.c */
+		int *free_voice;	/* Free voices, lowest number first */
+		int *bg_voice;		/* Background voices, quietest first */
+		int *bg_pos;		/* Position of voices in bg_voice */
+		int num_free;
+		int num_bg;
+		int culled;		/* Number of voices culled */
 	} virt;
 
 	struct xmp_event inject_event[XMP_MAX_CHANNELS];
 
+	struct timed_event {
+		int chn;
+		int offset;		/* sample frames from the tick start */
+		struct xmp_event e;
+	} timed[MAX_TIMED_EVENTS];	/* sorted by offset */
+	int num_timed;
+
 	struct {
 		int consumed;
 		int in_size;
 		char *in_buffer;
 	} buffer_data;
 
+	struct {
+		int pos;		/* next sample frame to downmix */
+		int size;		/* sample frames in the mixed frame */
+	} render_data;
+
 #ifndef LIBXMP_CORE_PLAYER
 	int st26_speed;			/* For IceTracker speed effect */
 #endif
@@ -664,11 +699,16 @@ struct mixer_data {
 	int sample_size;	/* individual output sample (not frame) size */
 	int output_chn;		/* output channels (1 or 2) */
 	int numvoc;		/* default softmixer voices number */
+	int cull_vol;		/* volume of inaudible background voices */
+	int voice_budget;	/* maximum number of voices mixed */
 	int ticksize;
 	int dtright;		/* anticlick control, right channel */
 	int dtleft;		/* anticlick control, left channel */
 	int bidir_adjust;	/* adjustment for IT bidirectional loops */
 	double pbase;		/* period base */
+#ifndef LIBXMP_CORE_DISABLE_IT
+	float filter_r[256];	/* filter cutoff terms for the sampling rate */
+#endif
 };
 
 struct rng_state {
@@ -692,9 +732,15 @@ LIBXMP_BEGIN_DECLS
 char	*libxmp_adjust_string	(char *);
 void	libxmp_load_prologue	(struct context_data *); /* use in load only */
 void	libxmp_load_epilogue	(struct context_data *); /* use in load only */
+void	libxmp_pack_tracks	(struct module_data *); /* use in load only */
+void	*libxmp_pool_alloc	(struct module_data *, size_t);
+void	libxmp_free_pool	(struct module_data *);
+size_t	libxmp_pool_size	(struct module_data *);
 int	libxmp_prepare_scan	(struct context_data *);
 void	libxmp_free_scan	(struct context_data *);
 int	libxmp_scan_sequences	(struct context_data *);
+int	libxmp_deferred_scan	(struct context_data *);
+int	libxmp_unpack_sample	(struct module_data *, int);
 int	libxmp_get_sequence	(struct context_data *, int);
 int	libxmp_set_player_mode	(struct context_data *);
 double	libxmp_get_frame_time	(struct context_data *);
@@ -727,6 +773,12 @@ struct xmp_instrument *libxmp_get_instrument(struct context_data *, int);
 struct xmp_sample *libxmp_get_sample(struct context_data *, int);
 
 char *libxmp_strdup(const char *);
+
+void	*libxmp_malloc		(struct module_data *, size_t);
+void	*libxmp_calloc		(struct module_data *, size_t, size_t);
+void	*libxmp_realloc		(struct module_data *, void *, size_t);
+void	libxmp_free		(struct module_data *, void *);
+
 int libxmp_get_filetype (const char *);
 
 LIBXMP_END_DECLS
@@ -23,17 +23,40 @@
 #include "format.h"
 #include "virtual.h"
 #include "mixer.h"
+#include "player.h"
+#include "extras.h"
 #include "rng.h"
+#ifndef LIBXMP_NO_DEPACKERS
+#include "depackers/depacker.h"
+#endif
 
 /* TODO: Change this to const char *const in a future ABI change */
 const char *xmp_version LIBXMP_EXPORT_VAR = XMP_VERSION;
 const unsigned int xmp_vercode LIBXMP_EXPORT_VAR = XMP_VERCODE;
 
 xmp_context xmp_create_context(void)
+{
+	return xmp_create_context_with_allocator(NULL);
+}
+
+xmp_context xmp_create_context_with_allocator(const struct xmp_allocator *allocator)
 {
 	struct context_data *ctx;
 
-	ctx = (struct context_data *) calloc(1, sizeof(struct context_data));
+	if (allocator == NULL) {
+		ctx = (struct context_data *) calloc(1, sizeof(struct context_data));
+	} else {
+		if (allocator->alloc == NULL || allocator->resize == NULL ||
+		    allocator->release == NULL) {
+			return NULL;
+		}
+		ctx = (struct context_data *) allocator->alloc(
+				sizeof(struct context_data), allocator->priv);
+		if (ctx != NULL) {
+			memset(ctx, 0, sizeof(struct context_data));
+			ctx->m.allocator = *allocator;
+		}
+	}
 	if (ctx == NULL) {
 		return NULL;
 	}
@@ -56,8 +79,11 @@ void xmp_free_context(xmp_context opaque)
 
 	xmp_end_smix(opaque);
 
+#ifndef LIBXMP_NO_DEPACKERS
+	libxmp_free_depack_cache(m);
+#endif
 	free(m->instrument_path);
-	free(opaque);
+	libxmp_free(m, opaque);
 }
 
 static void set_position(struct context_data *ctx, int pos, int dir)
@@ -317,8 +343,8 @@ int xmp_seek_time_frame(xmp_context opaque, int time)
 	max_time = m->seq_data[p->sequence].duration - 0.1;
 	t = MIN((double)time, max_time);
 
-	/* Try to find the correct frame (this may take a while).
-	 * TODO: temporarily put the mixer in a lower rate? */
+	/* Try to find the correct frame. Frames are played without mixing,
+	 * the voices are only moved forward in their samples. */
 	for (i = 0; i < (1 << 13); i++) {
 		double prev = p->current_time;
 
@@ -326,7 +352,7 @@ int xmp_seek_time_frame(xmp_context opaque, int time)
 		if (p->current_time + libxmp_get_frame_time(ctx) > t) {
 			break;
 		}
-		if (xmp_play_frame(opaque) < 0 || p->current_time < prev) {
+		if (libxmp_advance_frame(ctx) < 0 || p->current_time < prev) {
 			break;
 		}
 #if 0
@@ -338,6 +364,7 @@ int xmp_seek_time_frame(xmp_context opaque, int time)
 	/* Force an xmp_play_buffer refresh so the new (wrong) frame data
 	 * doesn't confuse the caller: */
 	xmp_play_buffer(opaque, NULL, 0, 0);
+	xmp_render_samples(opaque, NULL, 0, 0);
 
 	return p->pos < 0 ? 0 : p->pos;
 }
@@ -388,6 +415,282 @@ int xmp_channel_vol(xmp_context opaque, int chn, int vol)
 	return ret;
 }
 
+/* Player state snapshots
+ *
+ * The state is saved as a header followed by the raw player, channel and
+ * voice structures. Pointers are not stored: they're kept from the context
+ * being restored, and sample pointers are recomputed from the sample
+ * number. Snapshots are only valid for the same build of the library, the
+ * same module and the same player parameters.
+ */
+
+#define STATE_MAGIC	0x584d5053	/* "XMPS" */
+
+struct state_header {
+	uint32 magic;
+	int size;
+	int chn;
+	int len;
+	int virt_channels;
+	int maxvoc;
+	int freq;
+	int format;
+	int extras_size;
+	int paula;
+};
+
+static void get_state_header(struct context_data *ctx, struct state_header *h)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct xmp_module *mod = &ctx->m.mod;
+	int num = p->virt.virt_channels;
+
+	memset(h, 0, sizeof(struct state_header));
+	h->magic = STATE_MAGIC;
+	h->chn = mod->chn;
+	h->len = mod->len;
+	h->virt_channels = num;
+	h->maxvoc = p->virt.maxvoc;
+	h->freq = s->freq;
+	h->format = s->format;
+#ifndef LIBXMP_CORE_PLAYER
+	h->extras_size = libxmp_channel_extras_size(ctx);
+#endif
+#ifdef LIBXMP_PAULA_SIMULATOR
+	h->paula = h->maxvoc > 0 && p->virt.voice_array[0].paula != NULL;
+#endif
+
+	h->size = sizeof(struct state_header) + sizeof(struct player_data) +
+		  num * (sizeof(struct pattern_loop) +
+			 sizeof(struct channel_data) + h->extras_size +
+			 sizeof(struct virt_channel)) +
+		  h->maxvoc * sizeof(struct mixer_voice) +
+		  2 * sizeof(int) + sizeof(struct rng_state);
+#ifdef LIBXMP_PAULA_SIMULATOR
+	if (h->paula) {
+		h->size += h->maxvoc * sizeof(struct paula_state);
+	}
+#endif
+}
+
+int xmp_save_state(xmp_context opaque, void *buffer, int size)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct state_header h;
+	char *b = (char *)buffer;
+	int num;
+
+	if (ctx->state < XMP_STATE_PLAYING)
+		return -XMP_ERROR_STATE;
+
+	get_state_header(ctx, &h);
+
+	if (buffer == NULL)
+		return h.size;
+
+	if (size < h.size)
+		return -XMP_ERROR_INVALID;
+
+	num = h.virt_channels;
+
+#define SAVE(src, len) do { memcpy(b, (src), (len)); b += (len); } while (0)
+
+	SAVE(&h, sizeof(struct state_header));
+	SAVE(p, sizeof(struct player_data));
+	SAVE(p->flow.loop, num * sizeof(struct pattern_loop));
+	SAVE(p->xc_data, num * sizeof(struct channel_data));
+#ifndef LIBXMP_CORE_PLAYER
+	if (h.extras_size > 0) {
+		int i;
+		for (i = 0; i < num; i++) {
+			SAVE(p->xc_data[i].extra, h.extras_size);
+		}
+	}
+#endif
+	SAVE(p->virt.virt_channel, num * sizeof(struct virt_channel));
+	SAVE(p->virt.voice_array, h.maxvoc * sizeof(struct mixer_voice));
+#ifdef LIBXMP_PAULA_SIMULATOR
+	if (h.paula) {
+		int i;
+		for (i = 0; i < h.maxvoc; i++) {
+			SAVE(p->virt.voice_array[i].paula, sizeof(struct paula_state));
+		}
+	}
+#endif
+	SAVE(&s->dtleft, sizeof(int));
+	SAVE(&s->dtright, sizeof(int));
+	SAVE(&ctx->rng, sizeof(struct rng_state));
+
+#undef SAVE
+
+	return h.size;
+}
+
+/* Check the order, instrument, sample and channel numbers in a snapshot
+ * before restoring it, so a damaged snapshot is rejected instead of
+ * making the player index past the module or the channel arrays.
+ */
+static int check_state(struct context_data *ctx, const struct state_header *h,
+		       const char *b)
+{
+	struct xmp_module *mod = &ctx->m.mod;
+	struct smix_data *smix = &ctx->smix;
+	struct player_data p;
+	struct channel_data xc;
+	struct virt_channel vc;
+	struct mixer_voice vi;
+	int num = h->virt_channels;
+	int i;
+
+	memcpy(&p, b, sizeof(struct player_data));
+	if (p.ord < 0 || p.ord >= mod->len || p.pos < -1 || p.pos >= mod->len)
+		return -1;
+	b += sizeof(struct player_data) + num * sizeof(struct pattern_loop);
+
+	for (i = 0; i < num; i++) {
+		memcpy(&xc, b, sizeof(struct channel_data));
+		if (xc.ins < -1 || xc.ins >= mod->ins + smix->ins)
+			return -1;
+		b += sizeof(struct channel_data);
+	}
+	b += num * h->extras_size;
+
+	for (i = 0; i < num; i++) {
+		memcpy(&vc, b, sizeof(struct virt_channel));
+		if (vc.map < -1 || vc.map >= h->maxvoc)
+			return -1;
+		b += sizeof(struct virt_channel);
+	}
+
+	for (i = 0; i < h->maxvoc; i++) {
+		memcpy(&vi, b, sizeof(struct mixer_voice));
+		if (vi.chn < -1 || vi.chn >= num || vi.root < -1 || vi.root >= num)
+			return -1;
+		if (vi.chn >= 0 && (vi.smp < 0 || vi.smp >= mod->smp + smix->smp))
+			return -1;
+		b += sizeof(struct mixer_voice);
+	}
+
+	return 0;
+}
+
+int xmp_restore_state(xmp_context opaque, const void *buffer, int size)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct module_data *m = &ctx->m;
+	struct player_data save;
+	struct state_header h, h2;
+	const char *b = (const char *)buffer;
+	int num, i;
+
+	if (ctx->state < XMP_STATE_PLAYING)
+		return -XMP_ERROR_STATE;
+
+	if (buffer == NULL || size < (int)sizeof(struct state_header))
+		return -XMP_ERROR_INVALID;
+
+	get_state_header(ctx, &h);
+	memcpy(&h2, b, sizeof(struct state_header));
+	if (memcmp(&h, &h2, sizeof(struct state_header)) != 0 || size < h.size)
+		return -XMP_ERROR_INVALID;
+
+	num = h.virt_channels;
+	b += sizeof(struct state_header);
+
+	if (check_state(ctx, &h, b) < 0)
+		return -XMP_ERROR_INVALID;
+
+#define LOAD(dest, len) do { memcpy((dest), b, (len)); b += (len); } while (0)
+
+	/* Keep pointers and user settings from the current player */
+	memcpy(&save, p, sizeof(struct player_data));
+	LOAD(p, sizeof(struct player_data));
+	p->flow.loop = save.flow.loop;
+	p->scan = save.scan;
+	p->xc_data = save.xc_data;
+	p->virt.virt_channel = save.virt.virt_channel;
+	p->virt.voice_array = save.virt.voice_array;
+	p->virt.free_voice = save.virt.free_voice;
+	p->virt.bg_voice = save.virt.bg_voice;
+	p->virt.bg_pos = save.virt.bg_pos;
+	p->time_factor_relative = save.time_factor_relative;
+	p->smix_vol = save.smix_vol;
+	p->virt.culled = save.virt.culled;
+	p->master_vol = save.master_vol;
+	memcpy(p->channel_vol, save.channel_vol, sizeof(p->channel_vol));
+	memcpy(p->channel_mute, save.channel_mute, sizeof(p->channel_mute));
+
+	LOAD(p->flow.loop, num * sizeof(struct pattern_loop));
+
+	for (i = 0; i < num; i++) {
+		struct channel_data *xc = &p->xc_data[i];
+#ifndef LIBXMP_CORE_PLAYER
+		void *extra = xc->extra;
+		LOAD(xc, sizeof(struct channel_data));
+		xc->extra = extra;
+#else
+		LOAD(xc, sizeof(struct channel_data));
+#endif
+	}
+#ifndef LIBXMP_CORE_PLAYER
+	if (h.extras_size > 0) {
+		for (i = 0; i < num; i++) {
+			LOAD(p->xc_data[i].extra, h.extras_size);
+		}
+	}
+#endif
+
+	LOAD(p->virt.virt_channel, num * sizeof(struct virt_channel));
+
+	for (i = 0; i < h.maxvoc; i++) {
+		struct mixer_voice *vi = &p->virt.voice_array[i];
+#ifdef LIBXMP_PAULA_SIMULATOR
+		struct paula_state *paula = vi->paula;
+#endif
+		LOAD(vi, sizeof(struct mixer_voice));
+#ifdef LIBXMP_PAULA_SIMULATOR
+		vi->paula = paula;
+#endif
+		if (vi->sptr != NULL) {
+			struct xmp_sample *xxs;
+
+			/* Samples loaded with XMP_SMPCTL_LAZY may not be
+			 * decoded yet in this context */
+			libxmp_unpack_sample(m, vi->smp);
+			xxs = libxmp_get_sample(ctx, vi->smp);
+			vi->sptr = xxs != NULL ? xxs->data : NULL;
+		}
+	}
+#ifdef LIBXMP_PAULA_SIMULATOR
+	if (h.paula) {
+		for (i = 0; i < h.maxvoc; i++) {
+			LOAD(p->virt.voice_array[i].paula, sizeof(struct paula_state));
+		}
+	}
+#endif
+	LOAD(&s->dtleft, sizeof(int));
+	LOAD(&s->dtright, sizeof(int));
+	LOAD(&ctx->rng, sizeof(struct rng_state));
+
+#undef LOAD
+
+	libxmp_virt_rebuild(ctx);
+
+	/* Discard any partially consumed frame, but keep the loop count
+	 * restored from the snapshot */
+	p->buffer_data.consumed = 0;
+	p->buffer_data.in_size = 0;
+	p->render_data.pos = 0;
+	p->render_data.size = 0;
+
+	return 0;
+}
+
 #ifdef USE_VERSIONED_SYMBOLS
 LIBXMP_BEGIN_DECLS /* no name-mangling */
 LIBXMP_EXPORT_VERSIONED extern int xmp_set_player_v40__(xmp_context, int, int) LIBXMP_ATTRIB_SYMVER("xmp_set_player@XMP_4.0");
@@ -420,7 +723,8 @@ int xmp_set_player__(xmp_context opaque, int parm, int val)
 	int ret = -XMP_ERROR_INVALID;
 
 
-	if (parm == XMP_PLAYER_SMPCTL || parm == XMP_PLAYER_DEFPAN) {
+	if (parm == XMP_PLAYER_SMPCTL || parm == XMP_PLAYER_DEFPAN ||
+	    parm == XMP_PLAYER_DEFER_SCAN || parm == XMP_PLAYER_SHARE_TRACKS) {
 		/* these should be set before loading the module */
 		if (ctx->state >= XMP_STATE_LOADED) {
 			return -XMP_ERROR_STATE;
@@ -430,6 +734,10 @@ int xmp_set_player__(xmp_context opaque, int parm, int val)
 		if (ctx->state >= XMP_STATE_PLAYING) {
 			return -XMP_ERROR_STATE;
 		}
+	} else if (parm == XMP_PLAYER_DEPACK_CACHE ||
+		   parm == XMP_PLAYER_CULL_VOLUME ||
+		   parm == XMP_PLAYER_VOICE_BUDGET) {
+		/* can be set at any time */
 	} else if (ctx->state < XMP_STATE_PLAYING) {
 		return -XMP_ERROR_STATE;
 	}
@@ -505,6 +813,37 @@ int xmp_set_player__(xmp_context opaque, int parm, int val)
 	case XMP_PLAYER_VOICES:
 		s->numvoc = val;
 		break;
+
+	/* 4.8 */
+	case XMP_PLAYER_DEPACK_CACHE:
+#ifndef LIBXMP_NO_DEPACKERS
+		if (val >= 0 && val <= LIBXMP_DEPACK_LIMIT / 1024) {
+			if (libxmp_set_depack_cache(m, (long)val * 1024) == 0) {
+				ret = 0;
+			}
+		}
+#endif
+		break;
+	case XMP_PLAYER_DEFER_SCAN:
+		m->defer_scan = (val != 0);
+		ret = 0;
+		break;
+	case XMP_PLAYER_SHARE_TRACKS:
+		m->share_tracks = (val != 0);
+		ret = 0;
+		break;
+	case XMP_PLAYER_CULL_VOLUME:
+		if (val >= 0 && val <= 1024) {
+			s->cull_vol = val;
+			ret = 0;
+		}
+		break;
+	case XMP_PLAYER_VOICE_BUDGET:
+		if (val >= 0) {
+			s->voice_budget = val;
+			ret = 0;
+		}
+		break;
 	}
 
 	return ret;
@@ -544,7 +883,10 @@ int xmp_get_player__(xmp_context opaque, int parm)
 	struct mixer_data *s = &ctx->s;
 	int ret = -XMP_ERROR_INVALID;
 
-	if (parm == XMP_PLAYER_SMPCTL || parm == XMP_PLAYER_DEFPAN) {
+	if (parm == XMP_PLAYER_SMPCTL || parm == XMP_PLAYER_DEFPAN ||
+	    parm == XMP_PLAYER_DEPACK_CACHE || parm == XMP_PLAYER_DEFER_SCAN ||
+	    parm == XMP_PLAYER_SHARE_TRACKS || parm == XMP_PLAYER_CULL_VOLUME ||
+	    parm == XMP_PLAYER_VOICE_BUDGET) {
 		// can read these at any time
 	} else if (parm != XMP_PLAYER_STATE && ctx->state < XMP_STATE_PLAYING) {
 		return -XMP_ERROR_STATE;
@@ -612,6 +954,31 @@ int xmp_get_player__(xmp_context opaque, int parm)
 	case XMP_PLAYER_VOICES:
 		ret = s->numvoc;
 		break;
+
+	/* 4.8 */
+	case XMP_PLAYER_DEPACK_CACHE:
+		ret = 0;
+#ifndef LIBXMP_NO_DEPACKERS
+		if (m->depack_cache != NULL) {
+			ret = (int)(m->depack_cache->limit / 1024);
+		}
+#endif
+		break;
+	case XMP_PLAYER_DEFER_SCAN:
+		ret = m->defer_scan;
+		break;
+	case XMP_PLAYER_SHARE_TRACKS:
+		ret = m->share_tracks;
+		break;
+	case XMP_PLAYER_CULL_VOLUME:
+		ret = s->cull_vol;
+		break;
+	case XMP_PLAYER_VOICE_BUDGET:
+		ret = s->voice_budget;
+		break;
+	case XMP_PLAYER_CULLED:
+		ret = p->virt.culled;
+		break;
 	}
 
 	return ret;
@@ -634,6 +1001,38 @@ void xmp_inject_event(xmp_context opaque, int channel, struct xmp_event *e)
 	p->inject_event[channel]._flag = 1;
 }
 
+int xmp_inject_event_at(xmp_context opaque, int channel, struct xmp_event *e,
+			int offset)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct module_data *m = &ctx->m;
+	struct smix_data *smix = &ctx->smix;
+
+	if (ctx->state < XMP_STATE_PLAYING)
+		return -XMP_ERROR_STATE;
+
+	if (channel < 0 || channel >= m->mod.chn + smix->chn || offset < 0)
+		return -XMP_ERROR_INVALID;
+
+	/* Samples of the current frame not yet returned by xmp_play_buffer()
+	 * or xmp_render_samples() are output before the next frame is
+	 * rendered */
+	if (p->buffer_data.in_size > p->buffer_data.consumed) {
+		offset -= (p->buffer_data.in_size - p->buffer_data.consumed) /
+				(s->output_chn * s->sample_size);
+	}
+	offset -= p->render_data.size - p->render_data.pos;
+	if (offset < 0)
+		offset = 0;
+
+	if (libxmp_queue_timed_event(ctx, channel, e, offset) < 0)
+		return -XMP_ERROR_INVALID;
+
+	return 0;
+}
+
 int xmp_set_instrument_path(xmp_context opaque, const char *path)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
@@ -655,6 +1054,154 @@ int xmp_set_instrument_path(xmp_context opaque, const char *path)
 	return 0;
 }
 
+static unsigned long sample_usage(const struct xmp_sample *xxs)
+{
+	unsigned long framelen = 1;
+
+	if (xxs->data == NULL)
+		return 0;
+
+	if (xxs->flg & XMP_SAMPLE_16BIT)
+		framelen *= 2;
+	if (xxs->flg & XMP_SAMPLE_STEREO)
+		framelen *= 2;
+
+	/* Guard bytes before and after the sample data */
+	return ((unsigned long)xxs->len + 4) * framelen + 4;
+}
+
+static void module_usage(struct context_data *ctx, struct xmp_memory_usage *usage)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	struct xmp_module *mod = &m->mod;
+	struct xmp_pattern *xxp;
+	int i;
+
+	usage->patterns = libxmp_pool_size(m);
+	if (mod->xxp != NULL)
+		usage->patterns += mod->pat * sizeof(struct xmp_pattern *);
+	if (mod->xxt != NULL) {
+		usage->patterns += mod->trk * sizeof(struct xmp_track *);
+		if (m->share_tracks && !m->tracks_packed) {
+			for (i = 0; i < mod->trk; i++) {
+				if (mod->xxt[i] == NULL)
+					continue;
+				usage->patterns += sizeof(struct xmp_track) +
+					sizeof(struct xmp_event) *
+					(mod->xxt[i]->rows - 1);
+			}
+		}
+	}
+	if (mod->xxi != NULL)
+		usage->patterns += mod->ins * sizeof(struct xmp_instrument);
+#ifndef LIBXMP_CORE_PLAYER
+	usage->patterns += libxmp_module_extras_usage(ctx);
+	if (m->dirname != NULL)
+		usage->patterns += strlen(m->dirname) + 1;
+	if (m->basename != NULL)
+		usage->patterns += strlen(m->basename) + 1;
+#endif
+
+	if (mod->xxs != NULL) {
+		usage->samples += mod->smp * sizeof(struct xmp_sample);
+		for (i = 0; i < mod->smp; i++)
+			usage->samples += sample_usage(&mod->xxs[i]);
+	}
+	if (m->xtra != NULL) {
+		usage->samples += mod->smp * sizeof(struct extra_sample_data);
+		for (i = 0; i < mod->smp; i++)
+			usage->samples += m->xtra[i].packed_len;
+	}
+
+	if (m->scan_cnt != NULL) {
+		usage->scan += mod->len * sizeof(uint8 *);
+		for (i = 0; i < mod->len; i++) {
+			xxp = mod->xxo[i] < mod->pat ? mod->xxp[mod->xxo[i]] : NULL;
+			usage->scan += (xxp && xxp->rows) ? xxp->rows : 1;
+		}
+	}
+	if (p->scan != NULL) {
+		usage->scan += sizeof(struct scan_data) *
+			(m->num_sequences < mod->len ?
+			 m->num_sequences : MAX(1, mod->len));
+	}
+}
+
+static void player_usage(struct context_data *ctx, struct xmp_memory_usage *usage)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+#if defined(LIBXMP_PAULA_SIMULATOR) || !defined(LIBXMP_CORE_PLAYER)
+	int i;
+#endif
+
+	if (s->buffer != NULL)
+		usage->mixer += s->total_size * s->sample_size;
+	if (s->buf32 != NULL)
+		usage->mixer += s->total_size * sizeof(int32);
+
+	if (p->virt.voice_array != NULL) {
+		usage->mixer += p->virt.maxvoc * sizeof(struct mixer_voice);
+#ifdef LIBXMP_PAULA_SIMULATOR
+		for (i = 0; i < p->virt.maxvoc; i++) {
+			if (p->virt.voice_array[i].paula != NULL)
+				usage->mixer += sizeof(struct paula_state);
+		}
+#endif
+	}
+	if (p->virt.virt_channel != NULL)
+		usage->mixer += p->virt.virt_channels * sizeof(struct virt_channel);
+	if (p->virt.free_voice != NULL)
+		usage->mixer += 3 * p->virt.maxvoc * sizeof(int);
+	if (p->xc_data != NULL) {
+		usage->mixer += p->virt.virt_channels * sizeof(struct channel_data);
+#ifndef LIBXMP_CORE_PLAYER
+		for (i = 0; i < p->virt.virt_channels; i++) {
+			if (p->xc_data[i].extra != NULL)
+				usage->mixer += libxmp_channel_extras_size(ctx);
+		}
+#endif
+	}
+	if (p->flow.loop != NULL)
+		usage->mixer += p->virt.virt_channels * sizeof(struct pattern_loop);
+}
+
+int xmp_get_memory_usage(xmp_context opaque, struct xmp_memory_usage *usage)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct smix_data *smix = &ctx->smix;
+	int i;
+
+	if (usage == NULL)
+		return -XMP_ERROR_INVALID;
+
+	memset(usage, 0, sizeof(struct xmp_memory_usage));
+
+	if (ctx->state > XMP_STATE_UNLOADED)
+		module_usage(ctx, usage);
+	if (ctx->state > XMP_STATE_LOADED)
+		player_usage(ctx, usage);
+
+	if (smix->xxs != NULL) {
+		usage->samples += smix->smp * sizeof(struct xmp_sample);
+		for (i = 0; i < smix->smp; i++)
+			usage->samples += sample_usage(&smix->xxs[i]);
+	}
+	if (smix->xxi != NULL)
+		usage->patterns += smix->ins * sizeof(struct xmp_instrument);
+
+#ifndef LIBXMP_NO_DEPACKERS
+	if (ctx->m.depack_cache != NULL)
+		usage->depack_cache = ctx->m.depack_cache->used;
+#endif
+
+	usage->total = usage->patterns + usage->samples + usage->scan +
+			usage->mixer + usage->depack_cache;
+
+	return 0;
+}
+
 int xmp_set_tempo_factor(xmp_context opaque, double val)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
@@ -25,7 +25,7 @@
 #include "../common.h"
 #include "depacker.h"
 #include "../hio.h"
-#include "../tempfile.h"
+#include "../md5.h"
 #include "xfnmatch.h"
 
 #if defined(_WIN32 ) && !LIBXMP_UWP
@@ -84,22 +84,94 @@ static const struct depacker *const depacker_list[] = {
 #define DECRUNCH_USE_POPEN
 
 #else
-static int execute_command(const char * const cmd[], FILE *t) {
+static int execute_command(const char * const cmd[], struct module_data *m,
+			   void **out, long *outlen) {
+	return -1;
+}
+#endif
+
+/* Depacked data is allocated with the context allocator when a player
+ * context is available, and with malloc() otherwise.
+ */
+static void *depack_realloc(struct module_data *m, void *ptr, size_t size)
+{
+	return m != NULL ? libxmp_realloc(m, ptr, size) : realloc(ptr, size);
+}
+
+static void depack_free(struct module_data *m, void *ptr)
+{
+	if (m != NULL) {
+		libxmp_free(m, ptr);
+	} else {
+		free(ptr);
+	}
+}
+
+#if defined(DECRUNCH_USE_FORK) || defined(DECRUNCH_USE_POPEN)
+/* Read the helper output into a memory buffer, limited to the maximum
+ * depacked size accepted by the internal depackers.
+ */
+static int read_command_output(FILE *p, struct module_data *m,
+			       void **out, long *outlen)
+{
+	char *buf = NULL, *b;
+	long size = 0, len = 0;
+	size_t n;
+
+	do {
+		if (len == size) {
+			if (size >= LIBXMP_DEPACK_LIMIT) {
+				/* Output of exactly the limit size is valid */
+				if (fgetc(p) == EOF) {
+					break;
+				}
+				D_(D_CRIT "output exceeds depack limit");
+				goto err;
+			}
+			size = size ? size * 2 : BUFLEN;
+			if (size > LIBXMP_DEPACK_LIMIT) {
+				size = LIBXMP_DEPACK_LIMIT;
+			}
+			if ((b = (char *)depack_realloc(m, buf, size)) == NULL) {
+				goto err;
+			}
+			buf = b;
+		}
+		n = fread(buf + len, 1, size - len, p);
+		len += n;
+	} while (n > 0);
+
+	if (len == 0) {
+		goto err;
+	}
+
+	/* Shrink the buffer to the output size */
+	if ((b = (char *)depack_realloc(m, buf, len)) != NULL) {
+		buf = b;
+	}
+
+	*out = buf;
+	*outlen = len;
+	return 0;
+
+    err:
+	depack_free(m, buf);
 	return -1;
 }
 #endif
 
 #ifdef DECRUNCH_USE_POPEN
 /* TODO: this may not be safe outside of _WIN32 (which uses CreateProcess). */
-static int execute_command(const char * const cmd[], FILE *t)
+static int execute_command(const char * const cmd[], struct module_data *m,
+			   void **out, long *outlen)
 {
 #ifdef _WIN32
 	struct pt_popen_data *popen_data;
 #endif
-	char line[1024], buf[BUFLEN];
+	char line[1024];
 	FILE *p;
 	int pos;
-	int n;
+	int n, ret;
 
 	/* Collapse command array into a command line for popen. */
 	for (n = 0, pos = 0; cmd[n]; n++) {
@@ -125,16 +197,14 @@ static int execute_command(const char * const cmd[], FILE *t)
 		return -1;
 	}
 
-	while ((n = fread(buf, 1, BUFLEN, p)) > 0) {
-		fwrite(buf, 1, n, t);
-	}
+	ret = read_command_output(p, m, out, outlen);
 
 #ifdef _WIN32
 	pt_pclose(p, &popen_data);
 #else
 	pclose(p);
 #endif
-	return 0;
+	return ret;
 }
 #endif /* USE_PTPOPEN */
 
@@ -143,15 +213,15 @@ static int execute_command(const char * const cmd[], FILE *t)
 #include <sys/wait.h>
 #include <unistd.h>
 
-static int execute_command(const char * const cmd[], FILE *t)
+static int execute_command(const char * const cmd[], struct module_data *m,
+			   void **out, long *outlen)
 {
 	/* Use pipe/fork/execvp to avoid shell injection vulnerabilities. */
-	char buf[BUFLEN];
 	FILE *p;
-	int n;
 	int fds[2];
 	pid_t pid;
 	int status;
+	int ret;
 
 	D_(D_INFO "fork/execvp(%s...)", cmd[0]);
 
@@ -182,68 +252,211 @@ static int execute_command(const char * const cmd[], FILE *t)
 		return -1;
 	}
 
-	while ((n = fread(buf, 1, BUFLEN, p)) > 0) {
-		fwrite(buf, 1, n, t);
-	}
+	ret = read_command_output(p, m, out, outlen);
+
+	/* Closing the pipe first makes the helper exit if its output
+	 * exceeded the depack limit and wasn't read completely. */
+	fclose(p);
 
 	wait(&status);
 	if (!WIFEXITED(status)) {
 		D_(D_CRIT "process failed (wstatus = %d)", status);
-		close(fds[0]);
-		return -1;
+		goto err;
 	}
 	if (WEXITSTATUS(status)) {
 		D_(D_CRIT "process exited with status %d", WEXITSTATUS(status));
-		close(fds[0]);
+		goto err;
+	}
+
+	return ret;
+
+    err:
+	if (ret == 0) {
+		depack_free(m, *out);
+	}
+	return -1;
+}
+#endif /* USE_FORK */
+
+/* Depacked module cache. Entries are keyed by the MD5 digest and size
+ * of the packed data and kept in most recently used order; the least
+ * recently used entries are dropped when the cache is full.
+ */
+struct depack_cache_entry {
+	uint8 digest[MD5_DIGEST_LENGTH];
+	long packed_size;
+	void *data;
+	long size;
+	struct depack_cache_entry *next;
+};
+
+static void cache_evict(struct module_data *m, long limit)
+{
+	struct depack_cache *cache = m->depack_cache;
+	struct depack_cache_entry **e, *t;
+
+	while (cache->used > limit) {
+		/* Drop the last entry */
+		for (e = &cache->list; (*e)->next != NULL; e = &(*e)->next);
+		t = *e;
+		*e = NULL;
+		cache->used -= t->size;
+		libxmp_free(m, t->data);
+		libxmp_free(m, t);
+	}
+}
+
+int libxmp_set_depack_cache(struct module_data *m, long limit)
+{
+	if (limit < 0) {
 		return -1;
 	}
 
-	fclose(p);
+	if (m->depack_cache == NULL) {
+		if (limit == 0) {
+			return 0;
+		}
+		m->depack_cache = (struct depack_cache *)
+			libxmp_calloc(m, 1, sizeof(struct depack_cache));
+		if (m->depack_cache == NULL) {
+			return -1;
+		}
+	}
+
+	cache_evict(m, limit);
+	m->depack_cache->limit = limit;
+
+	return 0;
+}
+
+void libxmp_free_depack_cache(struct module_data *m)
+{
+	if (m->depack_cache != NULL) {
+		cache_evict(m, 0);
+		libxmp_free(m, m->depack_cache);
+		m->depack_cache = NULL;
+	}
+}
+
+/* Compute the cache key of the packed data */
+static int cache_digest(HIO_HANDLE *h, uint8 *digest, long *size)
+{
+	const unsigned char *mem = hio_get_underlying_memory(h);
+	unsigned char buf[BUFLEN];
+	MD5_CTX ctx;
+	size_t n;
+
+	MD5Init(&ctx);
+	*size = hio_size(h);
+
+	if (mem != NULL) {
+		MD5Update(&ctx, mem, *size);
+	} else {
+		while ((n = hio_read(buf, 1, BUFLEN, h)) > 0) {
+			MD5Update(&ctx, buf, n);
+		}
+		hio_error(h);
+		if (hio_seek(h, 0, SEEK_SET) < 0) {
+			return -1;
+		}
+	}
+
+	MD5Final(digest, &ctx);
+	return 0;
+}
+
+static struct depack_cache_entry *cache_find(struct depack_cache *cache,
+				const uint8 *digest, long packed_size)
+{
+	struct depack_cache_entry **e, *t;
+
+	for (e = &cache->list; *e != NULL; e = &(*e)->next) {
+		t = *e;
+		if (t->packed_size == packed_size &&
+		    !memcmp(t->digest, digest, MD5_DIGEST_LENGTH)) {
+			/* Move to the head of the list */
+			*e = t->next;
+			t->next = cache->list;
+			cache->list = t;
+			return t;
+		}
+	}
+
+	return NULL;
+}
+
+/* Reopen the handle with the depacked data, storing it in the cache
+ * if the cache is enabled. Data owned by the cache is never freed by
+ * the handle, and stays valid until the next call to libxmp_decrunch().
+ * Data allocated for a player context and not cached is returned in
+ * depacked, to be released with libxmp_free() after closing the handle.
+ */
+static int reopen_depacked(HIO_HANDLE *h, struct module_data *m,
+			   struct depack_cache *cache, const uint8 *digest,
+			   long packed_size, void *out, long outlen,
+			   void **depacked)
+{
+	struct depack_cache_entry *e;
+
+	if (cache != NULL && outlen <= cache->limit) {
+		e = (struct depack_cache_entry *)
+			libxmp_malloc(m, sizeof(struct depack_cache_entry));
+		if (e != NULL) {
+			cache_evict(m, cache->limit - outlen);
+			memcpy(e->digest, digest, MD5_DIGEST_LENGTH);
+			e->packed_size = packed_size;
+			e->data = out;
+			e->size = outlen;
+			e->next = cache->list;
+			cache->list = e;
+			cache->used += outlen;
+
+			return hio_reopen_mem(out, outlen, 0, h);
+		}
+	}
+
+	if (hio_reopen_mem(out, outlen, m == NULL, h) < 0) {
+		depack_free(m, out);
+		return -1;
+	}
+	if (m != NULL) {
+		*depacked = out;
+	}
 	return 0;
 }
-#endif /* USE_FORK */
 
-static int decrunch_command(HIO_HANDLE *h, const char * const cmd[], char **temp)
+static int decrunch_command(HIO_HANDLE *h, const char * const cmd[],
+			    struct module_data *m, struct depack_cache *cache,
+			    const uint8 *digest, long packed_size,
+			    void **depacked)
 {
 #if defined __ANDROID__ || defined __native_client__
 	/* Don't use external helpers in android */
 	return 0;
 #else
-	FILE *t;
+	void *out;
+	long outlen;
 
 	D_(D_WARN "Depacking file... ");
 
-	if ((t = make_temp_file(temp)) == NULL) {
-		goto err;
-	}
-
 	/* Depack file */
 	D_(D_INFO "External depacker: %s", cmd[0]);
-	if (execute_command(cmd, t) < 0) {
+	if (execute_command(cmd, m, &out, &outlen) < 0) {
 		D_(D_CRIT "failed");
-		goto err2;
+		return -1;
 	}
 
 	D_(D_INFO "done");
 
-	if (fseek(t, 0, SEEK_SET) < 0) {
-		D_(D_CRIT "fseek error");
-		goto err2;
-	}
-
-	if (hio_reopen_file(t, 1, h) < 0) {
-		goto err2;
-	}
-	return 0;
-
-    err2:
-	fclose(t);
-    err:
-	return -1;
+	return reopen_depacked(h, m, cache, digest, packed_size, out, outlen,
+			       depacked);
 #endif
 }
 
-static int decrunch_internal(HIO_HANDLE *h, const struct depacker *depacker)
+static int decrunch_internal(HIO_HANDLE *h, const struct depacker *depacker,
+			     struct module_data *m, struct depack_cache *cache,
+			     const uint8 *digest, long packed_size,
+			     void **depacked)
 {
 	void *out;
 	long outlen;
@@ -259,15 +472,35 @@ static int decrunch_internal(HIO_HANDLE *h, const struct depacker *depacker)
 
 	D_(D_INFO "done");
 
-	if (hio_reopen_mem(out, outlen, 1, h) < 0) {
+	/* The depackers allocate their output with malloc(), move it
+	 * to the context memory if the context has its own allocator */
+	if (m != NULL && m->allocator.alloc != NULL) {
+		void *buf = libxmp_malloc(m, outlen);
+		if (buf != NULL) {
+			memcpy(buf, out, outlen);
+		}
 		free(out);
-		return -1;
+		if ((out = buf) == NULL) {
+			return -1;
+		}
 	}
-	return 0;
+
+	return reopen_depacked(h, m, cache, digest, packed_size, out, outlen,
+			       depacked);
 }
 
-int libxmp_decrunch(HIO_HANDLE *h, const char *filename, char **temp)
+/* Depack the data in h, reopening the handle with the depacked data.
+ * If m is not NULL, the depacked data is allocated for the player
+ * context and may be cached; uncached data is returned in depacked and
+ * must be released with libxmp_free() after the handle is closed.
+ */
+int libxmp_decrunch(HIO_HANDLE *h, const char *filename,
+		    struct module_data *m, void **depacked)
 {
+	struct depack_cache *cache = m != NULL ? m->depack_cache : NULL;
+	struct depack_cache_entry *e;
+	uint8 digest[MD5_DIGEST_LENGTH];
+	long packed_size = 0;
 	unsigned char b[1024];
 	const char *cmd[32];
 	int headersize;
@@ -275,7 +508,6 @@ int libxmp_decrunch(HIO_HANDLE *h, const char *filename, char **temp)
 	const struct depacker *depacker = NULL;
 
 	cmd[0] = NULL;
-	*temp = NULL;
 
 	headersize = hio_read(b, 1, 1024, h);
 	if (headersize < 64) {	/* minimum valid file size */
@@ -325,18 +557,33 @@ int libxmp_decrunch(HIO_HANDLE *h, const char *filename, char **temp)
 		return -1;
 	}
 
-	/* Depack file */
-	if (cmd[0]) {
-		/* When the filename is unknown (because it is a stream) don't use
-		 * external helpers
-		 */
-		if (filename == NULL) {
-			return 0;
+	/* When the filename is unknown (because it is a stream) don't use
+	 * external helpers
+	 */
+	if (cmd[0] && filename == NULL) {
+		return 0;
+	}
+
+	if (cache != NULL && cache->limit > 0 &&
+	    (cmd[0] || (depacker && depacker->depack))) {
+		if (cache_digest(h, digest, &packed_size) < 0) {
+			return -1;
 		}
+		if ((e = cache_find(cache, digest, packed_size)) != NULL) {
+			D_(D_INFO "Use cached data");
+			return hio_reopen_mem(e->data, e->size, 0, h);
+		}
+	} else {
+		cache = NULL;
+	}
 
-		return decrunch_command(h, cmd, temp);
+	/* Depack file */
+	if (cmd[0]) {
+		return decrunch_command(h, cmd, m, cache, digest, packed_size,
+					depacked);
 	} else if (depacker && depacker->depack) {
-		return decrunch_internal(h, depacker);
+		return decrunch_internal(h, depacker, m, cache, digest,
+					 packed_size, depacked);
 	} else {
 		D_(D_INFO "Not packed");
 		return 0;
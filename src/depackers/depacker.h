@@ -29,7 +29,18 @@ struct depacker {
 	int (*depack)(HIO_HANDLE *, void **, long *);
 };
 
-int	libxmp_decrunch		(HIO_HANDLE *h, const char *filename, char **temp);
+struct depack_cache_entry;
+
+struct depack_cache {
+	long limit;			/* maximum size of cached data */
+	long used;			/* size of cached data */
+	struct depack_cache_entry *list;
+};
+
+int	libxmp_decrunch		(HIO_HANDLE *h, const char *filename,
+				 struct module_data *m, void **depacked);
+int	libxmp_set_depack_cache	(struct module_data *, long);
+void	libxmp_free_depack_cache(struct module_data *);
 int	libxmp_exclude_match	(const char *);
 
 LIBXMP_END_DECLS
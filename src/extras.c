@@ -55,16 +55,16 @@ int libxmp_new_channel_extras(struct context_data *ctx, struct channel_data *xc)
 	struct module_data *m = &ctx->m;
 
 	if (HAS_MED_MODULE_EXTRAS(*m)) {
-		if (libxmp_med_new_channel_extras(xc) < 0)
+		if (libxmp_med_new_channel_extras(m, xc) < 0)
 			return -1;
 	} else if (HAS_HMN_MODULE_EXTRAS(*m)) {
-		if (libxmp_hmn_new_channel_extras(xc) < 0)
+		if (libxmp_hmn_new_channel_extras(m, xc) < 0)
 			return -1;
 	} else if (HAS_FAR_MODULE_EXTRAS(*m)) {
-		if (libxmp_far_new_channel_extras(xc) < 0)
+		if (libxmp_far_new_channel_extras(m, xc) < 0)
 			return -1;
 	} else if (HAS_FLT_MODULE_EXTRAS(*m)) {
-		if (libxmp_flt_new_channel_extras(xc) < 0)
+		if (libxmp_flt_new_channel_extras(m, xc) < 0)
 			return -1;
 	}
 
@@ -76,13 +76,13 @@ void libxmp_release_channel_extras(struct context_data *ctx, struct channel_data
 	struct module_data *m = &ctx->m;
 
 	if (HAS_MED_CHANNEL_EXTRAS(*m))
-		libxmp_med_release_channel_extras(xc);
+		libxmp_med_release_channel_extras(m, xc);
 	else if (HAS_HMN_CHANNEL_EXTRAS(*m))
-		libxmp_hmn_release_channel_extras(xc);
+		libxmp_hmn_release_channel_extras(m, xc);
 	else if (HAS_FAR_CHANNEL_EXTRAS(*m))
-		libxmp_far_release_channel_extras(xc);
+		libxmp_far_release_channel_extras(m, xc);
 	else if (HAS_FLT_CHANNEL_EXTRAS(*m))
-		libxmp_flt_release_channel_extras(xc);
+		libxmp_flt_release_channel_extras(m, xc);
 }
 
 void libxmp_reset_channel_extras(struct context_data *ctx, struct channel_data *xc)
@@ -99,6 +99,74 @@ void libxmp_reset_channel_extras(struct context_data *ctx, struct channel_data *
 		libxmp_flt_reset_channel_extras(xc);
 }
 
+int libxmp_channel_extras_size(struct context_data *ctx)
+{
+	struct module_data *m = &ctx->m;
+
+	if (HAS_MED_CHANNEL_EXTRAS(*m))
+		return sizeof(struct med_channel_extras);
+	else if (HAS_HMN_CHANNEL_EXTRAS(*m))
+		return sizeof(struct hmn_channel_extras);
+	else if (HAS_FAR_CHANNEL_EXTRAS(*m))
+		return sizeof(struct far_channel_extras);
+	else if (HAS_FLT_CHANNEL_EXTRAS(*m))
+		return sizeof(struct flt_channel_extras);
+
+	return 0;
+}
+
+/* Memory used by the module and instrument extras, for
+ * xmp_get_memory_usage()
+ */
+unsigned long libxmp_module_extras_usage(struct context_data *ctx)
+{
+	struct module_data *m = &ctx->m;
+	struct xmp_module *mod = &m->mod;
+	struct med_module_extras *me = NULL;
+	unsigned long size = 0;
+	int i;
+
+	if (HAS_MED_MODULE_EXTRAS(*m)) {
+		me = MED_MODULE_EXTRAS(*m);
+		size += sizeof(struct med_module_extras);
+		if (me->vol_table != NULL)
+			size += mod->ins * sizeof(uint8 *);
+		if (me->wav_table != NULL)
+			size += mod->ins * sizeof(uint8 *);
+	} else if (HAS_HMN_MODULE_EXTRAS(*m)) {
+		size += sizeof(struct hmn_module_extras);
+	} else if (HAS_FAR_MODULE_EXTRAS(*m)) {
+		size += sizeof(struct far_module_extras);
+	} else if (HAS_FLT_MODULE_EXTRAS(*m)) {
+		size += sizeof(struct flt_module_extras);
+	}
+
+	if (mod->xxi == NULL)
+		return size;
+
+	for (i = 0; i < mod->ins; i++) {
+		struct xmp_instrument *xxi = &mod->xxi[i];
+
+		if (HAS_MED_INSTRUMENT_EXTRAS(*xxi)) {
+			struct med_instrument_extras *ie = MED_INSTRUMENT_EXTRAS(*xxi);
+
+			size += sizeof(struct med_instrument_extras);
+			if (me != NULL && me->vol_table != NULL &&
+			    me->vol_table[i] != NULL)
+				size += ie->vtlen;
+			if (me != NULL && me->wav_table != NULL &&
+			    me->wav_table[i] != NULL)
+				size += ie->wtlen;
+		} else if (HAS_HMN_INSTRUMENT_EXTRAS(*xxi)) {
+			size += sizeof(struct hmn_instrument_extras);
+		} else if (HAS_FLT_INSTRUMENT_EXTRAS(*xxi)) {
+			size += sizeof(struct flt_instrument_extras);
+		}
+	}
+
+	return size;
+}
+
 /*
  * Player extras
  */
@@ -9,6 +9,8 @@ void libxmp_release_module_extras(struct context_data *);
 int  libxmp_new_channel_extras(struct context_data *, struct channel_data *);
 void libxmp_release_channel_extras(struct context_data *, struct channel_data *);
 void libxmp_reset_channel_extras(struct context_data *, struct channel_data *);
+int  libxmp_channel_extras_size(struct context_data *);
+unsigned long libxmp_module_extras_usage(struct context_data *);
 void libxmp_play_extras(struct context_data *, struct channel_data *, int);
 int  libxmp_extras_get_volume(struct context_data *, struct channel_data *);
 int  libxmp_extras_get_period(struct context_data *, struct channel_data *);
@@ -198,9 +198,9 @@ void libxmp_far_play_extras(struct context_data *ctx, struct channel_data *xc, i
 		libxmp_far_update_vibrato(&xc->vibrato.lfo, ce->vib_rate, me->vib_depth);
 }
 
-int libxmp_far_new_channel_extras(struct channel_data *xc)
+int libxmp_far_new_channel_extras(struct module_data *m, struct channel_data *xc)
 {
-	xc->extra = calloc(1, sizeof(struct far_channel_extras));
+	xc->extra = libxmp_calloc(m, 1, sizeof(struct far_channel_extras));
 	if (xc->extra == NULL)
 		return -1;
 	FAR_CHANNEL_EXTRAS(*xc)->magic = FAR_EXTRAS_MAGIC;
@@ -212,15 +212,15 @@ void libxmp_far_reset_channel_extras(struct channel_data *xc)
 	memset((char *)xc->extra + 4, 0, sizeof(struct far_channel_extras) - 4);
 }
 
-void libxmp_far_release_channel_extras(struct channel_data *xc)
+void libxmp_far_release_channel_extras(struct module_data *m, struct channel_data *xc)
 {
-	free(xc->extra);
+	libxmp_free(m, xc->extra);
 	xc->extra = NULL;
 }
 
 int libxmp_far_new_module_extras(struct module_data *m)
 {
-	m->extra = calloc(1, sizeof(struct far_module_extras));
+	m->extra = libxmp_calloc(m, 1, sizeof(struct far_module_extras));
 	if (m->extra == NULL)
 		return -1;
 	FAR_MODULE_EXTRAS(*m)->magic = FAR_EXTRAS_MAGIC;
@@ -230,7 +230,7 @@ int libxmp_far_new_module_extras(struct module_data *m)
 
 void libxmp_far_release_module_extras(struct module_data *m)
 {
-	free(m->extra);
+	libxmp_free(m, m->extra);
 	m->extra = NULL;
 }
 
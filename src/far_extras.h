@@ -46,9 +46,9 @@ int libxmp_far_translate_tempo(int, int, int, int *, int *, int *);
 
 void libxmp_far_play_extras(struct context_data *, struct channel_data *, int);
 int  libxmp_far_linear_bend(struct context_data *, struct channel_data *);
-int  libxmp_far_new_channel_extras(struct channel_data *);
+int  libxmp_far_new_channel_extras(struct module_data *, struct channel_data *);
 void libxmp_far_reset_channel_extras(struct channel_data *);
-void libxmp_far_release_channel_extras(struct channel_data *);
+void libxmp_far_release_channel_extras(struct module_data *, struct channel_data *);
 int  libxmp_far_new_module_extras(struct module_data *);
 void libxmp_far_release_module_extras(struct module_data *);
 void libxmp_far_extras_process_fx(struct context_data *, struct channel_data *,
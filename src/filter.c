@@ -87,28 +87,43 @@ static const float resonance_table[128] = {
  * Simple 2-poles resonant filter
  */
 #define FREQ_PARAM_MULT (128.0f / (24.0f * 256.0f))
-void libxmp_filter_setup(int srate, int cutoff, int res, int *a0, int *b0, int *b1)
+
+/* Filter coefficients are recalculated every tick when filter envelopes
+ * or MIDI macros change the cutoff, so precompute the term depending on
+ * the cutoff frequency for the sampling rate when the mixer is started.
+ */
+void libxmp_filter_init(struct mixer_data *s)
+{
+	float fc, fs = (float)s->freq;
+	int i;
+
+	for (i = 0; i < 256; i++) {
+		/* [0-255] => [100Hz-8000Hz] */
+		fc = 110.0f * powf(2.0f, (float)i * FREQ_PARAM_MULT + 0.25f);
+		if (fc > fs / 2.0f) {
+			fc = fs / 2.0f;
+		}
+
+		s->filter_r[i] = fs / (2.0 * 3.14159265358979f * fc);
+	}
+}
+
+void libxmp_filter_setup(struct mixer_data *s, int cutoff, int res,
+			 int *a0, int *b0, int *b1)
 {
-	float fc, fs = (float)srate;
 	float fg, fb0, fb1;
 	float r, d, e;
 
-	/* [0-255] => [100Hz-8000Hz] */
 	CLAMP(cutoff, 0, 255);
 	CLAMP(res, 0, 255);
 
-        fc = 110.0f * powf(2.0f, (float)cutoff * FREQ_PARAM_MULT + 0.25f);
-        if (fc > fs / 2.0f) {
-                fc = fs / 2.0f;
-	}
-
-        r = fs / (2.0 * 3.14159265358979f * fc);
-        d = resonance_table[res >> 1] * (r + 1.0) - 1.0;
-        e = r * r;
+	r = s->filter_r[cutoff];
+	d = resonance_table[res >> 1] * (r + 1.0) - 1.0;
+	e = r * r;
 
-        fg = 1.0 / (1.0 + d + e);
-        fb0 = (d + e + e) / (1.0 + d + e);
-        fb1 = -e / (1.0 + d + e);
+	fg = 1.0 / (1.0 + d + e);
+	fb0 = (d + e + e) / (1.0 + d + e);
+	fb1 = -e / (1.0 + d + e);
 
 	*a0 = (int)(fg  * (1 << FILTER_SHIFT));
 	*b0 = (int)(fb0 * (1 << FILTER_SHIFT));
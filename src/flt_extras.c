@@ -107,18 +107,18 @@ void libxmp_flt_play_extras(struct context_data *ctx, struct channel_data *xc, i
 	xc->period += ie->p_fall;
 }
 
-int libxmp_flt_new_instrument_extras(struct xmp_instrument *xxi)
+int libxmp_flt_new_instrument_extras(struct module_data *m, struct xmp_instrument *xxi)
 {
-	xxi->extra = calloc(1, sizeof(struct flt_instrument_extras));
+	xxi->extra = libxmp_calloc(m, 1, sizeof(struct flt_instrument_extras));
 	if (xxi->extra == NULL)
 		return -1;
 	FLT_INSTRUMENT_EXTRAS((*xxi))->magic = FLT_EXTRAS_MAGIC;
 	return 0;
 }
 
-int libxmp_flt_new_channel_extras(struct channel_data *xc)
+int libxmp_flt_new_channel_extras(struct module_data *m, struct channel_data *xc)
 {
-	xc->extra = calloc(1, sizeof(struct flt_channel_extras));
+	xc->extra = libxmp_calloc(m, 1, sizeof(struct flt_channel_extras));
 	if (xc->extra == NULL)
 		return -1;
 	FLT_CHANNEL_EXTRAS((*xc))->magic = FLT_EXTRAS_MAGIC;
@@ -130,15 +130,15 @@ void libxmp_flt_reset_channel_extras(struct channel_data *xc)
 	memset((char *)xc->extra + 4, 0, sizeof(struct flt_channel_extras) - 4);
 }
 
-void libxmp_flt_release_channel_extras(struct channel_data *xc)
+void libxmp_flt_release_channel_extras(struct module_data *m, struct channel_data *xc)
 {
-	free(xc->extra);
+	libxmp_free(m, xc->extra);
 	xc->extra = NULL;
 }
 
 int libxmp_flt_new_module_extras(struct module_data *m)
 {
-	m->extra = calloc(1, sizeof(struct flt_module_extras));
+	m->extra = libxmp_calloc(m, 1, sizeof(struct flt_module_extras));
 	if (m->extra == NULL)
 		return -1;
 	FLT_MODULE_EXTRAS((*m))->magic = FLT_EXTRAS_MAGIC;
@@ -147,6 +147,6 @@ int libxmp_flt_new_module_extras(struct module_data *m)
 
 void libxmp_flt_release_module_extras(struct module_data *m)
 {
-	free(m->extra);
+	libxmp_free(m, m->extra);
 	m->extra = NULL;
 }
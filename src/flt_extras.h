@@ -57,10 +57,10 @@ struct flt_module_extras {
 LIBXMP_BEGIN_DECLS
 
 void libxmp_flt_play_extras(struct context_data *, struct channel_data *, int);
-int  libxmp_flt_new_instrument_extras(struct xmp_instrument *);
-int  libxmp_flt_new_channel_extras(struct channel_data *);
+int  libxmp_flt_new_instrument_extras(struct module_data *, struct xmp_instrument *);
+int  libxmp_flt_new_channel_extras(struct module_data *, struct channel_data *);
 void libxmp_flt_reset_channel_extras(struct channel_data *);
-void libxmp_flt_release_channel_extras(struct channel_data *);
+void libxmp_flt_release_channel_extras(struct module_data *, struct channel_data *);
 int  libxmp_flt_new_module_extras(struct module_data *);
 void libxmp_flt_release_module_extras(struct module_data *);
 
@@ -99,6 +99,117 @@ const struct format_loader *const format_loaders[NUM_FORMATS + 2] = {
 	NULL /* list terminator */
 };
 
+/* Magic bytes checked by the loader test functions. Loaders listed here
+ * reject any file that doesn't contain one of their magic strings at the
+ * given offset, so the loader can be skipped without seeking and reading
+ * from the module. Loaders not listed (formats without a reliable magic,
+ * or detected by heuristics) are always tested. This is only a filter:
+ * loaders are still tested in format_loaders[] order, so the detection
+ * result is the same as testing all of them. Keep the entries in the same
+ * order as format_loaders[] (checked by test_format_magic).
+ */
+#ifndef LIBXMP_NO_FORMAT_MAGIC
+struct format_magic {
+	const struct format_loader *loader;
+	int offset;
+	int size;
+	const char *magic;
+};
+
+static const struct format_magic format_magic[] = {
+	{ &libxmp_loader_xm, 0, 17, "Extended Module: " },
+#ifndef LIBXMP_CORE_DISABLE_IT
+	{ &libxmp_loader_it, 0, 4, "IMPM" },
+#endif
+	{ &libxmp_loader_s3m, 44, 4, "SCRM" },
+#ifndef LIBXMP_CORE_PLAYER
+	{ &libxmp_loader_flt, 1080, 3, "FLT" },
+	{ &libxmp_loader_flt, 1080, 3, "EXO" },
+	{ &libxmp_loader_stx, 20, 8, "!Scream!" },
+	{ &libxmp_loader_stx, 20, 8, "BMOD2STM" },
+	{ &libxmp_loader_mtm, 0, 3, "MTM" },
+	{ &libxmp_loader_ice, 1464, 4, "MTN\0" },
+	{ &libxmp_loader_ice, 1464, 4, "IT10" },
+	{ &libxmp_loader_imf, 60, 4, "IM10" },
+	{ &libxmp_loader_ptm, 44, 4, "PTMF" },
+	{ &libxmp_loader_mdl, 0, 4, "DMDL" },
+	{ &libxmp_loader_ult, 0, 14, "MAS_UTrack_V00" },
+	{ &libxmp_loader_liq, 0, 14, "Liquid Module:" },
+	{ &libxmp_loader_no, 0, 4, "NO\0\0" },
+	{ &libxmp_loader_masi, 0, 4, "PSM " },
+	{ &libxmp_loader_masi16, 0, 4, "PSM\xfe" },
+	{ &libxmp_loader_muse, 0, 4, "MUSE" },
+	{ &libxmp_loader_gal5, 8, 4, "AM  " },
+	{ &libxmp_loader_gal4, 8, 4, "AMFF" },
+	{ &libxmp_loader_amf, 0, 3, "AMF" },
+	{ &libxmp_loader_asylum, 0, 24, "ASYLUM Music Format V1.0" },
+	{ &libxmp_loader_gdm, 0, 4, "GDM\xfe" },
+	{ &libxmp_loader_mmd1, 0, 4, "MMD0" },
+	{ &libxmp_loader_mmd1, 0, 4, "MMD1" },
+	{ &libxmp_loader_mmd1, 0, 4, "MMDC" },
+	{ &libxmp_loader_mmd3, 0, 4, "MMD2" },
+	{ &libxmp_loader_mmd3, 0, 4, "MMD3" },
+	{ &libxmp_loader_med2, 0, 4, "MED\x02" },
+	{ &libxmp_loader_med3, 0, 4, "MED\x03" },
+	{ &libxmp_loader_med4, 0, 4, "MED\x04" },
+	{ &libxmp_loader_chip, 952, 4, "KRIS" },
+	{ &libxmp_loader_rtm, 0, 4, "RTMM" },
+	{ &libxmp_loader_pt3, 8, 4, "MODL" },
+	{ &libxmp_loader_dt, 0, 4, "D.T." },
+	{ &libxmp_loader_mgt, 0, 3, "MGT" },
+	{ &libxmp_loader_arch, 0, 4, "MUSX" },
+	{ &libxmp_loader_sym, 0, 8, "\x02\x01\x13\x13\x14\x12\x01\x0b" },
+	{ &libxmp_loader_digi, 0, 19, "DIGI Booster module" },
+	{ &libxmp_loader_dbm, 0, 4, "DBM0" },
+	{ &libxmp_loader_emod, 8, 4, "EMOD" },
+	{ &libxmp_loader_okt, 0, 8, "OKTASONG" },
+	{ &libxmp_loader_sfx, 60, 4, "SONG" },
+	{ &libxmp_loader_sfx, 124, 4, "SONG" },
+	{ &libxmp_loader_far, 0, 4, "FAR\xfe" },
+	{ &libxmp_loader_hmn, 1080, 4, "FEST" },
+	{ &libxmp_loader_hmn, 1080, 4, "M&K!" },
+	{ &libxmp_loader_stim, 0, 4, "STIM" },
+	{ &libxmp_loader_669, 0, 2, "if" },
+	{ &libxmp_loader_669, 0, 2, "JN" },
+	{ &libxmp_loader_fnk, 0, 4, "Funk" },
+	{ &libxmp_loader_abk, 0, 4, "AmBk" },
+#endif /* LIBXMP_CORE_PLAYER */
+	{ NULL, 0, 0, NULL }
+};
+#endif /* LIBXMP_NO_FORMAT_MAGIC */
+
+/* Check if the module header in buf can be accepted by the loader, given
+ * in format_loaders[] order. Entries in format_magic[] are in the same
+ * order, so *pos is advanced in lockstep instead of searching the whole
+ * table for each loader. Returns 0 if the loader can be skipped, 1 if it
+ * must be tested. Build with LIBXMP_NO_FORMAT_MAGIC to test all loaders,
+ * e.g. to compare results and timings with examples/bench-loaders.c.
+ */
+int libxmp_format_magic_match(const struct format_loader *loader,
+			      const uint8 *buf, int len, int *pos)
+{
+#ifdef LIBXMP_NO_FORMAT_MAGIC
+	return 1;
+#else
+	const struct format_magic *fm = &format_magic[*pos];
+	int match = 0;
+
+	if (fm->loader != loader) {
+		return 1;
+	}
+
+	for (; fm->loader == loader; fm++) {
+		if (fm->offset + fm->size <= len &&
+		    memcmp(buf + fm->offset, fm->magic, fm->size) == 0) {
+			match = 1;
+		}
+	}
+	*pos = fm - format_magic;
+
+	return match;
+#endif
+}
+
 static const char *_farray[NUM_FORMATS + NUM_PW_FORMATS + 1] = { NULL };
 
 const char *const *format_list(void)
@@ -16,6 +16,11 @@ extern const struct format_loader *const format_loaders[];
 
 const char *const *format_list(void);
 
+/* Largest offset + size of the magic bytes checked before testing loaders */
+#define FORMAT_MAGIC_SIZE 1468
+
+int libxmp_format_magic_match(const struct format_loader *, const uint8 *, int, int *);
+
 extern const struct format_loader libxmp_loader_xm;
 extern const struct format_loader libxmp_loader_mod;
 extern const struct format_loader libxmp_loader_it;
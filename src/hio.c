@@ -26,6 +26,14 @@
 #include "callbackio.h"
 #include "mdataio.h"
 
+#ifdef HAVE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 static long get_size(FILE *f)
 {
 	long size, pos;
@@ -54,6 +62,7 @@ int8 hio_read8s(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = read8s(h->handle.file, &err);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread8s(h->handle.mem, &err);
 		break;
@@ -79,6 +88,7 @@ uint8 hio_read8(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = read8(h->handle.file, &err);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread8(h->handle.mem, &err);
 		break;
@@ -104,6 +114,7 @@ uint16 hio_read16l(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = read16l(h->handle.file, &err);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread16l(h->handle.mem, &err);
 		break;
@@ -129,6 +140,7 @@ uint16 hio_read16b(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = read16b(h->handle.file, &err);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread16b(h->handle.mem, &err);
 		break;
@@ -154,6 +166,7 @@ uint32 hio_read24l(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = read24l(h->handle.file, &err);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread24l(h->handle.mem, &err);
 		break;
@@ -179,6 +192,7 @@ uint32 hio_read24b(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = read24b(h->handle.file, &err);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread24b(h->handle.mem, &err);
 		break;
@@ -204,6 +218,7 @@ uint32 hio_read32l(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = read32l(h->handle.file, &err);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread32l(h->handle.mem, &err);
 		break;
@@ -229,6 +244,7 @@ uint32 hio_read32b(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = read32b(h->handle.file, &err);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread32b(h->handle.mem, &err);
 		break;
@@ -260,6 +276,7 @@ size_t hio_read(void *buf, size_t size, size_t num, HIO_HANDLE *h)
 			}
 		}
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mread(buf, size, num, h->handle.mem);
 		if (ret != num) {
@@ -291,6 +308,7 @@ int hio_seek(HIO_HANDLE *h, long offset, int whence)
 			h->error = 0;
 		}
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mseek(h->handle.mem, offset, whence);
 		if (ret < 0) {
@@ -325,6 +343,7 @@ long hio_tell(HIO_HANDLE *h)
 			h->error = errno;
 		}
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mtell(h->handle.mem);
 		if (ret < 0) {
@@ -348,6 +367,7 @@ int hio_eof(HIO_HANDLE *h)
 	switch (HIO_HANDLE_TYPE(h)) {
 	case HIO_HANDLE_TYPE_FILE:
 		return feof(h->handle.file);
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		return meof(h->handle.mem);
 	case HIO_HANDLE_TYPE_CBFILE:
@@ -363,10 +383,63 @@ int hio_error(HIO_HANDLE *h)
 	return error;
 }
 
+#ifdef HAVE_MMAP
+/* Map regular files in memory for read-only access. This avoids copying
+ * the file through the stdio buffers, and lets loaders and depackers use
+ * the faster paths for memory-backed input.
+ */
+static HIO_HANDLE *hio_open_mmap(const char *path)
+{
+	HIO_HANDLE *h;
+	struct stat st;
+	void *ptr;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) ||
+	    st.st_size <= 0 || st.st_size > LONG_MAX) {
+		close(fd);
+		return NULL;
+	}
+
+	ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (ptr == MAP_FAILED)
+		return NULL;
+
+	h = (HIO_HANDLE *) calloc(1, sizeof(HIO_HANDLE));
+	if (h == NULL)
+		goto err;
+
+	h->type = HIO_HANDLE_TYPE_MMAP;
+	h->handle.mem = mcopen(ptr, st.st_size);
+	if (h->handle.mem == NULL)
+		goto err2;
+
+	h->size = st.st_size;
+
+	return h;
+
+    err2:
+	free(h);
+    err:
+	munmap(ptr, st.st_size);
+	return NULL;
+}
+#endif
+
 HIO_HANDLE *hio_open(const char *path, const char *mode)
 {
 	HIO_HANDLE *h;
 
+#ifdef HAVE_MMAP
+	if (!strcmp(mode, "rb") && (h = hio_open_mmap(path)) != NULL)
+		return h;
+#endif
+
 	h = (HIO_HANDLE *) calloc(1, sizeof(HIO_HANDLE));
 	if (h == NULL)
 		goto err;
@@ -475,6 +548,12 @@ static int hio_close_internal(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 		ret = (h->noclose)? 0 : fclose(h->handle.file);
 		break;
+	case HIO_HANDLE_TYPE_MMAP:
+#ifdef HAVE_MMAP
+		munmap((void *)h->handle.mem->start, h->handle.mem->size);
+#endif
+		ret = mclose(h->handle.mem);
+		break;
 	case HIO_HANDLE_TYPE_MEMORY:
 		ret = mclose(h->handle.mem);
 		break;
@@ -553,6 +632,7 @@ const unsigned char *hio_get_underlying_memory(HIO_HANDLE *h)
 	case HIO_HANDLE_TYPE_FILE:
 	case HIO_HANDLE_TYPE_CBFILE:
 		return NULL;
+	case HIO_HANDLE_TYPE_MMAP:
 	case HIO_HANDLE_TYPE_MEMORY:
 		return h->handle.mem->start;
 	}
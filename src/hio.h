@@ -9,7 +9,8 @@
 enum hio_type {
 	HIO_HANDLE_TYPE_FILE,
 	HIO_HANDLE_TYPE_MEMORY,
-	HIO_HANDLE_TYPE_CBFILE
+	HIO_HANDLE_TYPE_CBFILE,
+	HIO_HANDLE_TYPE_MMAP	/* read-only file mapping, uses MFILE */
 };
 
 typedef struct {
@@ -82,18 +82,18 @@ void libxmp_hmn_play_extras(struct context_data *ctx, struct channel_data *xc, i
 	ce->volume = volume;
 }
 
-int libxmp_hmn_new_instrument_extras(struct xmp_instrument *xxi)
+int libxmp_hmn_new_instrument_extras(struct module_data *m, struct xmp_instrument *xxi)
 {
-	xxi->extra = calloc(1, sizeof(struct hmn_instrument_extras));
+	xxi->extra = libxmp_calloc(m, 1, sizeof(struct hmn_instrument_extras));
 	if (xxi->extra == NULL)
 		return -1;
 	HMN_INSTRUMENT_EXTRAS((*xxi))->magic = HMN_EXTRAS_MAGIC;
 	return 0;
 }
 
-int libxmp_hmn_new_channel_extras(struct channel_data *xc)
+int libxmp_hmn_new_channel_extras(struct module_data *m, struct channel_data *xc)
 {
-	xc->extra = calloc(1, sizeof(struct hmn_channel_extras));
+	xc->extra = libxmp_calloc(m, 1, sizeof(struct hmn_channel_extras));
 	if (xc->extra == NULL)
 		return -1;
 	HMN_CHANNEL_EXTRAS((*xc))->magic = HMN_EXTRAS_MAGIC;
@@ -105,15 +105,15 @@ void libxmp_hmn_reset_channel_extras(struct channel_data *xc)
 	memset((char *)xc->extra + 4, 0, sizeof(struct hmn_channel_extras) - 4);
 }
 
-void libxmp_hmn_release_channel_extras(struct channel_data *xc)
+void libxmp_hmn_release_channel_extras(struct module_data *m, struct channel_data *xc)
 {
-	free(xc->extra);
+	libxmp_free(m, xc->extra);
 	xc->extra = NULL;
 }
 
 int libxmp_hmn_new_module_extras(struct module_data *m)
 {
-	m->extra = calloc(1, sizeof(struct hmn_module_extras));
+	m->extra = libxmp_calloc(m, 1, sizeof(struct hmn_module_extras));
 	if (m->extra == NULL)
 		return -1;
 	HMN_MODULE_EXTRAS((*m))->magic = HMN_EXTRAS_MAGIC;
@@ -122,7 +122,7 @@ int libxmp_hmn_new_module_extras(struct module_data *m)
 
 void libxmp_hmn_release_module_extras(struct module_data *m)
 {
-	free(m->extra);
+	libxmp_free(m, m->extra);
 	m->extra = NULL;
 }
 
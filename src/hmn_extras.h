@@ -43,10 +43,10 @@ LIBXMP_BEGIN_DECLS
 void libxmp_hmn_play_extras(struct context_data *, struct channel_data *, int);
 void libxmp_hmn_set_arpeggio(struct channel_data *, int);
 int  libxmp_hmn_linear_bend(struct context_data *, struct channel_data *);
-int  libxmp_hmn_new_instrument_extras(struct xmp_instrument *);
-int  libxmp_hmn_new_channel_extras(struct channel_data *);
+int  libxmp_hmn_new_instrument_extras(struct module_data *, struct xmp_instrument *);
+int  libxmp_hmn_new_channel_extras(struct module_data *, struct channel_data *);
 void libxmp_hmn_reset_channel_extras(struct channel_data *);
-void libxmp_hmn_release_channel_extras(struct channel_data *);
+void libxmp_hmn_release_channel_extras(struct module_data *, struct channel_data *);
 int  libxmp_hmn_new_module_extras(struct module_data *);
 void libxmp_hmn_release_module_extras(struct module_data *);
 void libxmp_hmn_extras_process_fx(struct context_data *, struct channel_data *,
@@ -0,0 +1,4 @@
+#ifndef LIBXMP_CORE_PLAYER
+#define LIBXMP_CORE_PLAYER
+#endif
+#include "../bus.c"
@@ -27,7 +27,6 @@
 #include "loaders/loader.h"
 
 #ifndef LIBXMP_NO_DEPACKERS
-#include "tempfile.h"
 #include "depackers/depacker.h"
 #endif
 
@@ -55,53 +54,80 @@ static void set_md5sum(HIO_HANDLE *f, unsigned char *digest)
 	MD5Final(digest, &ctx);
 }
 
-static char *get_dirname(const char *name)
+static char *copy_name(struct module_data *m, const char *name, size_t len)
+{
+	char *s;
+
+	s = (char *) libxmp_malloc(m, len + 1);
+	if (s != NULL) {
+		memcpy(s, name, len);
+		s[len] = 0;
+	}
+
+	return s;
+}
+
+static char *get_dirname(struct module_data *m, const char *name)
 {
-	char *dirname;
 	const char *p;
-	ptrdiff_t len;
 
 	if ((p = strrchr(name, '/')) != NULL) {
-		len = p - name + 1;
-		dirname = (char *) malloc(len + 1);
-		if (dirname != NULL) {
-			memcpy(dirname, name, len);
-			dirname[len] = 0;
-		}
+		return copy_name(m, name, p - name + 1);
 	} else {
-		dirname = libxmp_strdup("");
+		return copy_name(m, name, 0);
 	}
-
-	return dirname;
 }
 
-static char *get_basename(const char *name)
+static char *get_basename(struct module_data *m, const char *name)
 {
 	const char *p;
-	char *basename;
 
 	if ((p = strrchr(name, '/')) != NULL) {
-		basename = libxmp_strdup(p + 1);
-	} else {
-		basename = libxmp_strdup(name);
+		name = p + 1;
 	}
 
-	return basename;
+	return copy_name(m, name, strlen(name));
 }
 #endif /* LIBXMP_CORE_PLAYER */
 
+/* Get the first bytes of the module to check the loader magic strings */
+static const uint8 *read_magic(HIO_HANDLE *h, uint8 *buf, int *len)
+{
+	const uint8 *mem = hio_get_underlying_memory(h);
+	long size;
+
+	if (mem != NULL) {
+		size = hio_size(h);
+		*len = size < FORMAT_MAGIC_SIZE ? (int)size : FORMAT_MAGIC_SIZE;
+		return mem;
+	}
+
+	hio_seek(h, 0, SEEK_SET);
+	*len = (int)hio_read(buf, 1, FORMAT_MAGIC_SIZE, h);
+	return buf;
+}
+
 static int test_module(struct xmp_test_info *info, HIO_HANDLE *h)
 {
 	char buf[XMP_NAME_SIZE];
-	int i;
+	uint8 magic_buf[FORMAT_MAGIC_SIZE];
+	const uint8 *magic;
+	int i, len, pos;
 
 	if (info != NULL) {
 		*info->name = 0;	/* reset name prior to testing */
 		*info->type = 0;	/* reset type prior to testing */
 	}
 
-	for (i = 0; format_loaders[i] != NULL; i++) {
+	magic = read_magic(h, magic_buf, &len);
+
+	for (pos = i = 0; format_loaders[i] != NULL; i++) {
+		if (!libxmp_format_magic_match(format_loaders[i], magic, len, &pos)) {
+			continue;
+		}
 		hio_seek(h, 0, SEEK_SET);
+		/* Don't leak titles from loaders that failed or were skipped */
+		memset(buf, 0, sizeof(buf));
 		if (format_loaders[i]->test(h, buf, 0) == 0) {
 			int is_prowizard = 0;
 
@@ -130,9 +156,6 @@ static int test_module(struct xmp_test_info *info, HIO_HANDLE *h)
 int xmp_test_module(const char *path, struct xmp_test_info *info)
 {
 	HIO_HANDLE *h;
-#ifndef LIBXMP_NO_DEPACKERS
-	char *temp = NULL;
-#endif
 	int ret;
 
 	ret = libxmp_get_filetype(path);
@@ -149,7 +172,7 @@ int xmp_test_module(const char *path, struct xmp_test_info *info)
 		return -XMP_ERROR_SYSTEM;
 
 #ifndef LIBXMP_NO_DEPACKERS
-	if (libxmp_decrunch(h, path, &temp) < 0) {
+	if (libxmp_decrunch(h, path, NULL, NULL) < 0) {
 		ret = -XMP_ERROR_DEPACK;
 		goto err;
 	}
@@ -159,11 +182,8 @@ int xmp_test_module(const char *path, struct xmp_test_info *info)
 
 #ifndef LIBXMP_NO_DEPACKERS
     err:
-	hio_close(h);
-	unlink_temp_file(temp);
-#else
-	hio_close(h);
 #endif
+	hio_close(h);
 	return ret;
 }
 
@@ -189,15 +209,12 @@ int xmp_test_module_from_file(void *file, struct xmp_test_info *info)
 {
 	HIO_HANDLE *h;
 	int ret;
-#ifndef LIBXMP_NO_DEPACKERS
-	char *temp = NULL;
-#endif
 
 	if ((h = hio_open_file((FILE *)file)) == NULL)
 		return -XMP_ERROR_SYSTEM;
 
 #ifndef LIBXMP_NO_DEPACKERS
-	if (libxmp_decrunch(h, NULL, &temp) < 0) {
+	if (libxmp_decrunch(h, NULL, NULL, NULL) < 0) {
 		ret = -XMP_ERROR_DEPACK;
 		goto err;
 	}
@@ -207,11 +224,8 @@ int xmp_test_module_from_file(void *file, struct xmp_test_info *info)
 
 #ifndef LIBXMP_NO_DEPACKERS
     err:
-	hio_close(h);
-	unlink_temp_file(temp);
-#else
-	hio_close(h);
 #endif
+	hio_close(h);
 	return ret;
 }
 
@@ -230,19 +244,25 @@ int xmp_test_module_from_callbacks(void *priv, struct xmp_callbacks callbacks,
 	return ret;
 }
 
-static int load_module(xmp_context opaque, HIO_HANDLE *h)
+static int load_module(xmp_context opaque, HIO_HANDLE *h, int scan)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct module_data *m = &ctx->m;
 	struct xmp_module *mod = &m->mod;
-	int i, j, ret;
+	uint8 magic_buf[FORMAT_MAGIC_SIZE];
+	const uint8 *magic;
+	int i, j, len, pos, ret;
 	int test_result, load_result;
 
 	libxmp_load_prologue(ctx);
 
 	D_(D_WARN "load");
 	test_result = load_result = -1;
-	for (i = 0; format_loaders[i] != NULL; i++) {
+	magic = read_magic(h, magic_buf, &len);
+	for (pos = i = 0; format_loaders[i] != NULL; i++) {
+		if (!libxmp_format_magic_match(format_loaders[i], magic, len, &pos)) {
+			continue;
+		}
 		hio_seek(h, 0, SEEK_SET);
 
 		D_(D_WARN "test %s", format_loaders[i]->name);
@@ -309,6 +329,7 @@ static int load_module(xmp_context opaque, HIO_HANDLE *h)
 #endif
 
 	libxmp_load_epilogue(ctx);
+	libxmp_pack_tracks(m);
 
 	ret = libxmp_prepare_scan(ctx);
 	if (ret < 0) {
@@ -316,10 +337,12 @@ static int load_module(xmp_context opaque, HIO_HANDLE *h)
 		return ret;
 	}
 
-	ret = libxmp_scan_sequences(ctx);
-	if (ret < 0) {
-		xmp_release_module(opaque);
-		return -XMP_ERROR_LOAD;
+	if (scan && !m->defer_scan) {
+		ret = libxmp_scan_sequences(ctx);
+		if (ret < 0) {
+			xmp_release_module(opaque);
+			return -XMP_ERROR_LOAD;
+		}
 	}
 
 	ctx->state = XMP_STATE_LOADED;
@@ -331,14 +354,14 @@ static int load_module(xmp_context opaque, HIO_HANDLE *h)
 	return -XMP_ERROR_LOAD;
 }
 
-int xmp_load_module(xmp_context opaque, const char *path)
+static int load_module_path(xmp_context opaque, const char *path, int scan)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 #ifndef LIBXMP_CORE_PLAYER
 	struct module_data *m = &ctx->m;
 #endif
 #ifndef LIBXMP_NO_DEPACKERS
-	char *temp_name;
+	void *depacked = NULL;
 #endif
 	HIO_HANDLE *h;
 	int ret;
@@ -361,7 +384,7 @@ int xmp_load_module(xmp_context opaque, const char *path)
 
 #ifndef LIBXMP_NO_DEPACKERS
 	D_(D_INFO "decrunch");
-	if (libxmp_decrunch(h, path, &temp_name) < 0) {
+	if (libxmp_decrunch(h, path, &ctx->m, &depacked) < 0) {
 		ret = -XMP_ERROR_DEPACK;
 		goto err;
 	}
@@ -371,13 +394,13 @@ int xmp_load_module(xmp_context opaque, const char *path)
 		xmp_release_module(opaque);
 
 #ifndef LIBXMP_CORE_PLAYER
-	m->dirname = get_dirname(path);
+	m->dirname = get_dirname(m, path);
 	if (m->dirname == NULL) {
 		ret = -XMP_ERROR_SYSTEM;
 		goto err;
 	}
 
-	m->basename = get_basename(path);
+	m->basename = get_basename(m, path);
 	if (m->basename == NULL) {
 		ret = -XMP_ERROR_SYSTEM;
 		goto err;
@@ -391,11 +414,10 @@ int xmp_load_module(xmp_context opaque, const char *path)
 	ctx->m.basename = NULL;
 #endif
 
-	ret = load_module(opaque, h);
+	ret = load_module(opaque, h, scan);
 	hio_close(h);
-
 #ifndef LIBXMP_NO_DEPACKERS
-	unlink_temp_file(temp_name);
+	libxmp_free(&ctx->m, depacked);
 #endif
 
 	return ret;
@@ -404,13 +426,19 @@ int xmp_load_module(xmp_context opaque, const char *path)
     err:
 	hio_close(h);
 #ifndef LIBXMP_NO_DEPACKERS
-	unlink_temp_file(temp_name);
+	libxmp_free(&ctx->m, depacked);
 #endif
 	return ret;
 #endif
 }
 
-int xmp_load_module_from_memory(xmp_context opaque, const void *mem, long size)
+int xmp_load_module(xmp_context opaque, const char *path)
+{
+	return load_module_path(opaque, path, 1);
+}
+
+static int load_module_mem(xmp_context opaque, const void *mem, long size,
+			   int scan)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct module_data *m = &ctx->m;
@@ -432,13 +460,18 @@ int xmp_load_module_from_memory(xmp_context opaque, const void *mem, long size)
 	m->dirname = NULL;
 	m->size = size;
 
-	ret = load_module(opaque, h);
+	ret = load_module(opaque, h, scan);
 
 	hio_close(h);
 
 	return ret;
 }
 
+int xmp_load_module_from_memory(xmp_context opaque, const void *mem, long size)
+{
+	return load_module_mem(opaque, mem, size, 1);
+}
+
 int xmp_load_module_from_file(xmp_context opaque, void *file, long size)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
@@ -457,7 +490,7 @@ int xmp_load_module_from_file(xmp_context opaque, void *file, long size)
 	m->dirname = NULL;
 	m->size = hio_size(h);
 
-	ret = load_module(opaque, h);
+	ret = load_module(opaque, h, 1);
 
 	hio_close(h);
 
@@ -483,13 +516,69 @@ int xmp_load_module_from_callbacks(xmp_context opaque, void *priv,
 	m->dirname = NULL;
 	m->size = hio_size(h);
 
-	ret = load_module(opaque, h);
+	ret = load_module(opaque, h, 1);
 
 	hio_close(h);
 
 	return ret;
 }
 
+int xmp_test_module_batch(struct xmp_batch_info *items, int num, int flags)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct xmp_module *mod;
+	struct xmp_batch_info *b;
+	int scan = flags & XMP_BATCH_SCAN;
+	int i, count;
+
+	if (items == NULL || num < 0) {
+		return -XMP_ERROR_INVALID;
+	}
+
+	/* Each call uses its own context, so several threads can process
+	 * different items at the same time. Samples are never loaded. */
+	if ((opaque = xmp_create_context()) == NULL) {
+		return -XMP_ERROR_SYSTEM;
+	}
+	ctx = (struct context_data *)opaque;
+	ctx->m.smpctl = XMP_SMPCTL_SKIP;
+	mod = &ctx->m.mod;
+
+	for (count = i = 0; i < num; i++) {
+		b = &items[i];
+
+		if (b->path != NULL) {
+			b->error = load_module_path(opaque, b->path, scan);
+		} else if (b->mem != NULL) {
+			b->error = load_module_mem(opaque, b->mem, b->size, scan);
+		} else {
+			b->error = -XMP_ERROR_INVALID;
+		}
+
+		if (b->error < 0) {
+			b->name[0] = b->type[0] = '\0';
+			b->chn = 0;
+			b->time = -1;
+			continue;
+		}
+
+		strncpy(b->name, mod->name, XMP_NAME_SIZE - 1);
+		b->name[XMP_NAME_SIZE - 1] = '\0';
+		strncpy(b->type, mod->type, XMP_NAME_SIZE - 1);
+		b->type[XMP_NAME_SIZE - 1] = '\0';
+		b->chn = mod->chn;
+		b->time = scan ? ctx->m.seq_data[0].duration : -1;
+		count++;
+
+		xmp_release_module(opaque);
+	}
+
+	xmp_free_context(opaque);
+
+	return count;
+}
+
 void xmp_release_module(xmp_context opaque)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
@@ -514,52 +603,56 @@ void xmp_release_module(xmp_context opaque)
 	libxmp_release_module_extras(ctx);
 #endif
 
+	/* Patterns, subinstruments and tracks are freed with the pool,
+	 * except for shared tracks that weren't moved to it. */
 	if (mod->xxt != NULL) {
-		for (i = 0; i < mod->trk; i++) {
-			free(mod->xxt[i]);
+		if (m->share_tracks && !m->tracks_packed) {
+			for (i = 0; i < mod->trk; i++) {
+				libxmp_free(m, mod->xxt[i]);
+			}
 		}
-		free(mod->xxt);
+		libxmp_free(m, mod->xxt);
 		mod->xxt = NULL;
 	}
+	m->tracks_packed = 0;
 
-	if (mod->xxp != NULL) {
-		for (i = 0; i < mod->pat; i++) {
-			free(mod->xxp[i]);
-		}
-		free(mod->xxp);
-		mod->xxp = NULL;
-	}
+	libxmp_free(m, mod->xxp);
+	mod->xxp = NULL;
 
 	if (mod->xxi != NULL) {
 		for (i = 0; i < mod->ins; i++) {
-			free(mod->xxi[i].sub);
-			free(mod->xxi[i].extra);
+			libxmp_free(m, mod->xxi[i].extra);
 		}
-		free(mod->xxi);
+		libxmp_free(m, mod->xxi);
 		mod->xxi = NULL;
 	}
 
 	if (mod->xxs != NULL) {
 		for (i = 0; i < mod->smp; i++) {
-			libxmp_free_sample(&mod->xxs[i]);
+			libxmp_free_sample(m, &mod->xxs[i]);
+			if (m->xtra != NULL) {
+				libxmp_free(m, m->xtra[i].packed);
+			}
 		}
-		free(mod->xxs);
+		libxmp_free(m, mod->xxs);
 		mod->xxs = NULL;
 	}
 
-	free(m->xtra);
+	libxmp_free(m, m->xtra);
 	free(m->midi);
 	m->xtra = NULL;
 	m->midi = NULL;
 
+	libxmp_free_pool(m);
+
 	libxmp_free_scan(ctx);
 
 	free(m->comment);
 	m->comment = NULL;
 
 	D_("free dirname/basename");
-	free(m->dirname);
-	free(m->basename);
+	libxmp_free(m, m->dirname);
+	libxmp_free(m, m->basename);
 	m->basename = NULL;
 	m->dirname = NULL;
 }
@@ -573,3 +666,20 @@ void xmp_scan_module(xmp_context opaque)
 
 	libxmp_scan_sequences(ctx);
 }
+
+int xmp_decode_sample(xmp_context opaque, int smp)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct module_data *m = &ctx->m;
+
+	if (ctx->state < XMP_STATE_LOADED)
+		return -XMP_ERROR_STATE;
+
+	if (smp < 0 || smp >= m->mod.smp)
+		return -XMP_ERROR_INVALID;
+
+	if (libxmp_unpack_sample(m, smp) < 0)
+		return -XMP_ERROR_LOAD;
+
+	return 0;
+}
@@ -421,11 +421,237 @@ void libxmp_load_epilogue(struct context_data *ctx)
 	libxmp_set_player_mode(ctx);
 }
 
+/* Memory allocation for a player context. Allocations are passed to
+ * the allocator set with xmp_create_context_with_allocator(), if any.
+ */
+void *libxmp_malloc(struct module_data *m, size_t size)
+{
+	const struct xmp_allocator *a = &m->allocator;
+
+	if (a->alloc == NULL)
+		return malloc(size);
+
+	if ((size_t)(unsigned long)size != size)
+		return NULL;
+	return a->alloc(size > 0 ? (unsigned long)size : 1, a->priv);
+}
+
+void *libxmp_calloc(struct module_data *m, size_t num, size_t size)
+{
+	const struct xmp_allocator *a = &m->allocator;
+	void *ptr;
+
+	if (a->alloc == NULL)
+		return calloc(num, size);
+
+	if (size != 0 && num > ((size_t)-1) / size)
+		return NULL;
+	if ((ptr = libxmp_malloc(m, num * size)) != NULL)
+		memset(ptr, 0, num * size);
+	return ptr;
+}
+
+void *libxmp_realloc(struct module_data *m, void *ptr, size_t size)
+{
+	const struct xmp_allocator *a = &m->allocator;
+
+	if (a->alloc == NULL)
+		return realloc(ptr, size);
+
+	if (ptr == NULL)
+		return libxmp_malloc(m, size);
+	if ((size_t)(unsigned long)size != size)
+		return NULL;
+	return a->resize(ptr, (unsigned long)size, a->priv);
+}
+
+void libxmp_free(struct module_data *m, void *ptr)
+{
+	const struct xmp_allocator *a = &m->allocator;
+
+	if (a->alloc == NULL) {
+		free(ptr);
+	} else if (ptr != NULL) {
+		a->release(ptr, a->priv);
+	}
+}
+
+/* Memory pool for the module structures allocated by the loader helpers.
+ * Allocations are zeroed and can't be freed individually: the whole pool
+ * is freed when the module is released.
+ */
+#define POOL_CHUNK_SIZE	(64 * 1024)
+#define POOL_ALIGN(x)	(((x) + 15) & ~(size_t)15)
+
+struct pool_chunk {
+	struct pool_chunk *next;
+	size_t size;
+	size_t used;
+};
+
+void *libxmp_pool_alloc(struct module_data *m, size_t size)
+{
+	struct pool_chunk *chunk = m->pool;
+	size_t header = POOL_ALIGN(sizeof(struct pool_chunk));
+	size_t alloc;
+
+	size = POOL_ALIGN(size);
+
+	if (chunk == NULL || chunk->size - chunk->used < size) {
+		alloc = MAX(POOL_CHUNK_SIZE, header + size);
+		if (alloc - header < size)	/* overflow */
+			return NULL;
+
+		chunk = (struct pool_chunk *) libxmp_calloc(m, 1, alloc);
+		if (chunk == NULL)
+			return NULL;
+
+		chunk->size = alloc;
+		chunk->used = header;
+
+		/* Keep using the current chunk if it has more space left */
+		if (m->pool != NULL && alloc - header - size <
+				m->pool->size - m->pool->used) {
+			chunk->next = m->pool->next;
+			m->pool->next = chunk;
+		} else {
+			chunk->next = m->pool;
+			m->pool = chunk;
+		}
+	}
+
+	chunk->used += size;
+	return (uint8 *)chunk + chunk->used - size;
+}
+
+void libxmp_free_pool(struct module_data *m)
+{
+	struct pool_chunk *chunk, *next;
+
+	for (chunk = m->pool; chunk != NULL; chunk = next) {
+		next = chunk->next;
+		libxmp_free(m, chunk);
+	}
+	m->pool = NULL;
+}
+
+size_t libxmp_pool_size(struct module_data *m)
+{
+	struct pool_chunk *chunk;
+	size_t size = 0;
+
+	for (chunk = m->pool; chunk != NULL; chunk = chunk->next) {
+		size += chunk->size;
+	}
+	return size;
+}
+
+#define TRACK_SIZE(rows) \
+	(sizeof(struct xmp_track) + sizeof(struct xmp_event) * ((rows) - 1))
+
+static uint32 hash_track(const struct xmp_track *xxt)
+{
+	const uint8 *data = (const uint8 *)xxt->event;
+	size_t size = sizeof(struct xmp_event) * xxt->rows;
+	uint32 hash = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return hash ^ (uint32)xxt->rows;
+}
+
+static int same_track(const struct xmp_track *a, const struct xmp_track *b)
+{
+	return a->rows == b->rows && !memcmp(a->event, b->event,
+				sizeof(struct xmp_event) * a->rows);
+}
+
+/* Store a single copy of identical tracks if share_tracks is set. Tracks
+ * are allocated individually in this case, and the tracks to keep are
+ * moved to a single block in the pool. Track numbers in the pattern index
+ * are kept, but tracks with the same events share the same pointer in
+ * xxt[]. If memory can't be allocated, the tracks are left as they are.
+ */
+void libxmp_pack_tracks(struct module_data *m)
+{
+	struct xmp_module *mod = &m->mod;
+	struct xmp_track *xxt;
+	int *table, *canon;
+	size_t size, total;
+	uint8 *arena;
+	int i, j, num;
+
+	if (!m->share_tracks || m->tracks_packed)
+		return;
+	if (mod->xxt == NULL || mod->trk <= 0)
+		return;
+
+	for (num = 16; num < mod->trk * 2; num <<= 1);
+
+	table = (int *) malloc((num + mod->trk) * sizeof(int));
+	if (table == NULL)
+		return;
+	canon = table + num;
+
+	for (i = 0; i < num; i++) {
+		table[i] = -1;
+	}
+
+	/* Find the first track with the same events as each track */
+	total = 0;
+	for (i = 0; i < mod->trk; i++) {
+		xxt = mod->xxt[i];
+		canon[i] = -1;
+		if (xxt == NULL)
+			continue;
+
+		j = hash_track(xxt) & (num - 1);
+		while (table[j] >= 0 && !same_track(mod->xxt[table[j]], xxt)) {
+			j = (j + 1) & (num - 1);
+		}
+		if (table[j] < 0) {
+			table[j] = i;
+			total += TRACK_SIZE(xxt->rows);
+		}
+		canon[i] = table[j];
+	}
+
+	arena = total > 0 ? (uint8 *) libxmp_pool_alloc(m, total) : NULL;
+	if (arena == NULL) {
+		free(table);
+		return;
+	}
+
+	for (i = 0; i < mod->trk; i++) {
+		if (canon[i] == i) {
+			size = TRACK_SIZE(mod->xxt[i]->rows);
+			memcpy(arena, mod->xxt[i], size);
+			libxmp_free(m, mod->xxt[i]);
+			mod->xxt[i] = (struct xmp_track *)arena;
+			arena += size;
+		}
+	}
+	for (i = 0; i < mod->trk; i++) {
+		if (canon[i] >= 0 && canon[i] != i) {
+			libxmp_free(m, mod->xxt[i]);
+			mod->xxt[i] = mod->xxt[canon[i]];
+		}
+	}
+
+	m->tracks_packed = 1;
+	free(table);
+}
+
 int libxmp_prepare_scan(struct context_data *ctx)
 {
 	struct module_data *m = &ctx->m;
 	struct xmp_module *mod = &m->mod;
-	int i, ord;
+	struct xmp_pattern *pat;
+	uint8 *cnt;
+	size_t size;
+	int i, ord, pat_idx;
 
 	if (mod->xxp == NULL || mod->xxt == NULL)
 		return -XMP_ERROR_LOAD;
@@ -439,25 +665,33 @@ int libxmp_prepare_scan(struct context_data *ctx)
 		return 0;
 	}
 
-	m->scan_cnt = (uint8 **) calloc(mod->len, sizeof(uint8 *));
-	if (m->scan_cnt == NULL)
-		return -XMP_ERROR_SYSTEM;
-
+	/* The row counters of all orders are kept in a single block after
+	 * the order index, so only one allocation is needed. */
+	size = mod->len * sizeof(uint8 *);
 	for (i = 0; i < mod->len; i++) {
-		int pat_idx = mod->xxo[i];
-		struct xmp_pattern *pat;
+		pat_idx = mod->xxo[i];
 
 		/* Add pattern if referenced in orders */
 		if (pat_idx < mod->pat && !mod->xxp[pat_idx]) {
-			if (libxmp_alloc_pattern(mod, pat_idx) < 0) {
+			if (libxmp_alloc_pattern(m, pat_idx) < 0) {
 				return -XMP_ERROR_SYSTEM;
 			}
 		}
 
 		pat = pat_idx >= mod->pat ? NULL : mod->xxp[pat_idx];
-		m->scan_cnt[i] = (uint8 *) calloc(1, (pat && pat->rows)? pat->rows : 1);
-		if (m->scan_cnt[i] == NULL)
-			return -XMP_ERROR_SYSTEM;
+		size += (pat && pat->rows)? pat->rows : 1;
+	}
+
+	m->scan_cnt = (uint8 **) libxmp_calloc(m, 1, size);
+	if (m->scan_cnt == NULL)
+		return -XMP_ERROR_SYSTEM;
+
+	cnt = (uint8 *)(m->scan_cnt + mod->len);
+	for (i = 0; i < mod->len; i++) {
+		pat_idx = mod->xxo[i];
+		pat = pat_idx >= mod->pat ? NULL : mod->xxp[pat_idx];
+		m->scan_cnt[i] = cnt;
+		cnt += (pat && pat->rows)? pat->rows : 1;
 	}
 
 	return 0;
@@ -467,21 +701,37 @@ void libxmp_free_scan(struct context_data *ctx)
 {
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
-	struct xmp_module *mod = &m->mod;
-	int i;
-
-	if (m->scan_cnt) {
-		for (i = 0; i < mod->len; i++)
-			free(m->scan_cnt[i]);
 
-		free(m->scan_cnt);
-		m->scan_cnt = NULL;
-	}
+	libxmp_free(m, m->scan_cnt);
+	m->scan_cnt = NULL;
 
-	free(p->scan);
+	libxmp_free(m, p->scan);
 	p->scan = NULL;
 }
 
+/* Decode a sample loaded with XMP_SMPCTL_LAZY. The compressed data is
+ * released even if decoding fails, in which case the sample stays silent.
+ */
+int libxmp_unpack_sample(struct module_data *m, int smp)
+{
+	struct extra_sample_data *xtra;
+	int ret;
+
+	if (smp < 0 || smp >= m->mod.smp)
+		return 0;
+
+	xtra = &m->xtra[smp];
+	if (xtra->packed == NULL)
+		return 0;
+
+	ret = xtra->unpack(m, &m->mod.xxs[smp], xtra->packed, xtra->packed_len);
+	libxmp_free(m, xtra->packed);
+	xtra->packed = NULL;
+	xtra->packed_len = 0;
+
+	return ret;
+}
+
 /* Process player personality flags */
 int libxmp_set_player_mode(struct context_data *ctx)
 {
@@ -157,7 +157,7 @@ static int c669_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	struct xmp_sample *xxs = &mod->xxs[i];
 	struct xmp_subinstrument *sub;
 
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 	    return -1;
 
 	sub = &xxi->sub[0];
@@ -190,7 +190,7 @@ static int c669_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		xxs->flg & XMP_SAMPLE_LOOP ? 'L' : ' ');
     }
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
 	return -1;
 
     /* Read and convert patterns */
@@ -198,7 +198,7 @@ static int c669_load(struct module_data *m, HIO_HANDLE *f, const int start)
     for (i = 0; i < mod->pat; i++) {
 	int pbrk;
 
-	if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 	    return -1;
 
 	event = &EVENT(i, 0, 0);
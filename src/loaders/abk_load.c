@@ -535,7 +535,7 @@ static int abk_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
     for (i = 0; i < mod->ins; i++)
     {
-        if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+        if (libxmp_alloc_subinstrument(m, i, 1) < 0)
         {
             free(ci);
             return -1;
@@ -577,7 +577,7 @@ static int abk_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
     free(ci);
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
     {
         return -1;
     }
@@ -597,7 +597,7 @@ static int abk_load(struct module_data *m, HIO_HANDLE *f, const int start)
     i = 0;
     for (j = 0; j < mod->pat; j++)
     {
-        if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+        if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
         {
             free(playlist.pattern);
             return -1;
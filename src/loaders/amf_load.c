@@ -147,12 +147,12 @@ static int amf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
-	mod->xxp = (struct xmp_pattern **) calloc(mod->pat, sizeof(struct xmp_pattern *));
+	mod->xxp = (struct xmp_pattern **) libxmp_calloc(m, mod->pat, sizeof(struct xmp_pattern *));
 	if (mod->xxp == NULL)
 		return -1;
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern(mod, i) < 0)
+		if (libxmp_alloc_pattern(m, i) < 0)
 			return -1;
 
 		mod->xxp[i]->rows = ver >= 0x0e ? hio_read16l(f) : 64;
@@ -233,7 +233,7 @@ static int amf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < mod->ins; i++) {
 		int c2spd;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		hio_read8(f);
@@ -342,12 +342,12 @@ static int amf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	D_(D_INFO "Stored tracks: %d", mod->trk - 1);
 
-	mod->xxt = (struct xmp_track **) calloc(mod->trk, sizeof(struct xmp_track *));
+	mod->xxt = (struct xmp_track **) libxmp_calloc(m, mod->trk, sizeof(struct xmp_track *));
 	if (mod->xxt == NULL)
 		return -1;
 
 	/* Alloc track 0 as empty track */
-	if (libxmp_alloc_track(mod, 0, 64) < 0)
+	if (libxmp_alloc_track(m, 0, 64) < 0)
 		return -1;
 
 	/* Alloc rest of the tracks */
@@ -355,7 +355,7 @@ static int amf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		uint8 t1, t2, t3;
 		int size;
 
-		if (libxmp_alloc_track(mod, i, 64) < 0)	/* FIXME! */
+		if (libxmp_alloc_track(m, i, 64) < 0)	/* FIXME! */
 			return -1;
 
 		/* Previous versions loaded this as a 24-bit value, but it's
@@ -324,7 +324,7 @@ static int get_patt(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 		data->max_pat = 0;
 		mod->trk = mod->pat * mod->chn;
 
-		if (libxmp_init_pattern(mod) < 0)
+		if (libxmp_init_pattern(m) < 0)
 			return -1;
 	}
 
@@ -334,7 +334,7 @@ static int get_patt(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 
         i = data->max_pat;
 
-	if (libxmp_alloc_pattern_tracks(mod, i, data->rows[i]) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, data->rows[i]) < 0)
 		return -1;
 
 	for (j = 0; j < data->rows[i]; j++) {
@@ -385,7 +385,7 @@ static int get_samp(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 	i = data->max_ins;
 
 	mod->xxi[i].nsm = 1;
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 		return -1;
 
 	if (hio_read32b(f) != MAGIC_SNAM)	/* SNAM */
@@ -92,7 +92,7 @@ static int asylum_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < mod->ins; i++) {
 		uint8 insbuf[37];
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)	{
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)	{
 			return -1;
 		}
 
@@ -130,7 +130,7 @@ static int asylum_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	D_(D_INFO "Module length: %d", mod->len);
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	/* Read and convert patterns */
@@ -138,7 +138,7 @@ static int asylum_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	for (i = 0; i < mod->pat; i++) {
 		uint8 *pos;
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		if (hio_read(buf, 1, 2048, f) < 2048) {
@@ -121,7 +121,7 @@ static int chip_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		struct xmp_sample *xxs = &mod->xxs[i];
 		struct xmp_subinstrument *sub;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			goto err2;
 
 		sub = &xxi->sub[0];
@@ -141,11 +141,11 @@ static int chip_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		libxmp_instrument_name(mod, i, mh.ins[i].name, 22);
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		goto err2;
 
 	for (i = 0; i < mod->len; i++) {
-		if (libxmp_alloc_pattern(mod, i) < 0)
+		if (libxmp_alloc_pattern(m, i) < 0)
 			goto err2;
 		mod->xxp[i]->rows = 64;
 
@@ -159,7 +159,7 @@ static int chip_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	D_(D_INFO "Stored tracks: %d", mod->trk);
 
 	for (i = 0; i < mod->trk; i++) {
-		if (libxmp_alloc_track(mod, i, 64) < 0)
+		if (libxmp_alloc_track(m, i, 64) < 0)
 			goto err2;
 
 		for (j = 0; j < 64; j++) {
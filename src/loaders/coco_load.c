@@ -219,7 +219,7 @@ static int coco_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	m->volbase = 0xff;
 
 	for (i = 0; i < mod->ins; i++) {
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		smp_ptr[i] = hio_read32l(f);
@@ -266,7 +266,7 @@ static int coco_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	/* Patterns */
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
@@ -275,7 +275,7 @@ static int coco_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		return -1;
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		for (j = 0; j < 64; j++) {
@@ -38,7 +38,7 @@ int libxmp_init_instrument(struct module_data *m)
 	struct xmp_module *mod = &m->mod;
 
 	if (mod->ins > 0) {
-		mod->xxi = (struct xmp_instrument *) calloc(mod->ins, sizeof(struct xmp_instrument));
+		mod->xxi = (struct xmp_instrument *) libxmp_calloc(m, mod->ins, sizeof(struct xmp_instrument));
 		if (mod->xxi == NULL)
 			return -1;
 	}
@@ -52,10 +52,10 @@ int libxmp_init_instrument(struct module_data *m)
 			return -1;
 		}
 
-		mod->xxs = (struct xmp_sample *) calloc(mod->smp, sizeof(struct xmp_sample));
+		mod->xxs = (struct xmp_sample *) libxmp_calloc(m, mod->smp, sizeof(struct xmp_sample));
 		if (mod->xxs == NULL)
 			return -1;
-		m->xtra = (struct extra_sample_data *) calloc(mod->smp, sizeof(struct extra_sample_data));
+		m->xtra = (struct extra_sample_data *) libxmp_calloc(m, mod->smp, sizeof(struct extra_sample_data));
 		if (m->xtra == NULL)
 			return -1;
 
@@ -83,19 +83,19 @@ int libxmp_realloc_samples(struct module_data *m, int new_size)
 	if (new_size == 0) {
 		/* Don't rely on implementation-defined realloc(x,0) behavior. */
 		mod->smp = 0;
-		free(mod->xxs);
+		libxmp_free(m, mod->xxs);
 		mod->xxs = NULL;
-		free(m->xtra);
+		libxmp_free(m, m->xtra);
 		m->xtra = NULL;
 		return 0;
 	}
 
-	xxs = (struct xmp_sample *) realloc(mod->xxs, sizeof(struct xmp_sample) * new_size);
+	xxs = (struct xmp_sample *) libxmp_realloc(m, mod->xxs, sizeof(struct xmp_sample) * new_size);
 	if (xxs == NULL)
 		return -1;
 	mod->xxs = xxs;
 
-	xtra = (struct extra_sample_data *) realloc(m->xtra, sizeof(struct extra_sample_data) * new_size);
+	xtra = (struct extra_sample_data *) libxmp_realloc(m, m->xtra, sizeof(struct extra_sample_data) * new_size);
 	if (xtra == NULL)
 		return -1;
 	m->xtra = xtra;
@@ -115,53 +115,68 @@ int libxmp_realloc_samples(struct module_data *m, int new_size)
 	return 0;
 }
 
-int libxmp_alloc_subinstrument(struct xmp_module *mod, int i, int num)
+int libxmp_alloc_subinstrument(struct module_data *m, int i, int num)
 {
+	struct xmp_module *mod = &m->mod;
+
 	if (num == 0)
 		return 0;
 
-	mod->xxi[i].sub = (struct xmp_subinstrument *) calloc(num, sizeof(struct xmp_subinstrument));
+	mod->xxi[i].sub = (struct xmp_subinstrument *) libxmp_pool_alloc(m,
+		sizeof(struct xmp_subinstrument) * num);
 	if (mod->xxi[i].sub == NULL)
 		return -1;
 
 	return 0;
 }
 
-int libxmp_init_pattern(struct xmp_module *mod)
+int libxmp_init_pattern(struct module_data *m)
 {
-	mod->xxt = (struct xmp_track **) calloc(mod->trk, sizeof(struct xmp_track *));
+	struct xmp_module *mod = &m->mod;
+
+	mod->xxt = (struct xmp_track **) libxmp_calloc(m, mod->trk, sizeof(struct xmp_track *));
 	if (mod->xxt == NULL)
 		return -1;
 
-	mod->xxp = (struct xmp_pattern **) calloc(mod->pat, sizeof(struct xmp_pattern *));
+	mod->xxp = (struct xmp_pattern **) libxmp_calloc(m, mod->pat, sizeof(struct xmp_pattern *));
 	if (mod->xxp == NULL)
 		return -1;
 
 	return 0;
 }
 
-int libxmp_alloc_pattern(struct xmp_module *mod, int num)
+int libxmp_alloc_pattern(struct module_data *m, int num)
 {
+	struct xmp_module *mod = &m->mod;
+
 	/* Sanity check */
 	if (num < 0 || num >= mod->pat || mod->xxp[num] != NULL)
 		return -1;
 
-	mod->xxp[num] = (struct xmp_pattern *) calloc(1, sizeof(struct xmp_pattern) +
-							 sizeof(int) * (mod->chn - 1));
+	mod->xxp[num] = (struct xmp_pattern *) libxmp_pool_alloc(m,
+		sizeof(struct xmp_pattern) + sizeof(int) * (mod->chn - 1));
 	if (mod->xxp[num] == NULL)
 		return -1;
 
 	return 0;
 }
 
-int libxmp_alloc_track(struct xmp_module *mod, int num, int rows)
+int libxmp_alloc_track(struct module_data *m, int num, int rows)
 {
+	struct xmp_module *mod = &m->mod;
+	size_t size;
+
 	/* Sanity check */
 	if (num < 0 || num >= mod->trk || mod->xxt[num] != NULL || rows <= 0)
 		return -1;
 
-	mod->xxt[num] = (struct xmp_track *) calloc(1,  sizeof(struct xmp_track) +
-							sizeof(struct xmp_event) * (rows - 1));
+	/* Shared tracks are moved to the pool after loading */
+	size = sizeof(struct xmp_track) + sizeof(struct xmp_event) * (rows - 1);
+	if (m->share_tracks) {
+		mod->xxt[num] = (struct xmp_track *) libxmp_calloc(m, 1, size);
+	} else {
+		mod->xxt[num] = (struct xmp_track *) libxmp_pool_alloc(m, size);
+	}
 	if (mod->xxt[num] == NULL)
 		return -1;
 
@@ -170,8 +185,9 @@ int libxmp_alloc_track(struct xmp_module *mod, int num, int rows)
 	return 0;
 }
 
-int libxmp_alloc_tracks_in_pattern(struct xmp_module *mod, int num)
+int libxmp_alloc_tracks_in_pattern(struct module_data *m, int num)
 {
+	struct xmp_module *mod = &m->mod;
 	int i;
 
 	D_(D_INFO "Alloc %d tracks of %d rows", mod->chn, mod->xxp[num]->rows);
@@ -179,7 +195,7 @@ int libxmp_alloc_tracks_in_pattern(struct xmp_module *mod, int num)
 		int t = num * mod->chn + i;
 		int rows = mod->xxp[num]->rows;
 
-		if (libxmp_alloc_track(mod, t, rows) < 0)
+		if (libxmp_alloc_track(m, t, rows) < 0)
 			return -1;
 
 		mod->xxp[num]->index[i] = t;
@@ -188,18 +204,20 @@ int libxmp_alloc_tracks_in_pattern(struct xmp_module *mod, int num)
 	return 0;
 }
 
-int libxmp_alloc_pattern_tracks(struct xmp_module *mod, int num, int rows)
+int libxmp_alloc_pattern_tracks(struct module_data *m, int num, int rows)
 {
+	struct xmp_module *mod = &m->mod;
+
 	/* Sanity check */
 	if (rows <= 0 || rows > 256)
 		return -1;
 
-	if (libxmp_alloc_pattern(mod, num) < 0)
+	if (libxmp_alloc_pattern(m, num) < 0)
 		return -1;
 
 	mod->xxp[num]->rows = rows;
 
-	if (libxmp_alloc_tracks_in_pattern(mod, num) < 0)
+	if (libxmp_alloc_tracks_in_pattern(m, num) < 0)
 		return -1;
 
 	return 0;
@@ -209,18 +227,20 @@ int libxmp_alloc_pattern_tracks(struct xmp_module *mod, int num, int rows)
 /* Some formats explicitly allow more than 256 rows (e.g. OctaMED). This function
  * allows those formats to work without disrupting the sanity check for other formats.
  */
-int libxmp_alloc_pattern_tracks_long(struct xmp_module *mod, int num, int rows)
+int libxmp_alloc_pattern_tracks_long(struct module_data *m, int num, int rows)
 {
+	struct xmp_module *mod = &m->mod;
+
 	/* Sanity check */
 	if (rows <= 0 || rows > 32768)
 		return -1;
 
-	if (libxmp_alloc_pattern(mod, num) < 0)
+	if (libxmp_alloc_pattern(m, num) < 0)
 		return -1;
 
 	mod->xxp[num]->rows = rows;
 
-	if (libxmp_alloc_tracks_in_pattern(mod, num) < 0)
+	if (libxmp_alloc_tracks_in_pattern(m, num) < 0)
 		return -1;
 
 	return 0;
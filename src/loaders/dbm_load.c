@@ -236,7 +236,7 @@ static int get_inst(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 		xxi = &mod->xxi[i];
 
 		xxi->nsm = 1;
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		if (hio_read(buffer, 1, 50, f) < 50)
@@ -292,7 +292,7 @@ static int get_patt(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 	}
 	data->have_patt = 1;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored patterns: %d ", mod->pat);
@@ -307,7 +307,7 @@ static int get_patt(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 		if (hio_error(f))
 			return -1;
 
-		if (libxmp_alloc_pattern_tracks(mod, i, rows) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, rows) < 0)
 			return -1;
 
 		sz = hio_read32b(f);
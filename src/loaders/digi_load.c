@@ -159,7 +159,7 @@ static int digi_load(struct module_data *m, HIO_HANDLE *f, const int start)
     /* Read and convert instruments and samples */
 
     for (i = 0; i < mod->ins; i++) {
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 	    return -1;
 
 	mod->xxs[i].len = dh.slen[i];
@@ -181,14 +181,14 @@ static int digi_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		mod->xxs[i].flg & XMP_SAMPLE_LOOP ? 'L' : ' ', mod->xxi[i].sub[0].vol);
     }
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
 	return -1;
 
     /* Read and convert patterns */
     D_(D_INFO "Stored patterns: %d", mod->pat);
 
     for (i = 0; i < mod->pat; i++) {
-	if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 	    return -1;
 
 	if (dh.pack) {
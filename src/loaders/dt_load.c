@@ -569,7 +569,7 @@ static int get_inst(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 		int len, repstart, replen;
 		int fine, stereo, midinote;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		if (hio_read(buf, 1, 50, f) < 50)
@@ -719,7 +719,7 @@ static int get_dapt(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 		data->pflag = 1;
 		data->last_pat = 0;
 
-		if (libxmp_init_pattern(mod) < 0)
+		if (libxmp_init_pattern(m) < 0)
 			return -1;
 	}
 
@@ -743,7 +743,7 @@ static int get_dapt(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 	}
 
 	for (i = data->last_pat; i <= pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, rows) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, rows) < 0)
 			return -1;
 	}
 	data->last_pat = pat + 1;
@@ -894,7 +894,7 @@ static int dt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	/* alloc remaining patterns */
 	if (mod->xxp != NULL) {
 		for (i = data.last_pat; i < mod->pat; i++) {
-			if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0) {
+			if (libxmp_alloc_pattern_tracks(m, i, 64) < 0) {
 				return -1;
 			}
 		}
@@ -97,7 +97,7 @@ static int get_emic(struct module_data *m, uint32 size, HIO_HANDLE * f, void *pa
 		struct xmp_subinstrument *sub;
 		uint8 name[20];
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		sub = &xxi->sub[0];
@@ -128,7 +128,7 @@ static int get_emic(struct module_data *m, uint32 size, HIO_HANDLE * f, void *pa
 	mod->pat = hio_read8(f);
 	mod->trk = mod->pat * mod->chn;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	memset(reorder, 0, sizeof(reorder));
@@ -136,7 +136,7 @@ static int get_emic(struct module_data *m, uint32 size, HIO_HANDLE * f, void *pa
 	for (i = 0; i < mod->pat; i++) {
 		reorder[hio_read8(f)] = i;
 
-		if (libxmp_alloc_pattern_tracks(mod, i, hio_read8(f) + 1) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, hio_read8(f) + 1) < 0)
 			return -1;
 
 		hio_seek(f, 20, SEEK_CUR);	/* skip name */
@@ -306,7 +306,7 @@ static int far_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
     MODULE_INFO();
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
 	return -1;
 
     /* Read and convert patterns */
@@ -321,7 +321,7 @@ static int far_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	uint8 *pos;
 	int rows;
 
-	if (libxmp_alloc_pattern(mod, i) < 0)
+	if (libxmp_alloc_pattern(m, i) < 0)
 	    goto err;
 
 	if (!ffh2.patsize[i])
@@ -336,7 +336,7 @@ static int far_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	mod->xxp[i]->rows = rows;
 
-	if (libxmp_alloc_tracks_in_pattern(mod, i) < 0)
+	if (libxmp_alloc_tracks_in_pattern(m, i) < 0)
 	    goto err;
 
 	brk = hio_read8(f) + 1;
@@ -391,7 +391,7 @@ static int far_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	int pat = mod->xxo[i];
 	if (mod->xxp[pat]->rows == 0) {
 	    mod->xxp[pat]->rows = 64;
-	    if (libxmp_alloc_tracks_in_pattern(mod, pat) < 0)
+	    if (libxmp_alloc_tracks_in_pattern(m, pat) < 0)
 		return -1;
 	}
     }
@@ -418,7 +418,7 @@ static int far_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	if (!(sample_map[i / 8] & (1 << (i % 8))))
 		continue;
 
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 	    return -1;
 
 	hio_read(fih.name, 32, 1, f);	/* Instrument name */
@@ -277,7 +277,7 @@ static int read_am_instrument(struct module_data *m, HIO_HANDLE *nt, int i)
 	xxi->sub[0].vde = am.v_amp * 4;
 	xxi->sub[0].vra = am.v_spd;
 
-	if (libxmp_flt_new_instrument_extras(xxi) < 0)
+	if (libxmp_flt_new_instrument_extras(m, xxi) < 0)
 		return -1;
 
 	extra = FLT_INSTRUMENT_EXTRAS(*xxi);
@@ -428,7 +428,7 @@ static int flt_load(struct module_data *m, HIO_HANDLE * f, const int start)
 		struct xmp_sample *xxs = &mod->xxs[i];
 		struct xmp_subinstrument *sub;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			goto err;
 
 		sub = &xxi->sub[0];
@@ -449,7 +449,7 @@ static int flt_load(struct module_data *m, HIO_HANDLE * f, const int start)
 		libxmp_instrument_name(mod, i, mh.ins[i].name, 22);
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		goto err;
 
 	/* Load and convert patterns */
@@ -468,7 +468,7 @@ static int flt_load(struct module_data *m, HIO_HANDLE * f, const int start)
 	 *  the normal portamento command, that would be hard to patch).
 	 */
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			goto err;
 
 		for (j = 0; j < (64 * 4); j++) {
@@ -313,7 +313,7 @@ static int fnk_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
     /* Convert instruments */
     for (i = 0; i < mod->ins; i++) {
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 	    return -1;
 
 	mod->xxs[i].len = ffh.fih[i].length;
@@ -340,14 +340,14 @@ static int fnk_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		mod->xxi[i].sub[0].vol, mod->xxi[i].sub[0].pan);
     }
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
 	return -1;
 
     /* Read and convert patterns */
     D_(D_INFO "Stored patterns: %d", mod->pat);
 
     for (i = 0; i < mod->pat; i++) {
-	if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 	    return -1;
 
 	EVENT(i, 0, ffh.pbrk[i]).f2t = FX_BREAK;
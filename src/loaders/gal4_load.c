@@ -167,7 +167,7 @@ static int get_patt(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 
 	rows = hio_read8(f) + 1;
 
-	if (libxmp_alloc_pattern_tracks(mod, i, rows) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, rows) < 0)
 		return -1;
 
 	for (r = 0; r < rows; ) {
@@ -326,7 +326,7 @@ static int get_inst(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 	if (xxi->nsm == 0)
 		return 0;
 
-	if (libxmp_alloc_subinstrument(mod, i, xxi->nsm) < 0)
+	if (libxmp_alloc_subinstrument(m, i, xxi->nsm) < 0)
 		return -1;
 
 	for (j = 0; j < xxi->nsm; j++, data->snum++) {
@@ -443,7 +443,7 @@ static int gal4_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	if (libxmp_init_instrument(m) < 0)
 		return -1;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
@@ -477,7 +477,7 @@ static int gal4_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	/* Alloc missing patterns */
 	for (i = 0; i < mod->pat; i++) {
 		if (mod->xxp[i] == NULL) {
-			if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0) {
+			if (libxmp_alloc_pattern_tracks(m, i, 64) < 0) {
 				return -1;
 			}
 		}
@@ -162,7 +162,7 @@ static int get_patt(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 	if (len < 0 || mod->xxp[i] != NULL)
 		return -1;
 
-	if (libxmp_alloc_pattern_tracks(mod, i, rows) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, rows) < 0)
 		return -1;
 
 	for (r = 0; r < rows; ) {
@@ -242,7 +242,7 @@ static int get_inst(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 	if (xxi->nsm == 0)
 		return 0;
 
-	if (libxmp_alloc_subinstrument(mod, i, xxi->nsm) < 0)
+	if (libxmp_alloc_subinstrument(m, i, xxi->nsm) < 0)
 		return -1;
 
 	/* FIXME: Currently reading only the first sample */
@@ -362,7 +362,7 @@ static int gal5_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	if (libxmp_init_instrument(m) < 0)
 		return -1;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
@@ -396,7 +396,7 @@ static int gal5_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	/* Alloc missing patterns */
 	for (i = 0; i < mod->pat; i++) {
 		if (mod->xxp[i] == NULL) {
-			if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0) {
+			if (libxmp_alloc_pattern_tracks(m, i, 64) < 0) {
 				return -1;
 			}
 		}
@@ -251,7 +251,7 @@ static int gdm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < mod->ins; i++) {
 		int flg, c4spd, vol, pan;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		if (hio_read(buffer, 1, 32, f) != 32)
@@ -364,7 +364,7 @@ static int gdm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	mod->trk = mod->pat * mod->chn;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	hio_seek(f, start + pat_ofs, SEEK_SET);
@@ -373,7 +373,7 @@ static int gdm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < mod->pat; i++) {
 		int len, c, r, k;
 
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		len = hio_read16l(f);
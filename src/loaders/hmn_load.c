@@ -216,7 +216,7 @@ static int hmn_load(struct module_data *m, HIO_HANDLE * f, const int start)
 			snprintf(mod->xxi[i].name, 32,
 				"Mupp %02x %02x %02x", mupp[i].pattno,
 				mupp[i].dataloopstart, mupp[i].dataloopend);
-			if (libxmp_hmn_new_instrument_extras(&mod->xxi[i]) != 0)
+			if (libxmp_hmn_new_instrument_extras(m, &mod->xxi[i]) != 0)
 				return -1;
 		} else {
 			mod->xxi[i].nsm = 1;
@@ -230,7 +230,7 @@ static int hmn_load(struct module_data *m, HIO_HANDLE * f, const int start)
 						XMP_SAMPLE_LOOP : 0;
 		}
 
-		if (libxmp_alloc_subinstrument(mod, i, mod->xxi[i].nsm) < 0)
+		if (libxmp_alloc_subinstrument(m, i, mod->xxi[i].nsm) < 0)
 			return -1;
 
 		for (j = 0; j < mod->xxi[i].nsm; j++) {
@@ -242,14 +242,14 @@ static int hmn_load(struct module_data *m, HIO_HANDLE * f, const int start)
 		}
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	/* Load and convert patterns */
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		for (j = 0; j < (64 * 4); j++) {
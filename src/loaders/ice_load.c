@@ -127,7 +127,7 @@ static int ice_load(struct module_data *m, HIO_HANDLE * f, const int start)
 		struct xmp_instrument *xxi;
 		struct xmp_sample *xxs;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		xxi = &mod->xxi[i];
@@ -151,13 +151,13 @@ static int ice_load(struct module_data *m, HIO_HANDLE * f, const int start)
 		   xxi->sub[0].vol, xxi->sub[0].fin >> 4);
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern(mod, i) < 0)
+		if (libxmp_alloc_pattern(m, i) < 0)
 			return -1;
 		mod->xxp[i]->rows = 64;
 
@@ -170,7 +170,7 @@ static int ice_load(struct module_data *m, HIO_HANDLE * f, const int start)
 	D_(D_INFO "Stored tracks: %d", mod->trk);
 
 	for (i = 0; i < mod->trk; i++) {
-		if (libxmp_alloc_track(mod, i, 64) < 0)
+		if (libxmp_alloc_track(m, i, 64) < 0)
 			return -1;
 
 		for (j = 0; j < mod->xxt[i]->rows; j++) {
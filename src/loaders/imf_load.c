@@ -318,7 +318,7 @@ static int imf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
     m->c4rate = C4_NTSC_RATE;
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
 	return -1;
 
     /* Read patterns */
@@ -337,7 +337,7 @@ static int imf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	    return -1;
 	}
 
-	if (libxmp_alloc_pattern_tracks(mod, i, rows) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, rows) < 0)
 	    return -1;
 
 	r = 0;
@@ -437,7 +437,7 @@ static int imf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	xxi->nsm = ii.nsm;
 
 	if (xxi->nsm > 0) {
-	    if (libxmp_alloc_subinstrument(mod, i, xxi->nsm) < 0)
+	    if (libxmp_alloc_subinstrument(m, i, xxi->nsm) < 0)
 		return -1;
 	}
 
@@ -539,13 +539,7 @@ static int imf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	}
     }
 
-    mod->smp = smp_num;
-    mod->xxs = (struct xmp_sample *) realloc(mod->xxs, sizeof(struct xmp_sample) * mod->smp);
-    if (mod->xxs == NULL) {
-        return -1;
-    }
-    m->xtra = (struct extra_sample_data *) realloc(m->xtra, sizeof(struct extra_sample_data) * mod->smp);
-    if (m->xtra == NULL) {
+    if (libxmp_realloc_samples(m, smp_num) < 0) {
         return -1;
     }
 
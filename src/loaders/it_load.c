@@ -444,8 +444,10 @@ static void identify_tracker(struct module_data *m, struct it_file_header *ifh,
 #endif
 }
 
-static int load_old_it_instrument(struct xmp_instrument *xxi, HIO_HANDLE *f)
+static int load_old_it_instrument(struct module_data *m, int i, HIO_HANDLE *f)
 {
+	struct xmp_module *mod = &m->mod;
+	struct xmp_instrument *xxi = &mod->xxi[i];
 	uint8 inst_map[255], inst_rmap[XMP_MAX_KEYS];
 	struct it_instrument1_header i1h;
 	int c, k, j;
@@ -543,8 +545,7 @@ static int load_old_it_instrument(struct xmp_instrument *xxi, HIO_HANDLE *f)
 	xxi->vol = 0x40;
 
 	if (k) {
-		xxi->sub = (struct xmp_subinstrument *) calloc(k, sizeof(struct xmp_subinstrument));
-		if (xxi->sub == NULL) {
+		if (libxmp_alloc_subinstrument(m, i, k) < 0) {
 			return -1;
 		}
 
@@ -573,8 +574,10 @@ static int load_old_it_instrument(struct xmp_instrument *xxi, HIO_HANDLE *f)
 	return 0;
 }
 
-static int load_new_it_instrument(struct xmp_instrument *xxi, HIO_HANDLE *f)
+static int load_new_it_instrument(struct module_data *m, int i, HIO_HANDLE *f)
 {
+	struct xmp_module *mod = &m->mod;
+	struct xmp_instrument *xxi = &mod->xxi[i];
 	uint8 inst_map[255], inst_rmap[XMP_MAX_KEYS];
 	struct it_instrument2_header i2h;
 	struct it_envelope env;
@@ -693,8 +696,7 @@ static int load_new_it_instrument(struct xmp_instrument *xxi, HIO_HANDLE *f)
 	xxi->vol = MIN(i2h.gbv, 128) >> 1;
 
 	if (k) {
-		xxi->sub = (struct xmp_subinstrument *) calloc(k, sizeof(struct xmp_subinstrument));
-		if (xxi->sub == NULL)
+		if (libxmp_alloc_subinstrument(m, i, k) < 0)
 			return -1;
 
 		for (j = 0; j < k; j++) {
@@ -747,7 +749,8 @@ static void force_sample_length(struct xmp_sample *xxs, struct extra_sample_data
 }
 
 static void *unpack_it_sample(struct xmp_sample *xxs,
-	const struct it_sample_header *ish, uint8 *tmpbuf, HIO_HANDLE *f)
+	const struct it_sample_header *ish, uint8 *tmpbuf, int tmplen,
+	HIO_HANDLE *f)
 {
 	void *decbuf;
 	int bytes = xxs->len;
@@ -771,7 +774,7 @@ static void *unpack_it_sample(struct xmp_sample *xxs,
 
 		for (i = 0; i < channels; i++) {
 			itsex_decompress16(f, pos, xxs->len,
-					   tmpbuf, TEMP_BUFFER_LEN,
+					   tmpbuf, tmplen,
 					   ish->convert & IT_CVT_DIFF);
 			pos += xxs->len;
 		}
@@ -780,7 +783,7 @@ static void *unpack_it_sample(struct xmp_sample *xxs,
 
 		for(i = 0; i < channels; i++) {
 			itsex_decompress8(f, pos, xxs->len,
-					  tmpbuf, TEMP_BUFFER_LEN,
+					  tmpbuf, tmplen,
 					  ish->convert & IT_CVT_DIFF);
 			pos += xxs->len;
 		}
@@ -788,6 +791,120 @@ static void *unpack_it_sample(struct xmp_sample *xxs,
 	return decbuf;
 }
 
+static int it_sample_cvt(int convert)
+{
+	int cvt = 0;
+
+	if (convert == IT_CVT_ADPCM)
+		cvt |= SAMPLE_FLAG_ADPCM;
+
+	if (~convert & IT_CVT_SIGNED)
+		cvt |= SAMPLE_FLAG_UNS;
+
+	return cvt;
+}
+
+static int load_it_compressed(struct module_data *m, struct xmp_sample *xxs,
+	const struct it_sample_header *ish, uint8 *tmpbuf, int tmplen,
+	HIO_HANDLE *f)
+{
+	int cvt = it_sample_cvt(ish->convert);
+	void *decbuf;
+	int ret;
+
+	decbuf = unpack_it_sample(xxs, ish, tmpbuf, tmplen, f);
+	if (decbuf == NULL)
+		return -1;
+
+#ifdef WORDS_BIGENDIAN
+	if (ish->flags & IT_SMP_16BIT) {
+		/* decompression generates native-endian
+		 * samples, but we want little-endian.
+		 */
+		cvt |= SAMPLE_FLAG_BIGEND;
+	}
+#endif
+
+	ret = libxmp_load_sample(m, NULL, SAMPLE_FLAG_NOLOAD | cvt, xxs, decbuf);
+	free(decbuf);
+
+	return ret;
+}
+
+/* Decode a sample deferred with XMP_SMPCTL_LAZY. The blocks are read in
+ * place, since the data is padded past the end of the last block.
+ */
+static int it_unpack(struct module_data *m, struct xmp_sample *xxs,
+		     const uint8 *data, int len)
+{
+	struct it_sample_header ish;
+	HIO_HANDLE *f;
+	int ret;
+
+	ish.flags = 0;
+	if (xxs->flg & XMP_SAMPLE_16BIT)
+		ish.flags |= IT_SMP_16BIT;
+	if (xxs->flg & XMP_SAMPLE_STEREO)
+		ish.flags |= IT_SMP_STEREO;
+	ish.convert = data[0];
+
+	if ((f = hio_open_const_mem(data + 1, len - 1)) == NULL)
+		return -1;
+
+	ret = load_it_compressed(m, xxs, &ish, NULL, 0, f);
+	hio_close(f);
+
+	return ret;
+}
+
+/* Find the size of the compressed blocks of a sample and keep them to
+ * decode when the sample is first played. The convert flags are kept in
+ * the first byte.
+ */
+static int it_lazy(struct module_data *m, struct xmp_sample *xxs, int smp,
+		   const struct it_sample_header *ish, HIO_HANDLE *f)
+{
+	int block = ish->flags & IT_SMP_16BIT ? 0x4000 : 0x8000;
+	int channels = ish->flags & IT_SMP_STEREO ? 2 : 1;
+	long start = hio_tell(f);
+	long size = 0;
+	uint8 *data;
+	int i, n;
+
+	if (start < 0)
+		return -1;
+
+	for (i = 0; i < channels; i++) {
+		for (n = 0; n < xxs->len; n += block) {
+			int len = hio_read16l(f);
+			if (hio_error(f) || hio_seek(f, len, SEEK_CUR) < 0)
+				return -1;
+			size += len + 2;
+		}
+	}
+
+	if (size > hio_size(f) - start || size > INT_MAX - 5)
+		return -1;
+
+	if ((data = (uint8 *)libxmp_malloc(m, size + 5)) == NULL)
+		return -1;
+
+	data[0] = ish->convert;
+	if (hio_seek(f, start, SEEK_SET) < 0 ||
+	    hio_read(data + 1, 1, size, f) != (size_t)size) {
+		libxmp_free(m, data);
+		return -1;
+	}
+	memset(data + 1 + size, 0, 4);
+
+	m->xtra[smp].packed = data;
+	m->xtra[smp].packed_len = size + 5;
+	m->xtra[smp].unpack = it_unpack;
+	libxmp_check_sample_loop(xxs);
+
+	return 0;
+}
+
 static int load_it_sample(struct module_data *m, int i, int start,
 			  int sample_mode, uint8 *tmpbuf, HIO_HANDLE *f)
 {
@@ -799,8 +916,7 @@ static int load_it_sample(struct module_data *m, int i, int start,
 	uint8 buf[80];
 
 	if (sample_mode) {
-		mod->xxi[i].sub = (struct xmp_subinstrument *) calloc(1, sizeof(struct xmp_subinstrument));
-		if (mod->xxi[i].sub == NULL) {
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0) {
 			return -1;
 		}
 	}
@@ -918,7 +1034,7 @@ static int load_it_sample(struct module_data *m, int i, int start,
 	}
 
 	if (ish.flags & IT_SMP_SAMPLE && xxs->len > 1) {
-		int cvt = 0;
+		int cvt = it_sample_cvt(ish.convert);
 
 		/* Sanity check - some modules may have invalid sizes on
 		 * unused samples so only check this if the sample flag is set. */
@@ -932,18 +1048,10 @@ static int load_it_sample(struct module_data *m, int i, int start,
 		if (xxs->lpe > xxs->len || xxs->lps >= xxs->lpe)
 			xxs->flg &= ~XMP_SAMPLE_LOOP;
 
-		if (ish.convert == IT_CVT_ADPCM)
-			cvt |= SAMPLE_FLAG_ADPCM;
-
-		if (~ish.convert & IT_CVT_SIGNED)
-			cvt |= SAMPLE_FLAG_UNS;
-
 		/* compressed samples */
 		if (ish.flags & IT_SMP_COMP) {
 			long min_size, file_len, left;
-			void *decbuf;
 			int samples = xxs->len;
-			int ret;
 
 			if (ish.flags & IT_SMP_STEREO)
 				samples <<= 1;
@@ -968,27 +1076,17 @@ static int load_it_sample(struct module_data *m, int i, int start,
 				force_sample_length(xxs, xtra, left << 3);
 			}
 
-			decbuf = unpack_it_sample(xxs, &ish, tmpbuf, f);
-			if (decbuf == NULL)
-				return -1;
-
-#ifdef WORDS_BIGENDIAN
-			if (ish.flags & IT_SMP_16BIT) {
-				/* decompression generates native-endian
-				 * samples, but we want little-endian.
-				 */
-				cvt |= SAMPLE_FLAG_BIGEND;
+			if ((m->smpctl & XMP_SMPCTL_LAZY) &&
+			    (~m->smpctl & XMP_SMPCTL_SKIP)) {
+				if (it_lazy(m, xxs, i, &ish, f) == 0)
+					return 0;
+				if (hio_seek(f, start + ish.sample_ptr, SEEK_SET) != 0)
+					return -1;
 			}
-#endif
 
-			ret = libxmp_load_sample(m, NULL, SAMPLE_FLAG_NOLOAD | cvt,
-					  &mod->xxs[i], decbuf);
-			if (ret < 0) {
-				free(decbuf);
+			if (load_it_compressed(m, xxs, &ish, tmpbuf,
+					       TEMP_BUFFER_LEN, f) < 0)
 				return -1;
-			}
-
-			free(decbuf);
 		} else {
 			if (libxmp_load_sample(m, f, cvt, &mod->xxs[i], NULL) < 0)
 				return -1;
@@ -1020,7 +1118,7 @@ static int load_it_pattern(struct module_data *m, int i, int new_fx,
 	pat_len = hio_read16l(f) /* - 4 */ ;
 	mod->xxp[i]->rows = num_rows = hio_read16l(f);
 
-	if (libxmp_alloc_tracks_in_pattern(mod, i) < 0) {
+	if (libxmp_alloc_tracks_in_pattern(m, i) < 0) {
 		return -1;
 	}
 
@@ -1321,15 +1419,13 @@ static int it_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		 * different loader for each of them.
 		 */
 
-		struct xmp_instrument *xxi = &mod->xxi[i];
-
 		if (!sample_mode && ifh.cmwt >= 0x200) {
 			/* New instrument format */
 			if (hio_seek(f, start + pp_ins[i], SEEK_SET) < 0) {
 				goto err4;
 			}
 
-			if (load_new_it_instrument(xxi, f) < 0) {
+			if (load_new_it_instrument(m, i, f) < 0) {
 				goto err4;
 			}
 
@@ -1339,7 +1435,7 @@ static int it_load(struct module_data *m, HIO_HANDLE *f, const int start)
 				goto err4;
 			}
 
-			if (load_old_it_instrument(xxi, f) < 0) {
+			if (load_old_it_instrument(m, i, f) < 0) {
 				goto err4;
 			}
 		}
@@ -1441,14 +1537,14 @@ static int it_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	mod->chn = max_ch + 1;
 	mod->trk = mod->pat * mod->chn;
 
-	if (libxmp_init_pattern(mod) < 0) {
+	if (libxmp_init_pattern(m) < 0) {
 		goto err4;
 	}
 
 	/* Read patterns */
 	for (i = 0; i < mod->pat; i++) {
 
-		if (libxmp_alloc_pattern(mod, i) < 0) {
+		if (libxmp_alloc_pattern(m, i) < 0) {
 			goto err4;
 		}
 
@@ -1457,7 +1553,7 @@ static int it_load(struct module_data *m, HIO_HANDLE *f, const int start)
 			mod->xxp[i]->rows = 64;
 			for (j = 0; j < mod->chn; j++) {
 				int tnum = i * mod->chn + j;
-				if (libxmp_alloc_track(mod, tnum, 64) < 0)
+				if (libxmp_alloc_track(m, tnum, 64) < 0)
 					goto err4;
 				mod->xxp[i]->index[j] = tnum;
 			}
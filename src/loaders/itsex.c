@@ -2,6 +2,9 @@
 
 /* Modified by Alice Rowan (2023-2024)- more or less complete
  * rewrite of the input stream to add buffering.
+ *
+ * Blocks of memory-backed or mapped modules are read in place instead
+ * of being copied to the temporary buffer first.
  */
 
 #include "../common.h"
@@ -15,7 +18,7 @@
 
 struct it_stream
 {
-	uint8 *pos;
+	const uint8 *pos;
 	size_t left;
 	uint32 bits;
 	int num_bits;
@@ -49,6 +52,10 @@ static inline uint32 read_bits(struct it_stream *in, int n)
 			   ((uint32)in->pos[3] << 24);
 
 		used = MIN(in->left, 4);
+		if (used < 4) {
+			/* Discard bytes past the end of the block. */
+			in->bits &= READ_BITS_MASK(used * 8);
+		}
 
 		in->num_bits = used * 8;
 		in->pos += 4;
@@ -67,6 +74,7 @@ static inline uint32 read_bits(struct it_stream *in, int n)
 static inline int init_block(struct it_stream *in, uint8 *tmp, int tmplen,
 			     HIO_HANDLE *src)
 {
+	const uint8 *mem = hio_get_underlying_memory(src);
 	size_t i;
 	in->pos = tmp;
 	in->left = hio_read16l(src);
@@ -74,9 +82,24 @@ static inline int init_block(struct it_stream *in, uint8 *tmp, int tmplen,
 	in->num_bits = 0;
 	in->err = 0;
 
-	/* tmp should be INT16_MAX rounded up to a multiple of 4 bytes long. */
-	if (tmplen < (int)((in->left + 4) & ~3))
+	/* read_bits may read up to 3 bytes past the end of the block, so
+	 * only read in place if they are still inside the buffer. */
+	if (mem != NULL) {
+		long offset = hio_tell(src);
+
+		if (offset >= 0 && (long)in->left + 3 <= hio_size(src) - offset) {
+			in->pos = mem + offset;
+			if (hio_seek(src, in->left, SEEK_CUR) < 0)
+				return -1;
+			return 0;
+		}
+	}
+
+	/* tmp should be INT16_MAX rounded up to a multiple of 4 bytes long,
+	 * or may be NULL if all blocks can be read in place. */
+	if (tmp == NULL || tmplen < (int)((in->left + 4) & ~3))
 		return -1;
+
 	if (hio_read(tmp, 1, in->left, src) < in->left)
 		return -1;
 
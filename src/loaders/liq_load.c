@@ -420,7 +420,7 @@ static int liq_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
     MODULE_INFO();
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
 	return -1;
 
     /* Read and convert patterns */
@@ -431,7 +431,7 @@ static int liq_load(struct module_data *m, HIO_HANDLE *f, const int start)
     for (i = 0; i < mod->pat; i++) {
 	int row, channel, count;
 
-	if (libxmp_alloc_pattern(mod, i) < 0)
+	if (libxmp_alloc_pattern(m, i) < 0)
 	    return -1;
 
 	pmag = hio_read32b(f);
@@ -456,7 +456,7 @@ static int liq_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	D_(D_INFO "rows: %d  size: %d\n", lp.rows, lp.size);
 
 	mod->xxp[i]->rows = lp.rows;
-	libxmp_alloc_tracks_in_pattern(mod, i);
+	libxmp_alloc_tracks_in_pattern(m, i);
 
 	row = 0;
 	channel = 0;
@@ -623,7 +623,7 @@ next_pattern:
 	struct xmp_sample *xxs = &mod->xxs[i];
 	uint32 ldss_magic;
 
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 	    return -1;
 
 	sub = &xxi->sub[0];
@@ -32,14 +32,14 @@ LIBXMP_BEGIN_DECLS
 
 int	libxmp_init_instrument		(struct module_data *);
 int	libxmp_realloc_samples		(struct module_data *, int);
-int	libxmp_alloc_subinstrument	(struct xmp_module *, int, int);
-int	libxmp_init_pattern		(struct xmp_module *);
-int	libxmp_alloc_pattern		(struct xmp_module *, int);
-int	libxmp_alloc_track		(struct xmp_module *, int, int);
-int	libxmp_alloc_tracks_in_pattern	(struct xmp_module *, int);
-int	libxmp_alloc_pattern_tracks	(struct xmp_module *, int, int);
+int	libxmp_alloc_subinstrument	(struct module_data *, int, int);
+int	libxmp_init_pattern		(struct module_data *);
+int	libxmp_alloc_pattern		(struct module_data *, int);
+int	libxmp_alloc_track		(struct module_data *, int, int);
+int	libxmp_alloc_tracks_in_pattern	(struct module_data *, int);
+int	libxmp_alloc_pattern_tracks	(struct module_data *, int, int);
 #ifndef LIBXMP_CORE_PLAYER
-int	libxmp_alloc_pattern_tracks_long(struct xmp_module *, int, int);
+int	libxmp_alloc_pattern_tracks_long(struct module_data *, int, int);
 #endif
 char	*libxmp_instrument_name		(struct xmp_module *, int, uint8 *, int);
 
@@ -56,7 +56,8 @@ int	libxmp_find_instrument_file	(struct module_data *, struct libxmp_path *, con
 void	libxmp_set_type			(struct module_data *, const char *, ...);
 int	libxmp_load_sample		(struct module_data *, HIO_HANDLE *, int,
 					 struct xmp_sample *, const void *);
-void	libxmp_free_sample		(struct xmp_sample *);
+void	libxmp_free_sample		(struct module_data *, struct xmp_sample *);
+void	libxmp_check_sample_loop	(struct xmp_sample *);
 #ifndef LIBXMP_CORE_PLAYER
 void	libxmp_schism_tracker_string	(char *, size_t, int, int);
 void	libxmp_apply_mpt_preamp	(struct module_data *m);
@@ -304,7 +304,7 @@ static int masi16_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		if (xxi->sub)
 			continue;
 
-		if (libxmp_alloc_subinstrument(mod, num, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, num, 1) < 0)
 			return -1;
 
 		sub = &xxi->sub[0];
@@ -350,7 +350,7 @@ static int masi16_load(struct module_data *m, HIO_HANDLE *f, const int start)
 			'L' : ' ', sub->vol, c2spd);
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
@@ -370,7 +370,7 @@ static int masi16_load(struct module_data *m, HIO_HANDLE *f, const int start)
 			return -1;
 		}
 
-		if (libxmp_alloc_pattern_tracks(mod, i, rows) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, rows) < 0)
 			return -1;
 
 		for (r = 0; r < rows; r++) {
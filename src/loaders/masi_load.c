@@ -181,7 +181,7 @@ static int get_dsmp(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 	hio_seek(f, data->sinaria ? 8 : 4, SEEK_CUR);	/* smpid */
 
 	i = data->cur_ins;
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 		return -1;
 
 	xxi = &mod->xxi[i];
@@ -266,7 +266,7 @@ static int get_pbod(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 		return -1;
 	}
 
-	if (libxmp_alloc_pattern_tracks(mod, i, rows) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, rows) < 0)
 		return -1;
 
 	r = 0;
@@ -782,7 +782,7 @@ static int masi_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	if (libxmp_init_instrument(m) < 0)
 		goto err3;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		goto err3;
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
@@ -434,14 +434,14 @@ static int get_chunk_pa(struct module_data *m, uint32 size, HIO_HANDLE *f, void
 
     mod->pat = hio_read8(f);
 
-    mod->xxp = (struct xmp_pattern **) calloc(mod->pat, sizeof(struct xmp_pattern *));
+    mod->xxp = (struct xmp_pattern **) libxmp_calloc(m, mod->pat, sizeof(struct xmp_pattern *));
     if (mod->xxp == NULL)
         return -1;
 
     D_(D_INFO "Stored patterns: %d", mod->pat);
 
     for (i = 0; i < mod->pat; i++) {
-	if (libxmp_alloc_pattern(mod, i) < 0)
+	if (libxmp_alloc_pattern(m, i) < 0)
 	    return -1;
 
 	chn = hio_read8(f);
@@ -475,14 +475,14 @@ static int get_chunk_p0(struct module_data *m, uint32 size, HIO_HANDLE *f, void
 
     mod->pat = hio_read8(f);
 
-    mod->xxp = (struct xmp_pattern **) calloc(mod->pat, sizeof(struct xmp_pattern *));
+    mod->xxp = (struct xmp_pattern **) libxmp_calloc(m, mod->pat, sizeof(struct xmp_pattern *));
     if (mod->xxp == NULL)
         return -1;
 
     D_(D_INFO "Stored patterns: %d", mod->pat);
 
     for (i = 0; i < mod->pat; i++) {
-	if (libxmp_alloc_pattern(mod, i) < 0)
+	if (libxmp_alloc_pattern(m, i) < 0)
 	    return -1;
 	mod->xxp[i]->rows = 64;
 
@@ -525,7 +525,7 @@ static int get_chunk_tr(struct module_data *m, uint32 size, HIO_HANDLE *f, void
 	return -1;
     }
 
-    mod->xxt = (struct xmp_track **) calloc(mod->trk, sizeof(struct xmp_track *));
+    mod->xxt = (struct xmp_track **) libxmp_calloc(m, mod->trk, sizeof(struct xmp_track *));
     if (mod->xxt == NULL)
 	return -1;
 
@@ -537,7 +537,7 @@ static int get_chunk_tr(struct module_data *m, uint32 size, HIO_HANDLE *f, void
 	goto err;
 
     /* Empty track 0 is not stored in the file */
-    if (libxmp_alloc_track(mod, 0, 256) < 0)
+    if (libxmp_alloc_track(m, 0, 256) < 0)
 	goto err2;
 
     for (i = 1; i < mod->trk; i++) {
@@ -611,7 +611,7 @@ static int get_chunk_tr(struct module_data *m, uint32 size, HIO_HANDLE *f, void
 	    row = 128;
 	else row = 256;
 
-	if (libxmp_alloc_track(mod, i, row) < 0)
+	if (libxmp_alloc_track(m, i, row) < 0)
 	    goto err2;
 
 	memcpy(mod->xxt[i], track, sizeof (struct xmp_track) +
@@ -655,7 +655,7 @@ static int get_chunk_ii(struct module_data *m, uint32 size, HIO_HANDLE *f, void
     mod->ins = hio_read8(f);
     D_(D_INFO "Instruments: %d", mod->ins);
 
-    mod->xxi = (struct xmp_instrument *) calloc(mod->ins, sizeof(struct xmp_instrument));
+    mod->xxi = (struct xmp_instrument *) libxmp_calloc(m, mod->ins, sizeof(struct xmp_instrument));
     if (mod->xxi == NULL)
 	return -1;
 
@@ -673,7 +673,7 @@ static int get_chunk_ii(struct module_data *m, uint32 size, HIO_HANDLE *f, void
 
 	D_(D_INFO "[%2X] %-32.32s %2d", data->i_index[i], xxi->name, xxi->nsm);
 
-	if (libxmp_alloc_subinstrument(mod, i, xxi->nsm) < 0)
+	if (libxmp_alloc_subinstrument(m, i, xxi->nsm) < 0)
 	    return -1;
 
 	for (j = 0; j < XMP_MAX_KEYS; j++)
@@ -745,10 +745,10 @@ static int get_chunk_is(struct module_data *m, uint32 size, HIO_HANDLE *f, void
     data->has_is = 1;
 
     mod->smp = hio_read8(f);
-    mod->xxs = (struct xmp_sample *) calloc(mod->smp, sizeof(struct xmp_sample));
+    mod->xxs = (struct xmp_sample *) libxmp_calloc(m, mod->smp, sizeof(struct xmp_sample));
     if (mod->xxs == NULL)
 	return -1;
-    m->xtra = (struct extra_sample_data *) calloc(mod->smp, sizeof(struct extra_sample_data));
+    m->xtra = (struct extra_sample_data *) libxmp_calloc(m, mod->smp, sizeof(struct extra_sample_data));
     if (m->xtra == NULL)
         return -1;
 
@@ -847,7 +847,7 @@ static int get_chunk_i0(struct module_data *m, uint32 size, HIO_HANDLE *f, void
 	int c5spd;
 
 	xxi->nsm = 1;
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 	    return -1;
 
 	sub = &xxi->sub[0];
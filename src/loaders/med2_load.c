@@ -77,7 +77,7 @@ static int med2_load(struct module_data *m, HIO_HANDLE *f, const int start)
 			return -1;
 
 		libxmp_instrument_name(mod, i, buf, 40);
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 	}
 
@@ -138,14 +138,14 @@ static int med2_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	if (sliding == 6)
 		m->quirk |= QUIRK_VSALL | QUIRK_PBALL;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	/* Load and convert patterns */
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		hio_read32b(f);
@@ -274,7 +274,7 @@ static int med3_load(struct module_data *m, HIO_HANDLE *f, const int start)
 				break;
 		}
 		libxmp_instrument_name(mod, i, buf, 32);
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 	}
 
@@ -350,7 +350,7 @@ static int med3_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < 32; i++)
 		mod->xxi[i].sub[0].xpo = transp;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	/* Load and convert patterns */
@@ -362,7 +362,7 @@ static int med3_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		/*uint8 tracks;*/
 		uint16 convsz;
 
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		/* TODO: not clear if this should be respected. Later MED
@@ -199,7 +199,7 @@ static int med4_load_sampled_instrument(HIO_HANDLE *f, struct module_data *m,
 	xxi = &mod->xxi[i];
 
 	xxi->nsm = 1;
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 		return -1;
 
 	sub = &xxi->sub[0];
@@ -317,13 +317,13 @@ static int med4_load_synth_instrument(HIO_HANDLE *f, struct module_data *m,
 
 	xxi = &mod->xxi[i];
 
-	if (libxmp_med_new_instrument_extras(xxi) != 0)
+	if (libxmp_med_new_instrument_extras(m, xxi) != 0)
 		return -1;
 
 	MED_MODULE_EXTRAS(*m)->tracker_version = MED_VER_210;
 
 	xxi->nsm = synth.wforms;
-	if (libxmp_alloc_subinstrument(mod, i, synth.wforms) < 0)
+	if (libxmp_alloc_subinstrument(m, i, synth.wforms) < 0)
 		return -1;
 
 	ie = MED_INSTRUMENT_EXTRAS(*xxi);
@@ -684,7 +684,7 @@ static int med4_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	mod->trk = mod->chn * mod->pat;
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	hio_seek(f, pos, SEEK_SET);
@@ -733,7 +733,7 @@ static int med4_load(struct module_data *m, HIO_HANDLE *f, const int start)
 #endif
 		}
 
-		if (libxmp_alloc_pattern_tracks(mod, i, rows) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, rows) < 0)
 			return -1;
 
 		/* initialize masks */
@@ -43,7 +43,8 @@ static int mfp_test(HIO_HANDLE *f, char *t, const int start)
 	uint8 buf[384];
 	int i, len, lps, lsz;
 
-	if (HIO_HANDLE_TYPE(f) != HIO_HANDLE_TYPE_FILE)
+	if (HIO_HANDLE_TYPE(f) != HIO_HANDLE_TYPE_FILE &&
+	    HIO_HANDLE_TYPE(f) != HIO_HANDLE_TYPE_MMAP)
 		return -1;
 
 	if (hio_read(buf, 1, 384, f) < 384)
@@ -133,7 +134,7 @@ static int mfp_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < 31; i++) {
 		int loop_size;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		mod->xxs[i].len = 2 * hio_read16b(f);
@@ -231,14 +232,14 @@ static int mfp_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		mod->trk++;
 	}
 
-	if (libxmp_init_pattern(mod) < 0) {
+	if (libxmp_init_pattern(m) < 0) {
 		free(mapping);
 		free(track_offs);
 		return -1;
 	}
 
 	for (i = 0; i < mod->len; i++) {
-		if (libxmp_alloc_pattern(mod, i) < 0) {
+		if (libxmp_alloc_pattern(m, i) < 0) {
 			free(mapping);
 			free(track_offs);
 			return -1;
@@ -260,7 +261,7 @@ static int mfp_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < mod->trk; i++) {
 		int len;
 
-		if (libxmp_alloc_track(mod, i, 64) < 0) {
+		if (libxmp_alloc_track(m, i, 64) < 0) {
 			free(track_offs);
 			return -1;
 		}
@@ -143,7 +143,7 @@ static int mgt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < mod->ins; i++) {
 		int c2spd, flags;
 
-		if (libxmp_alloc_subinstrument(mod, i , 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i , 1) < 0)
 			return -1;
 
 		hio_read(mod->xxi[i].name, 1, 32, f);
@@ -189,7 +189,7 @@ static int mgt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	}
 
 	/* PATTERN_INIT - alloc extra track*/
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored tracks: %d", mod->trk);
@@ -216,7 +216,7 @@ static int mgt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		if (rows > 255)
 			return -1;
 
-		if (libxmp_alloc_track(mod, i, rows) < 0)
+		if (libxmp_alloc_track(m, i, rows) < 0)
 			return -1;
 
 		//printf("\n=== Track %d ===\n\n", i);
@@ -334,9 +334,8 @@ static int mgt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	/* Extra track */
 	if (mod->trk > 0) {
-		mod->xxt[0] = (struct xmp_track *) calloc(1, sizeof(struct xmp_track) +
-							     sizeof(struct xmp_event) * 64 - 1);
-		mod->xxt[0]->rows = 64;
+		if (libxmp_alloc_track(m, 0, 64) < 0)
+			return -1;
 	}
 
 	/* Read and convert patterns */
@@ -347,7 +346,7 @@ static int mgt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < mod->pat; i++) {
 		int rows;
 
-		if (libxmp_alloc_pattern(mod, i) < 0)
+		if (libxmp_alloc_pattern(m, i) < 0)
 			return -1;
 
 		rows = hio_read16b(f);
@@ -394,7 +394,7 @@ static int mmd1_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	 * Read and convert patterns
 	 */
 	D_(D_WARN "read patterns");
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		goto err_cleanup;
 
 	if ((patbuf = (uint8 *)malloc(mod->chn * max_lines * 4)) == NULL) {
@@ -457,7 +457,7 @@ static int mmd1_load(struct module_data *m, HIO_HANDLE *f, const int start)
 			}
 		}
 
-		if (libxmp_alloc_pattern_tracks_long(mod, i, block.lines + 1) < 0)
+		if (libxmp_alloc_pattern_tracks_long(m, i, block.lines + 1) < 0)
 			goto err_cleanup;
 
 		pos = patbuf;
@@ -399,7 +399,7 @@ static int mmd3_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	 */
 	D_(D_WARN "read patterns");
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		goto err_cleanup;
 
 	if ((patbuf = (uint8 *)malloc(mod->chn * max_lines * 4)) == NULL) {
@@ -425,7 +425,7 @@ static int mmd3_load(struct module_data *m, HIO_HANDLE *f, const int start)
 			goto err_cleanup;
 		}
 
-		if (libxmp_alloc_pattern_tracks_long(mod, i, block.lines + 1) < 0)
+		if (libxmp_alloc_pattern_tracks_long(m, i, block.lines + 1) < 0)
 			goto err_cleanup;
 
 		pos = patbuf;
@@ -507,12 +507,12 @@ int mmd_alloc_tables(struct module_data *m, int i, struct SynthInstr *synth)
 {
 	struct med_module_extras *me = (struct med_module_extras *)m->extra;
 
-	me->vol_table[i] = (uint8 *) calloc(1, synth->voltbllen);
+	me->vol_table[i] = (uint8 *) libxmp_calloc(m, 1, synth->voltbllen);
 	if (me->vol_table[i] == NULL)
 		goto err;
 	memcpy(me->vol_table[i], synth->voltbl, synth->voltbllen);
 
-	me->wav_table[i] = (uint8 *) calloc(1, synth->wftbllen);
+	me->wav_table[i] = (uint8 *) libxmp_calloc(m, 1, synth->wftbllen);
 	if (me->wav_table[i] == NULL)
 		goto err1;
 	memcpy(me->wav_table[i], synth->wftbl, synth->wftbllen);
@@ -520,7 +520,8 @@ int mmd_alloc_tables(struct module_data *m, int i, struct SynthInstr *synth)
 	return 0;
 
     err1:
-	free(me->vol_table[i]);
+	libxmp_free(m, me->vol_table[i]);
+	me->vol_table[i] = NULL;
     err:
 	return -1;
 }
@@ -581,11 +582,11 @@ static int mmd_load_hybrid_instrument(HIO_HANDLE *f, struct module_data *m, int
 		return -1;
 	}
 
-	if (libxmp_med_new_instrument_extras(xxi) != 0)
+	if (libxmp_med_new_instrument_extras(m, xxi) != 0)
 		return -1;
 
 	xxi->nsm = synth->wforms;
-	if (libxmp_alloc_subinstrument(mod, i, synth->wforms) < 0)
+	if (libxmp_alloc_subinstrument(m, i, synth->wforms) < 0)
 		return -1;
 
 	ie = MED_INSTRUMENT_EXTRAS(*xxi);
@@ -695,11 +696,11 @@ static int mmd_load_synth_instrument(HIO_HANDLE *f, struct module_data *m, int i
 			sample->strans,
 			exp_smp->finetune);
 
-	if (libxmp_med_new_instrument_extras(&mod->xxi[i]) != 0)
+	if (libxmp_med_new_instrument_extras(m, &mod->xxi[i]) != 0)
 		return -1;
 
 	xxi->nsm = synth->wforms;
-	if (libxmp_alloc_subinstrument(mod, i, synth->wforms) < 0)
+	if (libxmp_alloc_subinstrument(m, i, synth->wforms) < 0)
 		return -1;
 
 	ie = MED_INSTRUMENT_EXTRAS(*xxi);
@@ -755,13 +756,13 @@ static int mmd_load_sampled_instrument(HIO_HANDLE *f, struct module_data *m, int
 		return -1;
 
 	/* hold & decay support */
-        if (libxmp_med_new_instrument_extras(xxi) != 0)
+        if (libxmp_med_new_instrument_extras(m, xxi) != 0)
                 return -1;
 	MED_INSTRUMENT_EXTRAS(*xxi)->hold = exp_smp->hold;
 	MED_INSTRUMENT_EXTRAS(*xxi)->decay = exp_smp->decay;
 
 	xxi->nsm = 1;
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 		return -1;
 
 	mmd_load_instrument_common(&info, instr, expdata, exp_smp, sample, ver);
@@ -854,14 +855,14 @@ static int mmd_load_iffoct_instrument(HIO_HANDLE *f, struct module_data *m, int
 		return -1;
 
 	/* hold & decay support */
-	if (libxmp_med_new_instrument_extras(xxi) != 0)
+	if (libxmp_med_new_instrument_extras(m, xxi) != 0)
 		return -1;
 
 	MED_INSTRUMENT_EXTRAS(*xxi)->hold = exp_smp->hold;
 	MED_INSTRUMENT_EXTRAS(*xxi)->decay = exp_smp->decay;
 
 	xxi->nsm = num_oct;
-	if (libxmp_alloc_subinstrument(mod, i, num_oct) < 0)
+	if (libxmp_alloc_subinstrument(m, i, num_oct) < 0)
 		return -1;
 
 	/* base octave size */
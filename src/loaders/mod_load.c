@@ -631,7 +631,7 @@ static int mod_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	struct xmp_subinstrument *sub;
 	struct xmp_sample *xxs;
 
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 	    return -1;
 
 #ifndef LIBXMP_CORE_PLAYER
@@ -762,7 +762,7 @@ skip_test:
 			mod->xxs[i].len > mod->xxs[i].lpe ? '!' : ' ');
     }
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
 	return -1;
 
     /* Load and convert patterns */
@@ -780,7 +780,7 @@ skip_test:
 	uint8 *mod_event;
 	int patlen = 64 * 4 * mod->chn;
 
-	if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0) {
+	if (libxmp_alloc_pattern_tracks(m, i, 64) < 0) {
 	    free(patbuf);
 	    return -1;
 	}
@@ -142,7 +142,7 @@ static int mtm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		struct xmp_sample *xxs = &mod->xxs[i];
 		struct xmp_subinstrument *sub;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		sub = &xxi->sub[0];
@@ -188,7 +188,7 @@ static int mtm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	hio_read(mod->xxo, 1, 128, f);
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored tracks: %d", mod->trk - 1);
@@ -196,7 +196,7 @@ static int mtm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	fxx[0] = fxx[1] = 0;
 	for (i = 0; i < mod->trk; i++) {
 
-		if (libxmp_alloc_track(mod, i, mfh.rows) < 0)
+		if (libxmp_alloc_track(m, i, mfh.rows) < 0)
 			return -1;
 
 		if (i == 0)
@@ -242,7 +242,7 @@ static int mtm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	D_(D_INFO "Stored patterns: %d", mod->pat - 1);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern(mod, i) < 0)
+		if (libxmp_alloc_pattern(m, i) < 0)
 			return -1;
 
 		mod->xxp[i]->rows = 64;
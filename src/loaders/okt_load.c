@@ -191,7 +191,7 @@ static int get_samp(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 		struct xmp_sample *xxs = &mod->xxs[j];
 		struct xmp_subinstrument *sub;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		sub = &xxi->sub[0];
@@ -292,14 +292,14 @@ static int get_pbod(struct module_data *m, uint32 size, HIO_HANDLE *f, void *par
 		return 0;
 
 	if (!data->pattern) {
-		if (libxmp_init_pattern(mod) < 0)
+		if (libxmp_init_pattern(m) < 0)
 			return -1;
 		D_(D_INFO "Stored patterns: %d", mod->pat);
 	}
 
 	rows = hio_read16b(f);
 
-	if (libxmp_alloc_pattern_tracks(mod, data->pattern, rows) < 0)
+	if (libxmp_alloc_pattern_tracks(m, data->pattern, rows) < 0)
 		return -1;
 
 	for (j = 0; j < rows; j++) {
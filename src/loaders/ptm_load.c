@@ -198,7 +198,7 @@ static int ptm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 			return -1;
 		}
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0) {
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0) {
 			return -1;
 		}
 
@@ -245,7 +245,7 @@ static int ptm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		libxmp_c2spd_to_note(pih.c4spd, &sub->xpo, &sub->fin);
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	/* Read patterns */
@@ -260,7 +260,7 @@ static int ptm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		if (!pfh.patseg[i])
 			continue;
 
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		hio_seek(f, start + 16L * pfh.patseg[i], SEEK_SET);
@@ -130,7 +130,7 @@ static int pw_load(struct module_data *m, HIO_HANDLE *h, const int start)
 	}
 
 	for (i = 0; i < mod->ins; i++) {
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			goto err3;
 
 		mod->xxs[i].len = 2 * mh.ins[i].size;
@@ -156,7 +156,7 @@ static int pw_load(struct module_data *m, HIO_HANDLE *h, const int start)
 			     mod->xxi[i].sub[0].fin >> 4);
 	}
 
-	if (libxmp_init_pattern(mod) < 0) {
+	if (libxmp_init_pattern(m) < 0) {
 		goto err3;
 	}
 
@@ -164,7 +164,7 @@ static int pw_load(struct module_data *m, HIO_HANDLE *h, const int start)
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			goto err3;
 
 		for (j = 0; j < (64 * 4); j++) {
@@ -405,7 +405,7 @@ static int rtm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	for (i = 0; i < mod->chn; i++)
 		mod->xxc[i].pan = rtm_convert_pan(rh.panning[i]);
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
@@ -434,7 +434,7 @@ static int rtm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 		offset += 42 + oh.headerSize + rp.datasize;
 
-		if (libxmp_alloc_pattern_tracks_long(mod, i, rp.nrows) < 0)
+		if (libxmp_alloc_pattern_tracks_long(m, i, rp.nrows) < 0)
 			return -1;
 
 		for (r = 0; r < rp.nrows; r++) {
@@ -582,7 +582,7 @@ static int rtm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		if (xxi->nsm > 16)
 			xxi->nsm = 16;
 
-		if (libxmp_alloc_subinstrument(mod, i, xxi->nsm) < 0)
+		if (libxmp_alloc_subinstrument(m, i, xxi->nsm) < 0)
 			return -1;
 
 		for (j = 0; j < 120; j++)
@@ -475,7 +475,7 @@ static int s3m_load(struct module_data *m, HIO_HANDLE * f, const int start)
 
 	MODULE_INFO();
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		goto err3;
 
 	/* Read patterns */
@@ -483,7 +483,7 @@ static int s3m_load(struct module_data *m, HIO_HANDLE * f, const int start)
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			goto err3;
 
 		if (pp_pat[i] == 0)
@@ -556,8 +556,7 @@ static int s3m_load(struct module_data *m, HIO_HANDLE * f, const int start)
 		int load_sample_flags;
 		uint32 sample_segment;
 
-		xxi->sub = (struct xmp_subinstrument *) calloc(1, sizeof(struct xmp_subinstrument));
-		if (xxi->sub == NULL) {
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0) {
 			goto err3;
 		}
 
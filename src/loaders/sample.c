@@ -178,6 +178,34 @@ static void convert_stereo_interleaved(void * LIBXMP_RESTRICT _out,
 }
 
 
+/* Loop parameters sanity check, also used by loaders that set the sample
+ * length without loading sample data.
+ */
+void libxmp_check_sample_loop(struct xmp_sample *xxs)
+{
+	if (xxs->lps < 0) {
+		xxs->lps = 0;
+	}
+	if (xxs->lpe > xxs->len) {
+		xxs->lpe = xxs->len;
+	}
+	if (xxs->lps >= xxs->len || xxs->lps >= xxs->lpe) {
+		xxs->lps = xxs->lpe = 0;
+		xxs->flg &= ~(XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
+	}
+
+	/* Disable bidirectional loop flag if sample is not looped
+	 */
+	if (xxs->flg & XMP_SAMPLE_LOOP_BIDIR) {
+		if (~xxs->flg & XMP_SAMPLE_LOOP)
+			xxs->flg &= ~XMP_SAMPLE_LOOP_BIDIR;
+	}
+	if (xxs->flg & XMP_SAMPLE_SLOOP_BIDIR) {
+		if (~xxs->flg & XMP_SAMPLE_SLOOP)
+			xxs->flg &= ~XMP_SAMPLE_SLOOP_BIDIR;
+	}
+}
+
 int libxmp_load_sample(struct module_data *m, HIO_HANDLE *f, int flags, struct xmp_sample *xxs, const void *buffer)
 {
 	unsigned char *tmp = NULL;
@@ -281,32 +309,10 @@ int libxmp_load_sample(struct module_data *m, HIO_HANDLE *f, int flags, struct x
 		}
 	}
 
-	/* Loop parameters sanity check
-	 */
-	if (xxs->lps < 0) {
-		xxs->lps = 0;
-	}
-	if (xxs->lpe > xxs->len) {
-		xxs->lpe = xxs->len;
-	}
-	if (xxs->lps >= xxs->len || xxs->lps >= xxs->lpe) {
-		xxs->lps = xxs->lpe = 0;
-		xxs->flg &= ~(XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
-	}
-
-	/* Disable bidirectional loop flag if sample is not looped
-	 */
-	if (xxs->flg & XMP_SAMPLE_LOOP_BIDIR) {
-		if (~xxs->flg & XMP_SAMPLE_LOOP)
-			xxs->flg &= ~XMP_SAMPLE_LOOP_BIDIR;
-	}
-	if (xxs->flg & XMP_SAMPLE_SLOOP_BIDIR) {
-		if (~xxs->flg & XMP_SAMPLE_SLOOP)
-			xxs->flg &= ~XMP_SAMPLE_SLOOP_BIDIR;
-	}
+	libxmp_check_sample_loop(xxs);
 
 	/* add guard bytes before the buffer for higher order interpolation */
-	xxs->data = (unsigned char *) malloc(bytelen + extralen + 4);
+	xxs->data = (unsigned char *) libxmp_malloc(m, bytelen + extralen + 4);
 	if (xxs->data == NULL) {
 		goto err;
 	}
@@ -419,16 +425,16 @@ int libxmp_load_sample(struct module_data *m, HIO_HANDLE *f, int flags, struct x
 	return 0;
 
     err2:
-	libxmp_free_sample(xxs);
+	libxmp_free_sample(m, xxs);
 	free(tmp);
     err:
 	return -1;
 }
 
-void libxmp_free_sample(struct xmp_sample *s)
+void libxmp_free_sample(struct module_data *m, struct xmp_sample *s)
 {
 	if (s->data) {
-		free(s->data - 4);
+		libxmp_free(m, s->data - 4);
 		s->data = NULL;		/* prevent double free in PCM load error */
 	}
 }
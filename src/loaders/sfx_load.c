@@ -193,7 +193,7 @@ static int sfx_13_20_load(struct module_data *m, HIO_HANDLE *f, const int nins,
 		struct xmp_subinstrument *sub;
 		struct xmp_sample *xxs;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		xxi = &mod->xxi[i];
@@ -218,13 +218,13 @@ static int sfx_13_20_load(struct module_data *m, HIO_HANDLE *f, const int nins,
 		   sub->fin >> 4);
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		for (j = 0; j < 64; j++) {
@@ -357,7 +357,7 @@ static int st_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		struct xmp_sample *xxs = &mod->xxs[i];
 		struct xmp_subinstrument *sub;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		sub = &xxi->sub[0];
@@ -381,7 +381,7 @@ static int st_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	strncpy(mod->name, (char *)mh.name, 20);
 
-	if (libxmp_init_pattern(mod) < 0) {
+	if (libxmp_init_pattern(m) < 0) {
 		return -1;
 	}
 
@@ -392,7 +392,7 @@ static int st_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		if (hio_read(pat_buf, 1, 1024, f) < 1024)
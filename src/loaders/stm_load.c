@@ -317,7 +317,7 @@ static int stm_load(struct module_data *m, HIO_HANDLE * f, const int start)
 
 	/* Read and convert instruments and samples */
 	for (i = 0; i < mod->ins; i++) {
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		mod->xxs[i].len = sfh.ins[i].length;
@@ -370,19 +370,19 @@ static int stm_load(struct module_data *m, HIO_HANDLE * f, const int start)
 
 	D_(D_INFO "Module length: %d", mod->len);
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	/* Read and convert patterns */
 	D_(D_INFO "Stored patterns: %d", stored_patterns);
 
 	if(blank_pattern) {
-		if (libxmp_alloc_pattern_tracks(mod, stored_patterns, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, stored_patterns, 64) < 0)
 			return -1;
 	}
 
 	for (i = 0; i < stored_patterns; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			return -1;
 
 		if (hio_error(f))
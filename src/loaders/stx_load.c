@@ -236,7 +236,7 @@ static int stx_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
 	/* Read and convert instruments and samples */
 	for (i = 0; i < mod->ins; i++) {
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			goto err3;
 
 		hio_seek(f, start + (pp_ins[i] << 4), SEEK_SET);
@@ -287,14 +287,14 @@ static int stx_load(struct module_data *m, HIO_HANDLE *f, const int start)
 				      &mod->xxi[i].sub[0].fin);
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		goto err3;
 
 	/* Read and convert patterns */
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			goto err3;
 
 		if (pp_pat[i] == 0)
@@ -345,7 +345,7 @@ static int sym_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		return -1;
 
 	for (i = 0; i < mod->ins; i++) {
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			return -1;
 
 		sn[i] = hio_read8(f);	/* sample name length */
@@ -376,7 +376,7 @@ static int sym_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	MODULE_INFO();
 
 	mod->trk++;			/* alloc extra empty track */
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		return -1;
 
 	/* Determine the required size of temporary buffer and allocate it now. */
@@ -409,7 +409,7 @@ static int sym_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	}
 
 	for (i = 0; i < mod->len; i++) {	/* len == pat */
-		if (libxmp_alloc_pattern(mod, i) < 0)
+		if (libxmp_alloc_pattern(m, i) < 0)
 			goto err;
 
 		mod->xxp[i]->rows = 64;
@@ -460,7 +460,7 @@ static int sym_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	}
 
 	for (i = 0; i < mod->trk - 1; i++) {
-		if (libxmp_alloc_track(mod, i, 64) < 0)
+		if (libxmp_alloc_track(m, i, 64) < 0)
 			goto err;
 
 		for (j = 0; j < mod->xxt[i]->rows; j++) {
@@ -485,7 +485,7 @@ static int sym_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	}
 
 	/* Extra track */
-	if (libxmp_alloc_track(mod, i, 64) < 0)
+	if (libxmp_alloc_track(m, i, 64) < 0)
 		goto err;
 
 	/* Load and convert instruments */
@@ -178,7 +178,7 @@ static int ult_load(struct module_data *m, HIO_HANDLE *f, const int start)
     D_(D_INFO "Instruments: %d", mod->ins);
 
     for (i = 0; i < mod->ins; i++) {
-	if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+	if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 	    return -1;
 
 	hio_read(uih.name, 32, 1, f);
@@ -304,7 +304,7 @@ static int ult_load(struct module_data *m, HIO_HANDLE *f, const int start)
 	}
     }
 
-    if (libxmp_init_pattern(mod) < 0)
+    if (libxmp_init_pattern(m) < 0)
 	return -1;
 
     /* Read and convert patterns */
@@ -313,7 +313,7 @@ static int ult_load(struct module_data *m, HIO_HANDLE *f, const int start)
 
     /* Events are stored by channel */
     for (i = 0; i < mod->pat; i++) {
-	if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+	if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 	    return -1;
     }
 
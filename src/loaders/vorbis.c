@@ -124,6 +124,11 @@ typedef struct
 {
    char *alloc_buffer;
    int   alloc_buffer_length_in_bytes;
+   /* libxmp: if alloc_buffer is NULL, allocate with these callbacks
+    * instead of malloc()/free() when they are set */
+   void *(*alloc_func)(void *alloc_data, int size);
+   void  (*free_func)(void *alloc_data, void *ptr);
+   void *alloc_data;
 } stb_vorbis_alloc;
 
 
@@ -1012,12 +1017,18 @@ static void *setup_malloc(vorb *f, uint64 siz)
       f->setup_offset += sz;
       return p;
    }
+   if (f->alloc.alloc_func)
+      return sz ? f->alloc.alloc_func(f->alloc.alloc_data, sz) : NULL;
    return sz ? malloc(sz) : NULL;
 }
 
 static void setup_free(vorb *f, void *p)
 {
    if (f->alloc.alloc_buffer) return; // do nothing; setup mem is a stack
+   if (f->alloc.free_func) {
+      if (p) f->alloc.free_func(f->alloc.alloc_data, p);
+      return;
+   }
    free(p);
 }
 
@@ -1031,6 +1042,8 @@ static void *setup_temp_malloc(vorb *f, uint64 siz)
       f->temp_offset -= sz;
       return (char *) f->alloc.alloc_buffer + f->temp_offset;
    }
+   if (f->alloc.alloc_func)
+      return f->alloc.alloc_func(f->alloc.alloc_data, sz);
    return malloc(sz);
 }
 
@@ -1042,6 +1055,10 @@ static void setup_temp_free(vorb *f, void **_p, uint64 sz)
       f->temp_offset += (sz+7)&~7;
       return;
    }
+   if (f->alloc.free_func) {
+      if (p) f->alloc.free_func(f->alloc.alloc_data, p);
+      return;
+   }
    free(p);
 }
 
@@ -94,7 +94,7 @@ static int load_xm_pattern(struct module_data *m, int num, int version,
 		r = 0x100;
 	}
 
-	if (libxmp_alloc_pattern_tracks(mod, num, r) < 0) {
+	if (libxmp_alloc_pattern_tracks(m, num, r) < 0) {
 		goto err;
 	}
 
@@ -294,7 +294,7 @@ static int load_patterns(struct module_data *m, int version, HIO_HANDLE *f)
 	int i, j;
 
 	mod->pat++;
-	if (libxmp_init_pattern(mod) < 0) {
+	if (libxmp_init_pattern(m) < 0) {
 		return -1;
 	}
 
@@ -314,13 +314,13 @@ static int load_patterns(struct module_data *m, int version, HIO_HANDLE *f)
 	{
 		int t = i * mod->chn;
 
-		if (libxmp_alloc_pattern(mod, i) < 0) {
+		if (libxmp_alloc_pattern(m, i) < 0) {
 			goto err;
 		}
 
 		mod->xxp[i]->rows = 64;
 
-		if (libxmp_alloc_track(mod, t, 64) < 0) {
+		if (libxmp_alloc_track(m, t, 64) < 0) {
 			goto err;
 		}
 
@@ -372,38 +372,84 @@ static int is_ogg_sample(HIO_HANDLE *f, struct xmp_sample *xxs)
 	return 1;
 }
 
-static int oggdec(struct module_data *m, HIO_HANDLE *f, struct xmp_sample *xxs, int len)
+/* stb_vorbis allocates its decoder state with the context allocator */
+static void *oggdec_alloc(void *alloc_data, int size)
 {
-	int i, n, ch, rate, ret, flags = 0;
-	uint8 *data;
-	int16 *pcm16 = NULL;
+	return libxmp_malloc((struct module_data *)alloc_data, size);
+}
+
+static void oggdec_release(void *alloc_data, void *ptr)
+{
+	libxmp_free((struct module_data *)alloc_data, ptr);
+}
+
+static stb_vorbis *oggdec_open(struct module_data *m, const uint8 *data,
+			       int len)
+{
+	stb_vorbis_alloc alloc;
+	int err;
+
+	memset(&alloc, 0, sizeof(alloc));
+	alloc.alloc_func = oggdec_alloc;
+	alloc.free_func = oggdec_release;
+	alloc.alloc_data = m;
+
+	return stb_vorbis_open_memory(data, len, &err, &alloc);
+}
 
-	if ((data = (uint8 *)calloc(1, len)) == NULL)
+/* Decode a Vorbis sample, converting it to 8 bits if needed. Returns the
+ * number of frames decoded, or -1 on error. The decoded data is allocated
+ * with libxmp_malloc().
+ */
+static int oggdec_decode(struct module_data *m, const uint8 *data, int len,
+			 struct xmp_sample *xxs, int16 **out)
+{
+	stb_vorbis *v;
+	int i, n, size, offset;
+	int16 *pcm16, *b;
+
+	if ((v = oggdec_open(m, data, len)) == NULL)
 		return -1;
 
-	hio_read32b(f);
-	if (hio_error(f) != 0 || hio_read(data, 1, len - 4, f) != len - 4) {
-		free(data);
+	if (stb_vorbis_get_info(v).channels != 1) {
+		stb_vorbis_close(v);
 		return -1;
 	}
 
-	n = stb_vorbis_decode_memory(data, len, &ch, &rate, &pcm16);
-	free(data);
-
-	if (n < 0 || ch != 1) {
-		free(pcm16);
+	size = 4096;
+	if ((pcm16 = (int16 *)libxmp_malloc(m, size * sizeof(int16))) == NULL) {
+		stb_vorbis_close(v);
 		return -1;
 	}
 
+	for (offset = 0; ; offset += n) {
+		if (offset + 4096 > size) {
+			size *= 2;
+			b = (int16 *)libxmp_realloc(m, pcm16, size * sizeof(int16));
+			if (b == NULL) {
+				libxmp_free(m, pcm16);
+				stb_vorbis_close(v);
+				return -1;
+			}
+			pcm16 = b;
+		}
+		n = stb_vorbis_get_frame_short_interleaved(v, 1,
+					pcm16 + offset, size - offset);
+		if (n == 0)
+			break;
+	}
+	stb_vorbis_close(v);
+	n = offset;
+
 	if ((xxs->flg & XMP_SAMPLE_16BIT) == 0 && n > 0) {
 		uint8 *pcm = (uint8 *)pcm16;
 
 		for (i = 0; i < n; i++) {
 			pcm[i] = pcm16[i] >> 8;
 		}
-		pcm = (uint8 *)realloc(pcm16, n);
+		pcm = (uint8 *)libxmp_realloc(m, pcm16, n);
 		if (pcm == NULL) {
-			free(pcm16);
+			libxmp_free(m, pcm16);
 			return -1;
 		}
 		pcm16 = (int16 *)pcm;
@@ -412,15 +458,130 @@ static int oggdec(struct module_data *m, HIO_HANDLE *f, struct xmp_sample *xxs,
 		/* OXM stereo is a single channel non-interleaved stream. */
 		n >>= 1;
 	}
-	xxs->len = n;
 
-	flags |= SAMPLE_FLAG_NOLOAD;
+	*out = pcm16;
+	return n;
+}
+
+static int oggdec_flags(void)
+{
+	int flags = SAMPLE_FLAG_NOLOAD;
 #ifdef WORDS_BIGENDIAN
 	flags |= SAMPLE_FLAG_BIGEND;
 #endif
+	return flags;
+}
+
+/* Decode a sample deferred with XMP_SMPCTL_LAZY. The sample length was
+ * taken from the stream at load time, so pad or trim the decoded data
+ * to match it.
+ */
+static int oggdec_unpack(struct module_data *m, struct xmp_sample *xxs,
+			 const uint8 *data, int len)
+{
+	int16 *pcm16 = NULL;
+	uint8 *buf;
+	int n, size, framelen, ret;
+
+	n = oggdec_decode(m, data, len, xxs, &pcm16);
+	if (n < 0)
+		return -1;
+
+	if (n != xxs->len) {
+		framelen = 1;
+		if (xxs->flg & XMP_SAMPLE_16BIT)
+			framelen *= 2;
+		if (xxs->flg & XMP_SAMPLE_STEREO)
+			framelen *= 2;
+
+		size = xxs->len * framelen;
+		if ((buf = (uint8 *)libxmp_calloc(m, 1, size)) == NULL) {
+			libxmp_free(m, pcm16);
+			return -1;
+		}
+		/* Non-interleaved stereo keeps each channel in its own half */
+		if (xxs->flg & XMP_SAMPLE_STEREO) {
+			int half = framelen / 2;
+			int keep = MIN(n, xxs->len) * half;
+			memcpy(buf, pcm16, keep);
+			memcpy(buf + xxs->len * half, (uint8 *)pcm16 + n * half, keep);
+		} else {
+			memcpy(buf, pcm16, MIN(n, xxs->len) * framelen);
+		}
+		libxmp_free(m, pcm16);
+		pcm16 = (int16 *)buf;
+	}
+
+	ret = libxmp_load_sample(m, NULL, oggdec_flags(), xxs, pcm16);
+	libxmp_free(m, pcm16);
+
+	return ret;
+}
+
+/* Get the sample length from the last Ogg page and keep the compressed
+ * data to decode when the sample is first played.
+ */
+static int oggdec_lazy(struct module_data *m, struct xmp_sample *xxs,
+		       int smp, uint8 *data, int len)
+{
+	stb_vorbis *v;
+	stb_vorbis_info vi;
+	unsigned int n;
+
+	if ((v = oggdec_open(m, data, len)) == NULL)
+		return -1;
+
+	vi = stb_vorbis_get_info(v);
+	n = stb_vorbis_stream_length_in_samples(v);
+	stb_vorbis_close(v);
+
+	if (vi.channels != 1 || n == 0 || n > MAX_SAMPLE_SIZE)
+		return -1;
+
+	if (xxs->flg & XMP_SAMPLE_STEREO) {
+		n >>= 1;
+	}
+	xxs->len = n;
+	libxmp_check_sample_loop(xxs);
+
+	m->xtra[smp].packed = data;
+	m->xtra[smp].packed_len = len;
+	m->xtra[smp].unpack = oggdec_unpack;
+
+	return 0;
+}
+
+static int oggdec(struct module_data *m, HIO_HANDLE *f, struct xmp_sample *xxs,
+		  int smp, int len)
+{
+	int n, ret;
+	uint8 *data;
+	int16 *pcm16 = NULL;
+
+	if ((data = (uint8 *)libxmp_calloc(m, 1, len)) == NULL)
+		return -1;
+
+	hio_read32b(f);
+	if (hio_error(f) != 0 || hio_read(data, 1, len - 4, f) != len - 4) {
+		libxmp_free(m, data);
+		return -1;
+	}
+
+	if ((m->smpctl & XMP_SMPCTL_LAZY) && (~m->smpctl & XMP_SMPCTL_SKIP)) {
+		if (oggdec_lazy(m, xxs, smp, data, len) == 0)
+			return 0;
+	}
+
+	n = oggdec_decode(m, data, len, xxs, &pcm16);
+	libxmp_free(m, data);
+
+	if (n < 0)
+		return -1;
+
+	xxs->len = n;
 
-	ret = libxmp_load_sample(m, NULL, flags, xxs, pcm16);
-	free(pcm16);
+	ret = libxmp_load_sample(m, NULL, oggdec_flags(), xxs, pcm16);
+	libxmp_free(m, pcm16);
 
 	return ret;
 }
@@ -521,7 +682,7 @@ static int load_instruments(struct module_data *m, int version,
 			continue;
 		}
 
-		if (libxmp_alloc_subinstrument(mod, i, xxi->nsm) < 0) {
+		if (libxmp_alloc_subinstrument(m, i, xxi->nsm) < 0) {
 			return -1;
 		}
 
@@ -711,7 +872,7 @@ static int load_instruments(struct module_data *m, int version,
 
 #ifndef LIBXMP_CORE_PLAYER
 				if (is_ogg_sample(f, xxs)) {
-					if (oggdec(m, f, xxs, xsh[j].length) < 0) {
+					if (oggdec(m, f, xxs, sub->sid, xsh[j].length) < 0) {
 						return -1;
 					}
 
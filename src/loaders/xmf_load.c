@@ -307,7 +307,7 @@ static int xmf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		struct xmp_sample *xxs = &(mod->xxs[i]);
 		struct xmp_subinstrument *sub;
 
-		if (libxmp_alloc_subinstrument(mod, i, 1) < 0)
+		if (libxmp_alloc_subinstrument(m, i, 1) < 0)
 			goto err;
 
 		sub = &(xxi->sub[0]);
@@ -382,14 +382,14 @@ static int xmf_load(struct module_data *m, HIO_HANDLE *f, const int start)
 		buf = pos;
 	}
 
-	if (libxmp_init_pattern(mod) < 0)
+	if (libxmp_init_pattern(m) < 0)
 		goto err;
 
 	/* Patterns */
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-		if (libxmp_alloc_pattern_tracks(mod, i, 64) < 0)
+		if (libxmp_alloc_pattern_tracks(m, i, 64) < 0)
 			goto err;
 
 		if (hio_read(buf, 1, pat_sz, f) < pat_sz)
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
 
 /* Lifted from Schism Tracker, array interleaving changed */
@@ -259,6 +260,57 @@ void windowed_fir_init(void)
 }
 
 
+/* pitch tables doc,
+ *
+ *  pitches are handled in units of 1/100 finetune step, with 128 finetune
+ *  steps per semitone and 12 semitones per octave. the factor 2^(-x/153600)
+ *  for a pitch x is split in octave (applied with ldexp), semitone,
+ *  finetune and fractional finetune factors:
+ *
+ *    x = 153600 * oct + 12800 * semi + 100 * fine + frac
+ *    2^(-x/153600) = 2^-oct * semitone[semi] * finetune[fine] * frac[frac]
+ *
+ *  log2 of a value is found from its exponent, a table with the log2 of
+ *  the first LOG2_LUTBITS bits of the mantissa and a series expansion of
+ *  the remainder. the log2 table is scaled to pitch units.
+ */
+
+#define PITCH_OCTAVE        153600
+
+// log2(number) of precalculated logarithms
+#define LOG2_LUTBITS        8
+#define LOG2_LUTLEN         (1L << LOG2_LUTBITS)
+
+double pitch_semitone_lut[12];
+double pitch_finetune_lut[128];
+double pitch_frac_lut[100];
+double pitch_log2_lut[LOG2_LUTLEN];
+double pitch_recip_lut[LOG2_LUTLEN];
+
+void pitch_init(void)
+{
+    int i;
+
+    for (i = 0; i < 12; i++) {
+        pitch_semitone_lut[i] = pow(2.0, -i / 12.0);
+    }
+
+    for (i = 0; i < 128; i++) {
+        pitch_finetune_lut[i] = pow(2.0, -i / 1536.0);
+    }
+
+    for (i = 0; i < 100; i++) {
+        pitch_frac_lut[i] = pow(2.0, -i / (double) PITCH_OCTAVE);
+    }
+
+    for (i = 0; i < LOG2_LUTLEN; i++) {
+        double x = 1.0 + (double) i / LOG2_LUTLEN;
+        pitch_log2_lut[i] = PITCH_OCTAVE * log(x) / log(2.0);
+        pitch_recip_lut[i] = 1.0 / x;
+    }
+}
+
+
 #define LOOP(x, y) \
     printf("static const signed short %s[%lu] = {\n", #x, y); \
     \
@@ -285,10 +337,38 @@ for(j = 0; j < 4; j++) { \
     printf("\n};\n\n"); \
 }
 
+#define LOOPD(x, y) \
+    printf("static const double %s[%lu] = {\n\t", #x, y); \
+    \
+    for (i = 0; i < y; i++) { \
+        if (i && !(i % 4)) { \
+            printf("\n\t"); \
+        } \
+        printf(" %.17g,", x[i]); \
+    } \
+    \
+    printf("\n};\n\n");
+
+/* Run without arguments to generate precomp_lut.h, or with "pitch" to
+ * generate precomp_pitch.h */
 int main(int argc, char **argv)
 {
     int i, j;
 
+    if (argc > 1 && !strcmp(argv[1], "pitch")) {
+        pitch_init();
+
+        printf("#define PITCH_OCTAVE %d\n", PITCH_OCTAVE);
+        printf("#define LOG2_LUTBITS %d\n\n", LOG2_LUTBITS);
+        LOOPD(pitch_semitone_lut, 12UL)
+        LOOPD(pitch_finetune_lut, 128UL)
+        LOOPD(pitch_frac_lut, 100UL)
+        LOOPD(pitch_log2_lut, LOG2_LUTLEN)
+        LOOPD(pitch_recip_lut, LOG2_LUTLEN)
+
+        return 0;
+    }
+
     cubic_spline_init();
     windowed_fir_init();
 
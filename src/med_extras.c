@@ -463,9 +463,9 @@ void libxmp_med_play_extras(struct context_data *ctx, struct channel_data *xc, i
 	}
 }
 
-int libxmp_med_new_instrument_extras(struct xmp_instrument *xxi)
+int libxmp_med_new_instrument_extras(struct module_data *m, struct xmp_instrument *xxi)
 {
-	xxi->extra = calloc (1, sizeof(struct med_instrument_extras));
+	xxi->extra = libxmp_calloc(m, 1, sizeof(struct med_instrument_extras));
 	if (xxi->extra == NULL)
 		return -1;
 	MED_INSTRUMENT_EXTRAS((*xxi))->magic = MED_EXTRAS_MAGIC;
@@ -473,9 +473,9 @@ int libxmp_med_new_instrument_extras(struct xmp_instrument *xxi)
 	return 0;
 }
 
-int libxmp_med_new_channel_extras(struct channel_data *xc)
+int libxmp_med_new_channel_extras(struct module_data *m, struct channel_data *xc)
 {
-	xc->extra = calloc(1, sizeof(struct med_channel_extras));
+	xc->extra = libxmp_calloc(m, 1, sizeof(struct med_channel_extras));
 	if (xc->extra == NULL)
 		return -1;
 	MED_CHANNEL_EXTRAS((*xc))->magic = MED_EXTRAS_MAGIC;
@@ -489,9 +489,9 @@ void libxmp_med_reset_channel_extras(struct channel_data *xc)
 	memset((char *)xc->extra + 4, 0, sizeof(struct med_channel_extras) - 4);
 }
 
-void libxmp_med_release_channel_extras(struct channel_data *xc)
+void libxmp_med_release_channel_extras(struct module_data *m, struct channel_data *xc)
 {
-	free(xc->extra);
+	libxmp_free(m, xc->extra);
 	xc->extra = NULL;
 }
 
@@ -500,17 +500,17 @@ int libxmp_med_new_module_extras(struct module_data *m)
 	struct med_module_extras *me;
 	struct xmp_module *mod = &m->mod;
 
-	m->extra = calloc(1, sizeof(struct med_module_extras));
+	m->extra = libxmp_calloc(m, 1, sizeof(struct med_module_extras));
 	if (m->extra == NULL)
 		return -1;
 	MED_MODULE_EXTRAS((*m))->magic = MED_EXTRAS_MAGIC;
 
 	me = (struct med_module_extras *)m->extra;
 
-	me->vol_table = (uint8 **) calloc(mod->ins, sizeof(uint8 *));
+	me->vol_table = (uint8 **) libxmp_calloc(m, mod->ins, sizeof(uint8 *));
 	if (me->vol_table == NULL)
 		return -1;
-	me->wav_table = (uint8 **) calloc(mod->ins, sizeof(uint8 *));
+	me->wav_table = (uint8 **) libxmp_calloc(m, mod->ins, sizeof(uint8 *));
 	if (me->wav_table == NULL)
 		return -1;
 
@@ -527,17 +527,17 @@ void libxmp_med_release_module_extras(struct module_data *m)
 
 	if (me->vol_table) {
 		for (i = 0; i < mod->ins; i++)
-			free(me->vol_table[i]);
-		free(me->vol_table);
+			libxmp_free(m, me->vol_table[i]);
+		libxmp_free(m, me->vol_table);
 	}
 
 	if (me->wav_table) {
 		for (i = 0; i < mod->ins; i++)
-			free(me->wav_table[i]);
-		free(me->wav_table);
+			libxmp_free(m, me->wav_table[i]);
+		libxmp_free(m, me->wav_table);
 	}
 
-	free(m->extra);
+	libxmp_free(m, m->extra);
 	m->extra = NULL;
 }
 
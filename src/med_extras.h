@@ -77,10 +77,10 @@ void libxmp_med_set_hold_decay(struct context_data *, struct channel_data *, int
 void libxmp_med_hold_retrigger(struct context_data *, struct channel_data *);
 void libxmp_med_check_hold_symbol(struct context_data *, struct channel_data *, int);
 void libxmp_med_play_extras(struct context_data *, struct channel_data *, int);
-int  libxmp_med_new_instrument_extras(struct xmp_instrument *);
-int  libxmp_med_new_channel_extras(struct channel_data *);
+int  libxmp_med_new_instrument_extras(struct module_data *, struct xmp_instrument *);
+int  libxmp_med_new_channel_extras(struct module_data *, struct channel_data *);
 void libxmp_med_reset_channel_extras(struct channel_data *);
-void libxmp_med_release_channel_extras(struct channel_data *);
+void libxmp_med_release_channel_extras(struct module_data *, struct channel_data *);
 int  libxmp_med_new_module_extras(struct module_data *);
 void libxmp_med_release_module_extras(struct module_data *);
 void libxmp_med_extras_process_fx(struct context_data *, struct channel_data *,
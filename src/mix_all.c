@@ -105,19 +105,31 @@
  * compare the WAV output of OpenMPT env-flt-max.it and filter-reset.it */
 #define FILTER_MIN (-65536 * (1 << PREAMP_BITS))
 #define FILTER_MAX (65535 * (1 << PREAMP_BITS))
-#define MIX_FILTER_CLAMP(a) \
- ((a) < FILTER_MIN ? FILTER_MIN : (a) > FILTER_MAX ? FILTER_MAX : (a))
+
+/* The filter output depends on the previous output, so the time spent per
+ * frame is the latency of this calculation. The output is rarely clamped,
+ * and a branch that is almost never taken is faster than a conditional
+ * move in the dependency chain. The previous output is added last for
+ * the same reason. */
+#define MIX_FILTER_CLAMP(a) do { \
+    if ((uint64)((a) - FILTER_MIN) > (uint64)FILTER_MAX - FILTER_MIN) \
+        (a) = (a) < 0 ? FILTER_MIN : FILTER_MAX; \
+} while (0)
 
 #define FILTER_LEFT(smp_in_l) do { \
-    sl64 = (a0 * XMP_ASL((smp_in_l), PREAMP_BITS) + b0 * fl1 + b1 * fl2) >> FILTER_SHIFT; \
-    sl = MIX_FILTER_CLAMP(sl64); \
+    sl64 = a0 * XMP_ASL((smp_in_l), PREAMP_BITS) + b1 * fl2; \
+    sl64 = (sl64 + b0 * fl1) >> FILTER_SHIFT; \
+    MIX_FILTER_CLAMP(sl64); \
+    sl = (int)sl64; \
     fl2 = fl1; fl1 = sl; \
     (smp_in_l) = sl >> PREAMP_BITS; \
 } while (0)
 
 #define FILTER_RIGHT(smp_in_r) do { \
-    sr64 = (a0 * XMP_ASL((smp_in_r), PREAMP_BITS) + b0 * fr1 + b1 * fr2) >> FILTER_SHIFT; \
-    sr = MIX_FILTER_CLAMP(sr64); \
+    sr64 = a0 * XMP_ASL((smp_in_r), PREAMP_BITS) + b1 * fr2; \
+    sr64 = (sr64 + b0 * fr1) >> FILTER_SHIFT; \
+    MIX_FILTER_CLAMP(sr64); \
+    sr = (int)sr64; \
     fr2 = fr1; fr1 = sr; \
     (smp_in_r) = sr >> PREAMP_BITS; \
 } while (0)
@@ -823,3 +835,1134 @@ const MIXER_FP libxmp_spline_mixers[] = {
 	LIST_MIX_FUNCTIONS(spline_filter)
 #endif
 };
+
+
+#ifdef LIBXMP_MIX_SIMD
+
+/*
+ * Vectorized mixers
+ *
+ * These produce exactly the same output as the scalar mixers above. The
+ * sample position is still advanced one frame at a time with UPDATE_POS(),
+ * but interpolation and volume scaling are done for four output frames at
+ * once. The volume ramp and the frames left over at the end of a block are
+ * handled by the scalar code.
+ */
+
+#define SIMD_FRAMES 4
+
+#ifdef LIBXMP_MIX_SSE2
+
+#include <emmintrin.h>
+
+typedef __m128i mix_vec;
+
+#define SIMD_SET(a,b,c,d)	_mm_setr_epi32((a), (b), (c), (d))
+#define SIMD_DUP(a)		_mm_set1_epi32(a)
+#define SIMD_ADD(a,b)		_mm_add_epi32((a), (b))
+#define SIMD_SUB(a,b)		_mm_sub_epi32((a), (b))
+#define SIMD_MUL(a,b)		simd_mullo((a), (b))
+#define SIMD_SRA(a,n)		_mm_srai_epi32((a), (n))
+#define SIMD_SLL(a,n)		_mm_slli_epi32((a), (n))
+#define SIMD_LOAD(p)		_mm_loadu_si128((const __m128i *)(p))
+#define SIMD_STORE(p,a)		_mm_storeu_si128((__m128i *)(p), (a))
+
+/* [a0 b0 a1 b1] [a2 b2 a3 b3] from [a0 a1 a2 a3] [b0 b1 b2 b3] */
+#define SIMD_ZIP(a, b, lo, hi) do { \
+    (lo) = _mm_unpacklo_epi32((a), (b)); \
+    (hi) = _mm_unpackhi_epi32((a), (b)); \
+} while (0)
+
+/* [a0 a1 a2 a3] [b0 b1 b2 b3] from [a0 b0 a1 b1] [a2 b2 a3 b3] */
+#define SIMD_UNZIP(lo, hi, a, b) do { \
+    (a) = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), \
+        _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0))); \
+    (b) = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), \
+        _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1))); \
+} while (0)
+
+/* SSE2 has no 32-bit low multiply, so build one from two 32x32->64 */
+static inline __m128i simd_mullo(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+				  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/* [a0+a1 b0+b1 c0+c1 d0+d1] from [a0 a1 b0 b1] [c0 c1 d0 d1] */
+static inline __m128i simd_hadd(__m128i x, __m128i y)
+{
+	__m128i a, b;
+	SIMD_UNZIP(x, y, a, b);
+	return _mm_add_epi32(a, b);
+}
+
+static inline __m128i simd_load32(const void *p)
+{
+	int32 v;
+	memcpy(&v, p, sizeof(v));
+	return _mm_cvtsi32_si128(v);
+}
+
+#define SPLINE_COEFS(f) \
+    cubic_spline_lut0[f], cubic_spline_lut1[f], \
+    cubic_spline_lut2[f], cubic_spline_lut3[f]
+
+/* Spline taps of two frames as 8 int16 */
+static inline __m128i simd_spline_taps_8bit(const int8 *s0, const int8 *s1)
+{
+	__m128i v = _mm_unpacklo_epi32(simd_load32(s0), simd_load32(s1));
+	return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+}
+
+static inline __m128i simd_spline_taps_16bit(const int16 *s0, const int16 *s1)
+{
+	return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)s0),
+				  _mm_loadl_epi64((const __m128i *)s1));
+}
+
+/* Deinterleave [l-1 r-1 l0 r0 l1 r1 l2 r2] to [l-1 l0 l1 l2 r-1 r0 r1 r2] */
+static inline __m128i simd_spline_split(__m128i v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+static inline __m128i simd_spline_stereo_taps_8bit(const int8 *s)
+{
+	__m128i v = _mm_loadl_epi64((const __m128i *)s);
+	return simd_spline_split(_mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8));
+}
+
+static inline __m128i simd_spline_stereo_taps_16bit(const int16 *s)
+{
+	return simd_spline_split(_mm_loadu_si128((const __m128i *)s));
+}
+
+/* Spline interpolation of four mono frames. The coefficients and taps
+ * are paired so that each multiply-add covers half of a frame. */
+static inline __m128i simd_spline_mono(__m128i t01, __m128i t23,
+				       const int *f, int shift)
+{
+	__m128i c01 = _mm_setr_epi16(SPLINE_COEFS(f[0] >> 6), SPLINE_COEFS(f[1] >> 6));
+	__m128i c23 = _mm_setr_epi16(SPLINE_COEFS(f[2] >> 6), SPLINE_COEFS(f[3] >> 6));
+
+	return _mm_sra_epi32(simd_hadd(_mm_madd_epi16(t01, c01),
+				       _mm_madd_epi16(t23, c23)),
+			     _mm_cvtsi32_si128(shift));
+}
+
+/* Spline interpolation of two stereo frames, interleaved */
+static inline __m128i simd_spline_stereo(__m128i t0, __m128i t1,
+					 int f0, int f1, int shift)
+{
+	__m128i c0 = _mm_setr_epi16(SPLINE_COEFS(f0 >> 6), SPLINE_COEFS(f0 >> 6));
+	__m128i c1 = _mm_setr_epi16(SPLINE_COEFS(f1 >> 6), SPLINE_COEFS(f1 >> 6));
+
+	return _mm_sra_epi32(simd_hadd(_mm_madd_epi16(t0, c0),
+				       _mm_madd_epi16(t1, c1)),
+			     _mm_cvtsi32_si128(shift));
+}
+
+#define SIMD_SPLINE_8BIT(smp) do { \
+    (smp) = simd_spline_mono( \
+        simd_spline_taps_8bit(sptr + vpos[0] - 1, sptr + vpos[1] - 1), \
+        simd_spline_taps_8bit(sptr + vpos[2] - 1, sptr + vpos[3] - 1), \
+        vfrac, SPLINE_SHIFT - 8); \
+} while (0)
+
+#define SIMD_SPLINE_16BIT(smp) do { \
+    (smp) = simd_spline_mono( \
+        simd_spline_taps_16bit(sptr + vpos[0] - 1, sptr + vpos[1] - 1), \
+        simd_spline_taps_16bit(sptr + vpos[2] - 1, sptr + vpos[3] - 1), \
+        vfrac, SPLINE_SHIFT); \
+} while (0)
+
+#define SIMD_SPLINE_STEREO_8BIT(lo, hi) do { \
+    (lo) = simd_spline_stereo(simd_spline_stereo_taps_8bit(sptr + vpos[0] - 2), \
+        simd_spline_stereo_taps_8bit(sptr + vpos[1] - 2), \
+        vfrac[0], vfrac[1], SPLINE_SHIFT - 8); \
+    (hi) = simd_spline_stereo(simd_spline_stereo_taps_8bit(sptr + vpos[2] - 2), \
+        simd_spline_stereo_taps_8bit(sptr + vpos[3] - 2), \
+        vfrac[2], vfrac[3], SPLINE_SHIFT - 8); \
+} while (0)
+
+#define SIMD_SPLINE_STEREO_16BIT(lo, hi) do { \
+    (lo) = simd_spline_stereo(simd_spline_stereo_taps_16bit(sptr + vpos[0] - 2), \
+        simd_spline_stereo_taps_16bit(sptr + vpos[1] - 2), \
+        vfrac[0], vfrac[1], SPLINE_SHIFT); \
+    (hi) = simd_spline_stereo(simd_spline_stereo_taps_16bit(sptr + vpos[2] - 2), \
+        simd_spline_stereo_taps_16bit(sptr + vpos[3] - 2), \
+        vfrac[2], vfrac[3], SPLINE_SHIFT); \
+} while (0)
+
+#endif /* LIBXMP_MIX_SSE2 */
+
+#ifdef LIBXMP_MIX_NEON
+
+#include <arm_neon.h>
+
+typedef int32x4_t mix_vec;
+
+#define SIMD_SET(a,b,c,d)	simd_set((a), (b), (c), (d))
+#define SIMD_DUP(a)		vdupq_n_s32(a)
+#define SIMD_ADD(a,b)		vaddq_s32((a), (b))
+#define SIMD_SUB(a,b)		vsubq_s32((a), (b))
+#define SIMD_MUL(a,b)		vmulq_s32((a), (b))
+#define SIMD_SRA(a,n)		vshlq_s32((a), vdupq_n_s32(-(n)))
+#define SIMD_SLL(a,n)		vshlq_s32((a), vdupq_n_s32(n))
+#define SIMD_LOAD(p)		vld1q_s32(p)
+#define SIMD_STORE(p,a)		vst1q_s32((p), (a))
+
+#define SIMD_ZIP(a, b, lo, hi) do { \
+    int32x4x2_t z_ = vzipq_s32((a), (b)); \
+    (lo) = z_.val[0]; \
+    (hi) = z_.val[1]; \
+} while (0)
+
+#define SIMD_UNZIP(lo, hi, a, b) do { \
+    int32x4x2_t z_ = vuzpq_s32((lo), (hi)); \
+    (a) = z_.val[0]; \
+    (b) = z_.val[1]; \
+} while (0)
+
+static inline int32x4_t simd_set(int a, int b, int c, int d)
+{
+	int32 v[4];
+	v[0] = a;
+	v[1] = b;
+	v[2] = c;
+	v[3] = d;
+	return vld1q_s32(v);
+}
+
+static inline int16x4_t simd_spline_coefs(int f)
+{
+	int16 c[4];
+	f >>= 6;
+	c[0] = cubic_spline_lut0[f];
+	c[1] = cubic_spline_lut1[f];
+	c[2] = cubic_spline_lut2[f];
+	c[3] = cubic_spline_lut3[f];
+	return vld1_s16(c);
+}
+
+static inline int16x4_t simd_spline_taps_8bit(const int8 *s, int chn)
+{
+	int16 t[4];
+	t[0] = s[-chn];
+	t[1] = s[0];
+	t[2] = s[chn];
+	t[3] = s[chn * 2];
+	return vld1_s16(t);
+}
+
+/* Sum of each vector's lanes: [a0+a1+a2+a3 b.. c.. d..] */
+static inline int32x4_t simd_sum4(int32x4_t a, int32x4_t b,
+				  int32x4_t c, int32x4_t d)
+{
+	return vpaddq_s32(vpaddq_s32(a, b), vpaddq_s32(c, d));
+}
+
+#define SIMD_SPLINE_MONO(smp, taps, shift) do { \
+    (smp) = SIMD_SRA(simd_sum4( \
+        vmull_s16(taps(0), simd_spline_coefs(vfrac[0])), \
+        vmull_s16(taps(1), simd_spline_coefs(vfrac[1])), \
+        vmull_s16(taps(2), simd_spline_coefs(vfrac[2])), \
+        vmull_s16(taps(3), simd_spline_coefs(vfrac[3]))), (shift)); \
+} while (0)
+
+#define TAPS_MONO_8BIT(i)	simd_spline_taps_8bit(sptr + vpos[i], 1)
+#define TAPS_MONO_16BIT(i)	vld1_s16(sptr + vpos[i] - 1)
+#define TAPS_LEFT_8BIT(i)	simd_spline_taps_8bit(sptr + vpos[i], 2)
+#define TAPS_RIGHT_8BIT(i)	simd_spline_taps_8bit(sptr + vpos[i] + 1, 2)
+
+#define SIMD_SPLINE_8BIT(smp) \
+    SIMD_SPLINE_MONO(smp, TAPS_MONO_8BIT, SPLINE_SHIFT - 8)
+
+#define SIMD_SPLINE_16BIT(smp) \
+    SIMD_SPLINE_MONO(smp, TAPS_MONO_16BIT, SPLINE_SHIFT)
+
+#define SIMD_SPLINE_STEREO_8BIT(lo, hi) do { \
+    int16x4_t c0_ = simd_spline_coefs(vfrac[0]), c1_ = simd_spline_coefs(vfrac[1]); \
+    int16x4_t c2_ = simd_spline_coefs(vfrac[2]), c3_ = simd_spline_coefs(vfrac[3]); \
+    (lo) = SIMD_SRA(simd_sum4( \
+        vmull_s16(TAPS_LEFT_8BIT(0), c0_), vmull_s16(TAPS_RIGHT_8BIT(0), c0_), \
+        vmull_s16(TAPS_LEFT_8BIT(1), c1_), vmull_s16(TAPS_RIGHT_8BIT(1), c1_)), \
+        SPLINE_SHIFT - 8); \
+    (hi) = SIMD_SRA(simd_sum4( \
+        vmull_s16(TAPS_LEFT_8BIT(2), c2_), vmull_s16(TAPS_RIGHT_8BIT(2), c2_), \
+        vmull_s16(TAPS_LEFT_8BIT(3), c3_), vmull_s16(TAPS_RIGHT_8BIT(3), c3_)), \
+        SPLINE_SHIFT - 8); \
+} while (0)
+
+#define SIMD_SPLINE_STEREO_16BIT(lo, hi) do { \
+    int16x4x2_t t0_ = vld2_s16(sptr + vpos[0] - 2), t1_ = vld2_s16(sptr + vpos[1] - 2); \
+    int16x4x2_t t2_ = vld2_s16(sptr + vpos[2] - 2), t3_ = vld2_s16(sptr + vpos[3] - 2); \
+    int16x4_t c0_ = simd_spline_coefs(vfrac[0]), c1_ = simd_spline_coefs(vfrac[1]); \
+    int16x4_t c2_ = simd_spline_coefs(vfrac[2]), c3_ = simd_spline_coefs(vfrac[3]); \
+    (lo) = SIMD_SRA(simd_sum4( \
+        vmull_s16(t0_.val[0], c0_), vmull_s16(t0_.val[1], c0_), \
+        vmull_s16(t1_.val[0], c1_), vmull_s16(t1_.val[1], c1_)), SPLINE_SHIFT); \
+    (hi) = SIMD_SRA(simd_sum4( \
+        vmull_s16(t2_.val[0], c2_), vmull_s16(t2_.val[1], c2_), \
+        vmull_s16(t3_.val[0], c3_), vmull_s16(t3_.val[1], c3_)), SPLINE_SHIFT); \
+} while (0)
+
+#endif /* LIBXMP_MIX_NEON */
+
+/* Nearest neighbor and linear interpolation only need the generic
+ * vector operations, with the sample data gathered by frame. */
+
+#define GATHER(o0, o1, o2, o3) \
+    SIMD_SET(sptr[o0], sptr[o1], sptr[o2], sptr[o3])
+
+#define GATHER_FRAC(i0, i1, i2, i3) \
+    SIMD_SET(vfrac[i0] >> 1, vfrac[i1] >> 1, vfrac[i2] >> 1, vfrac[i3] >> 1)
+
+#define SIMD_NEAREST_8BIT(smp) do { \
+    (smp) = SIMD_SLL(GATHER(vpos[0], vpos[1], vpos[2], vpos[3]), 8); \
+} while (0)
+
+#define SIMD_NEAREST_16BIT(smp) do { \
+    (smp) = GATHER(vpos[0], vpos[1], vpos[2], vpos[3]); \
+} while (0)
+
+#define SIMD_NEAREST_STEREO_8BIT(lo, hi) do { \
+    (lo) = SIMD_SLL(GATHER(vpos[0], vpos[0] + 1, vpos[1], vpos[1] + 1), 8); \
+    (hi) = SIMD_SLL(GATHER(vpos[2], vpos[2] + 1, vpos[3], vpos[3] + 1), 8); \
+} while (0)
+
+#define SIMD_NEAREST_STEREO_16BIT(lo, hi) do { \
+    (lo) = GATHER(vpos[0], vpos[0] + 1, vpos[1], vpos[1] + 1); \
+    (hi) = GATHER(vpos[2], vpos[2] + 1, vpos[3], vpos[3] + 1); \
+} while (0)
+
+#define SIMD_LINEAR(smp, bits, o0, o1, o2, o3, frac) do { \
+    mix_vec l1_ = SIMD_SLL(GATHER(o0, o1, o2, o3), 16 - (bits)); \
+    mix_vec dt_ = SIMD_SUB(SIMD_SLL(GATHER((o0) + chn, (o1) + chn, \
+                  (o2) + chn, (o3) + chn), 16 - (bits)), l1_); \
+    (smp) = SIMD_ADD(l1_, SIMD_SRA(SIMD_MUL((frac), dt_), SMIX_SHIFT - 1)); \
+} while (0)
+
+#define SIMD_LINEAR_8BIT(smp) \
+    SIMD_LINEAR(smp, 8, vpos[0], vpos[1], vpos[2], vpos[3], GATHER_FRAC(0, 1, 2, 3))
+
+#define SIMD_LINEAR_16BIT(smp) \
+    SIMD_LINEAR(smp, 16, vpos[0], vpos[1], vpos[2], vpos[3], GATHER_FRAC(0, 1, 2, 3))
+
+#define SIMD_LINEAR_STEREO(lo, hi, bits) do { \
+    SIMD_LINEAR(lo, bits, vpos[0], vpos[0] + 1, vpos[1], vpos[1] + 1, \
+                GATHER_FRAC(0, 0, 1, 1)); \
+    SIMD_LINEAR(hi, bits, vpos[2], vpos[2] + 1, vpos[3], vpos[3] + 1, \
+                GATHER_FRAC(2, 2, 3, 3)); \
+} while (0)
+
+#define SIMD_LINEAR_STEREO_8BIT(lo, hi)  SIMD_LINEAR_STEREO(lo, hi, 8)
+#define SIMD_LINEAR_STEREO_16BIT(lo, hi) SIMD_LINEAR_STEREO(lo, hi, 16)
+
+#define VAR_SIMD_NEAREST \
+    int vpos[SIMD_FRAMES]; \
+    mix_vec smp_v
+
+#define VAR_SIMD \
+    VAR_SIMD_NEAREST; \
+    int vfrac[SIMD_FRAMES]
+
+#define VAR_SIMD_STEREO \
+    mix_vec smp_hi
+
+#define VAR_SIMD_MONOOUT \
+    const mix_vec vol_l = SIMD_DUP(vl)
+
+#define VAR_SIMD_STEREOOUT \
+    VAR_SIMD_MONOOUT; \
+    const mix_vec vol_r = SIMD_DUP(vr)
+
+#define VAR_SIMD_STEREOOUT_LR \
+    const mix_vec vol_lr = SIMD_SET(vl, vr, vl, vr)
+
+#define LOOP_SIMD for (; count >= SIMD_FRAMES; count -= SIMD_FRAMES)
+
+/* Store the positions of the next four frames */
+#define SIMD_UPDATE_POS_NEAREST() do { \
+    vpos[0] = pos; UPDATE_POS(); \
+    vpos[1] = pos; UPDATE_POS(); \
+    vpos[2] = pos; UPDATE_POS(); \
+    vpos[3] = pos; UPDATE_POS(); \
+} while (0)
+
+#define SIMD_UPDATE_POS() do { \
+    vpos[0] = pos; vfrac[0] = frac; UPDATE_POS(); \
+    vpos[1] = pos; vfrac[1] = frac; UPDATE_POS(); \
+    vpos[2] = pos; vfrac[2] = frac; UPDATE_POS(); \
+    vpos[3] = pos; vfrac[3] = frac; UPDATE_POS(); \
+} while (0)
+
+#define SIMD_MIX_OUT(out_samples, out_level) do { \
+    SIMD_STORE(buffer, SIMD_ADD(SIMD_LOAD(buffer), \
+               SIMD_MUL((out_samples), (out_level)))); \
+    buffer += SIMD_FRAMES; \
+} while (0)
+
+#define SIMD_MIX_MONO(smp) do { \
+    SIMD_MIX_OUT((smp), vol_l); \
+} while (0)
+
+#define SIMD_MIX_MONO_AVG(lo, hi) do { \
+    mix_vec l_, r_; \
+    SIMD_UNZIP((lo), (hi), l_, r_); \
+    SIMD_MIX_MONO(SIMD_SRA(SIMD_ADD(l_, r_), 1)); \
+} while (0)
+
+/* Mono sample to stereo output */
+#define SIMD_MIX_STEREO(smp) do { \
+    mix_vec l_ = SIMD_MUL((smp), vol_l), r_ = SIMD_MUL((smp), vol_r); \
+    mix_vec lo_, hi_; \
+    SIMD_ZIP(l_, r_, lo_, hi_); \
+    SIMD_STORE(buffer, SIMD_ADD(SIMD_LOAD(buffer), lo_)); \
+    SIMD_STORE(buffer + 4, SIMD_ADD(SIMD_LOAD(buffer + 4), hi_)); \
+    buffer += SIMD_FRAMES * 2; \
+} while (0)
+
+/* Interleaved stereo sample to stereo output */
+#define SIMD_MIX_STEREO_LR(lo, hi) do { \
+    SIMD_MIX_OUT((lo), vol_lr); \
+    SIMD_MIX_OUT((hi), vol_lr); \
+} while (0)
+
+#ifndef LIBXMP_CORE_DISABLE_IT
+
+/* The resonant filter is recursive and can't be vectorized. Blocks of
+ * frames are interpolated into a temporary buffer with the vector code,
+ * filtered in a separate loop, and then mixed with the vector code. */
+#define FILTER_BLOCK 64
+
+#define VAR_SIMD_FILTER \
+    int32 fbuf[FILTER_BLOCK * 2]; \
+    int fn, fi
+
+#define LOOP_SIMD_FILTER for (; count >= SIMD_FRAMES; count -= fn)
+
+#define SIMD_FILTER_MONO(interp, mix) do { \
+    fn = (count < FILTER_BLOCK ? count : FILTER_BLOCK) & ~(SIMD_FRAMES - 1); \
+    for (fi = 0; fi < fn; fi += SIMD_FRAMES) { \
+        SIMD_UPDATE_POS(); interp(smp_v); SIMD_STORE(fbuf + fi, smp_v); \
+    } \
+    for (fi = 0; fi < fn; fi++) { \
+        FILTER_MONO(fbuf[fi]); \
+    } \
+    for (fi = 0; fi < fn; fi += SIMD_FRAMES) { \
+        smp_v = SIMD_LOAD(fbuf + fi); mix(smp_v); \
+    } \
+} while (0)
+
+#define SIMD_FILTER_STEREO(interp, mix) do { \
+    fn = (count < FILTER_BLOCK ? count : FILTER_BLOCK) & ~(SIMD_FRAMES - 1); \
+    for (fi = 0; fi < fn * 2; fi += SIMD_FRAMES * 2) { \
+        SIMD_UPDATE_POS(); interp(smp_v, smp_hi); \
+        SIMD_STORE(fbuf + fi, smp_v); SIMD_STORE(fbuf + fi + 4, smp_hi); \
+    } \
+    for (fi = 0; fi < fn * 2; fi += 2) { \
+        FILTER_STEREO(fbuf[fi], fbuf[fi + 1]); \
+    } \
+    for (fi = 0; fi < fn * 2; fi += SIMD_FRAMES * 2) { \
+        smp_v = SIMD_LOAD(fbuf + fi); smp_hi = SIMD_LOAD(fbuf + fi + 4); \
+        mix(smp_v, smp_hi); \
+    } \
+} while (0)
+
+#endif
+
+
+/*
+ * Vectorized nearest neighbor mixers
+ */
+
+MIXER(monoout_mono_8bit_nearest_simd)
+{
+    VAR_MONO(int8);
+    VAR_SIMD_NEAREST;
+    VAR_SIMD_MONOOUT;
+    NEAREST_ROUND();
+
+    LOOP_SIMD { SIMD_UPDATE_POS_NEAREST(); SIMD_NEAREST_8BIT(smp_v); SIMD_MIX_MONO(smp_v); }
+    LOOP { NEAREST_8BIT(smpl, 0); MIX_MONO(smpl); UPDATE_POS(); }
+}
+
+MIXER(monoout_mono_16bit_nearest_simd)
+{
+    VAR_MONO(int16);
+    VAR_SIMD_NEAREST;
+    VAR_SIMD_MONOOUT;
+    NEAREST_ROUND();
+
+    LOOP_SIMD { SIMD_UPDATE_POS_NEAREST(); SIMD_NEAREST_16BIT(smp_v); SIMD_MIX_MONO(smp_v); }
+    LOOP { NEAREST_16BIT(smpl, 0); MIX_MONO(smpl); UPDATE_POS(); }
+}
+
+MIXER(monoout_stereo_8bit_nearest_simd)
+{
+    VAR_STEREO(int8);
+    VAR_SIMD_NEAREST;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+    NEAREST_ROUND();
+
+    LOOP_SIMD { SIMD_UPDATE_POS_NEAREST(); SIMD_NEAREST_STEREO_8BIT(smp_v, smp_hi);
+                SIMD_MIX_MONO_AVG(smp_v, smp_hi); }
+    LOOP { NEAREST_8BIT(smpl, 0); NEAREST_8BIT(smpr, 1);
+           MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(monoout_stereo_16bit_nearest_simd)
+{
+    VAR_STEREO(int16);
+    VAR_SIMD_NEAREST;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+    NEAREST_ROUND();
+
+    LOOP_SIMD { SIMD_UPDATE_POS_NEAREST(); SIMD_NEAREST_STEREO_16BIT(smp_v, smp_hi);
+                SIMD_MIX_MONO_AVG(smp_v, smp_hi); }
+    LOOP { NEAREST_16BIT(smpl, 0); NEAREST_16BIT(smpr, 1);
+           MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(stereoout_mono_8bit_nearest_simd)
+{
+    VAR_MONO(int8);
+    VAR_SIMD_NEAREST;
+    VAR_SIMD_STEREOOUT;
+    NEAREST_ROUND();
+
+    LOOP_SIMD { SIMD_UPDATE_POS_NEAREST(); SIMD_NEAREST_8BIT(smp_v); SIMD_MIX_STEREO(smp_v); }
+    LOOP { NEAREST_8BIT(smpl, 0); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+}
+
+MIXER(stereoout_mono_16bit_nearest_simd)
+{
+    VAR_MONO(int16);
+    VAR_SIMD_NEAREST;
+    VAR_SIMD_STEREOOUT;
+    NEAREST_ROUND();
+
+    LOOP_SIMD { SIMD_UPDATE_POS_NEAREST(); SIMD_NEAREST_16BIT(smp_v); SIMD_MIX_STEREO(smp_v); }
+    LOOP { NEAREST_16BIT(smpl, 0); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+}
+
+MIXER(stereoout_stereo_8bit_nearest_simd)
+{
+    VAR_STEREO(int8);
+    VAR_SIMD_NEAREST;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+    NEAREST_ROUND();
+
+    LOOP_SIMD { SIMD_UPDATE_POS_NEAREST(); SIMD_NEAREST_STEREO_8BIT(smp_v, smp_hi);
+                SIMD_MIX_STEREO_LR(smp_v, smp_hi); }
+    LOOP { NEAREST_8BIT(smpl, 0); NEAREST_8BIT(smpr, 1);
+           MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(stereoout_stereo_16bit_nearest_simd)
+{
+    VAR_STEREO(int16);
+    VAR_SIMD_NEAREST;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+    NEAREST_ROUND();
+
+    LOOP_SIMD { SIMD_UPDATE_POS_NEAREST(); SIMD_NEAREST_STEREO_16BIT(smp_v, smp_hi);
+                SIMD_MIX_STEREO_LR(smp_v, smp_hi); }
+    LOOP { NEAREST_16BIT(smpl, 0); NEAREST_16BIT(smpr, 1);
+           MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+}
+
+
+/*
+ * Vectorized linear mixers
+ */
+
+MIXER(monoout_mono_8bit_linear_simd)
+{
+    VAR_LINEAR_MONO(int8);
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { LINEAR_8BIT(smpl, 0); MIX_MONO_AC(smpl); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_LINEAR_8BIT(smp_v); SIMD_MIX_MONO(smp_v); }
+    LOOP      { LINEAR_8BIT(smpl, 0); MIX_MONO(smpl); UPDATE_POS(); }
+}
+
+MIXER(monoout_mono_16bit_linear_simd)
+{
+    VAR_LINEAR_MONO(int16);
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { LINEAR_16BIT(smpl, 0); MIX_MONO_AC(smpl); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_LINEAR_16BIT(smp_v); SIMD_MIX_MONO(smp_v); }
+    LOOP      { LINEAR_16BIT(smpl, 0); MIX_MONO(smpl); UPDATE_POS(); }
+}
+
+MIXER(monoout_stereo_8bit_linear_simd)
+{
+    VAR_LINEAR_STEREO(int8);
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { LINEAR_8BIT(smpl, 0); LINEAR_8BIT(smpr, 1);
+                MIX_MONO_AVG_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_LINEAR_STEREO_8BIT(smp_v, smp_hi);
+                SIMD_MIX_MONO_AVG(smp_v, smp_hi); }
+    LOOP      { LINEAR_8BIT(smpl, 0); LINEAR_8BIT(smpr, 1);
+                MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(monoout_stereo_16bit_linear_simd)
+{
+    VAR_LINEAR_STEREO(int16);
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { LINEAR_16BIT(smpl, 0); LINEAR_16BIT(smpr, 1);
+                MIX_MONO_AVG_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_LINEAR_STEREO_16BIT(smp_v, smp_hi);
+                SIMD_MIX_MONO_AVG(smp_v, smp_hi); }
+    LOOP      { LINEAR_16BIT(smpl, 0); LINEAR_16BIT(smpr, 1);
+                MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(stereoout_mono_8bit_linear_simd)
+{
+    VAR_LINEAR_MONO(int8);
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREOOUT;
+
+    LOOP_AC   { LINEAR_8BIT(smpl, 0); MIX_STEREO_AC(smpl, smpl); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_LINEAR_8BIT(smp_v); SIMD_MIX_STEREO(smp_v); }
+    LOOP      { LINEAR_8BIT(smpl, 0); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+}
+
+MIXER(stereoout_mono_16bit_linear_simd)
+{
+    VAR_LINEAR_MONO(int16);
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREOOUT;
+
+    LOOP_AC   { LINEAR_16BIT(smpl, 0); MIX_STEREO_AC(smpl, smpl); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_LINEAR_16BIT(smp_v); SIMD_MIX_STEREO(smp_v); }
+    LOOP      { LINEAR_16BIT(smpl, 0); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+}
+
+MIXER(stereoout_stereo_8bit_linear_simd)
+{
+    VAR_LINEAR_STEREO(int8);
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+
+    LOOP_AC   { LINEAR_8BIT(smpl, 0); LINEAR_8BIT(smpr, 1);
+                MIX_STEREO_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_LINEAR_STEREO_8BIT(smp_v, smp_hi);
+                SIMD_MIX_STEREO_LR(smp_v, smp_hi); }
+    LOOP      { LINEAR_8BIT(smpl, 0); LINEAR_8BIT(smpr, 1);
+                MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(stereoout_stereo_16bit_linear_simd)
+{
+    VAR_LINEAR_STEREO(int16);
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+
+    LOOP_AC   { LINEAR_16BIT(smpl, 0); LINEAR_16BIT(smpr, 1);
+                MIX_STEREO_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_LINEAR_STEREO_16BIT(smp_v, smp_hi);
+                SIMD_MIX_STEREO_LR(smp_v, smp_hi); }
+    LOOP      { LINEAR_16BIT(smpl, 0); LINEAR_16BIT(smpr, 1);
+                MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+}
+
+
+/*
+ * Vectorized spline mixers
+ */
+
+MIXER(monoout_mono_8bit_spline_simd)
+{
+    VAR_SPLINE_MONO(int8);
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { SPLINE_8BIT(smpl, 0); MIX_MONO_AC(smpl); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_SPLINE_8BIT(smp_v); SIMD_MIX_MONO(smp_v); }
+    LOOP      { SPLINE_8BIT(smpl, 0); MIX_MONO(smpl); UPDATE_POS(); }
+}
+
+MIXER(monoout_mono_16bit_spline_simd)
+{
+    VAR_SPLINE_MONO(int16);
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { SPLINE_16BIT(smpl, 0); MIX_MONO_AC(smpl); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_SPLINE_16BIT(smp_v); SIMD_MIX_MONO(smp_v); }
+    LOOP      { SPLINE_16BIT(smpl, 0); MIX_MONO(smpl); UPDATE_POS(); }
+}
+
+MIXER(monoout_stereo_8bit_spline_simd)
+{
+    VAR_SPLINE_STEREO(int8);
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { SPLINE_8BIT(smpl, 0); SPLINE_8BIT(smpr, 1);
+                MIX_MONO_AVG_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_SPLINE_STEREO_8BIT(smp_v, smp_hi);
+                SIMD_MIX_MONO_AVG(smp_v, smp_hi); }
+    LOOP      { SPLINE_8BIT(smpl, 0); SPLINE_8BIT(smpr, 1);
+                MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(monoout_stereo_16bit_spline_simd)
+{
+    VAR_SPLINE_STEREO(int16);
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { SPLINE_16BIT(smpl, 0); SPLINE_16BIT(smpr, 1);
+                MIX_MONO_AVG_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_SPLINE_STEREO_16BIT(smp_v, smp_hi);
+                SIMD_MIX_MONO_AVG(smp_v, smp_hi); }
+    LOOP      { SPLINE_16BIT(smpl, 0); SPLINE_16BIT(smpr, 1);
+                MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(stereoout_mono_8bit_spline_simd)
+{
+    VAR_SPLINE_MONO(int8);
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREOOUT;
+
+    LOOP_AC   { SPLINE_8BIT(smpl, 0); MIX_STEREO_AC(smpl, smpl); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_SPLINE_8BIT(smp_v); SIMD_MIX_STEREO(smp_v); }
+    LOOP      { SPLINE_8BIT(smpl, 0); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+}
+
+MIXER(stereoout_mono_16bit_spline_simd)
+{
+    VAR_SPLINE_MONO(int16);
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREOOUT;
+
+    LOOP_AC   { SPLINE_16BIT(smpl, 0); MIX_STEREO_AC(smpl, smpl); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_SPLINE_16BIT(smp_v); SIMD_MIX_STEREO(smp_v); }
+    LOOP      { SPLINE_16BIT(smpl, 0); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+}
+
+MIXER(stereoout_stereo_8bit_spline_simd)
+{
+    VAR_SPLINE_STEREO(int8);
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+
+    LOOP_AC   { SPLINE_8BIT(smpl, 0); SPLINE_8BIT(smpr, 1);
+                MIX_STEREO_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_SPLINE_STEREO_8BIT(smp_v, smp_hi);
+                SIMD_MIX_STEREO_LR(smp_v, smp_hi); }
+    LOOP      { SPLINE_8BIT(smpl, 0); SPLINE_8BIT(smpr, 1);
+                MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+}
+
+MIXER(stereoout_stereo_16bit_spline_simd)
+{
+    VAR_SPLINE_STEREO(int16);
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+
+    LOOP_AC   { SPLINE_16BIT(smpl, 0); SPLINE_16BIT(smpr, 1);
+                MIX_STEREO_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD { SIMD_UPDATE_POS(); SIMD_SPLINE_STEREO_16BIT(smp_v, smp_hi);
+                SIMD_MIX_STEREO_LR(smp_v, smp_hi); }
+    LOOP      { SPLINE_16BIT(smpl, 0); SPLINE_16BIT(smpr, 1);
+                MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+}
+
+#ifndef LIBXMP_CORE_DISABLE_IT
+
+/*
+ * Vectorized filtered linear mixers
+ */
+
+MIXER(monoout_mono_8bit_linear_filter_simd)
+{
+    VAR_LINEAR_MONO(int8);
+    VAR_FILTER_MONO;
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { LINEAR_8BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_MONO_AC(smpl); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_MONO(SIMD_LINEAR_8BIT,
+                                        SIMD_MIX_MONO); }
+    LOOP      { LINEAR_8BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_MONO(smpl); UPDATE_POS(); }
+
+    SAVE_FILTER_MONO();
+}
+
+MIXER(monoout_mono_16bit_linear_filter_simd)
+{
+    VAR_LINEAR_MONO(int16);
+    VAR_FILTER_MONO;
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { LINEAR_16BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_MONO_AC(smpl); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_MONO(SIMD_LINEAR_16BIT,
+                                        SIMD_MIX_MONO); }
+    LOOP      { LINEAR_16BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_MONO(smpl); UPDATE_POS(); }
+
+    SAVE_FILTER_MONO();
+}
+
+MIXER(monoout_stereo_8bit_linear_filter_simd)
+{
+    VAR_LINEAR_STEREO(int8);
+    VAR_FILTER_STEREO;
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { LINEAR_8BIT(smpl, 0); LINEAR_8BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_MONO_AVG_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_STEREO(SIMD_LINEAR_STEREO_8BIT,
+                                          SIMD_MIX_MONO_AVG); }
+    LOOP      { LINEAR_8BIT(smpl, 0); LINEAR_8BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+
+    SAVE_FILTER_STEREO();
+}
+
+MIXER(monoout_stereo_16bit_linear_filter_simd)
+{
+    VAR_LINEAR_STEREO(int16);
+    VAR_FILTER_STEREO;
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { LINEAR_16BIT(smpl, 0); LINEAR_16BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_MONO_AVG_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_STEREO(SIMD_LINEAR_STEREO_16BIT,
+                                          SIMD_MIX_MONO_AVG); }
+    LOOP      { LINEAR_16BIT(smpl, 0); LINEAR_16BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+
+    SAVE_FILTER_STEREO();
+}
+
+MIXER(stereoout_mono_8bit_linear_filter_simd)
+{
+    VAR_LINEAR_MONO(int8);
+    VAR_FILTER_MONO;
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREOOUT;
+
+    LOOP_AC   { LINEAR_8BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_STEREO_AC(smpl, smpl); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_MONO(SIMD_LINEAR_8BIT,
+                                        SIMD_MIX_STEREO); }
+    LOOP      { LINEAR_8BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+
+    SAVE_FILTER_MONO();
+}
+
+MIXER(stereoout_mono_16bit_linear_filter_simd)
+{
+    VAR_LINEAR_MONO(int16);
+    VAR_FILTER_MONO;
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREOOUT;
+
+    LOOP_AC   { LINEAR_16BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_STEREO_AC(smpl, smpl); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_MONO(SIMD_LINEAR_16BIT,
+                                        SIMD_MIX_STEREO); }
+    LOOP      { LINEAR_16BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+
+    SAVE_FILTER_MONO();
+}
+
+MIXER(stereoout_stereo_8bit_linear_filter_simd)
+{
+    VAR_LINEAR_STEREO(int8);
+    VAR_FILTER_STEREO;
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+
+    LOOP_AC   { LINEAR_8BIT(smpl, 0); LINEAR_8BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_STEREO_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_STEREO(SIMD_LINEAR_STEREO_8BIT,
+                                          SIMD_MIX_STEREO_LR); }
+    LOOP      { LINEAR_8BIT(smpl, 0); LINEAR_8BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+
+    SAVE_FILTER_STEREO();
+}
+
+MIXER(stereoout_stereo_16bit_linear_filter_simd)
+{
+    VAR_LINEAR_STEREO(int16);
+    VAR_FILTER_STEREO;
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+
+    LOOP_AC   { LINEAR_16BIT(smpl, 0); LINEAR_16BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_STEREO_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_STEREO(SIMD_LINEAR_STEREO_16BIT,
+                                          SIMD_MIX_STEREO_LR); }
+    LOOP      { LINEAR_16BIT(smpl, 0); LINEAR_16BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+
+    SAVE_FILTER_STEREO();
+}
+
+
+/*
+ * Vectorized filtered spline mixers
+ */
+
+MIXER(monoout_mono_8bit_spline_filter_simd)
+{
+    VAR_SPLINE_MONO(int8);
+    VAR_FILTER_MONO;
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { SPLINE_8BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_MONO_AC(smpl); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_MONO(SIMD_SPLINE_8BIT,
+                                        SIMD_MIX_MONO); }
+    LOOP      { SPLINE_8BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_MONO(smpl); UPDATE_POS(); }
+
+    SAVE_FILTER_MONO();
+}
+
+MIXER(monoout_mono_16bit_spline_filter_simd)
+{
+    VAR_SPLINE_MONO(int16);
+    VAR_FILTER_MONO;
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { SPLINE_16BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_MONO_AC(smpl); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_MONO(SIMD_SPLINE_16BIT,
+                                        SIMD_MIX_MONO); }
+    LOOP      { SPLINE_16BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_MONO(smpl); UPDATE_POS(); }
+
+    SAVE_FILTER_MONO();
+}
+
+MIXER(monoout_stereo_8bit_spline_filter_simd)
+{
+    VAR_SPLINE_STEREO(int8);
+    VAR_FILTER_STEREO;
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { SPLINE_8BIT(smpl, 0); SPLINE_8BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_MONO_AVG_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_STEREO(SIMD_SPLINE_STEREO_8BIT,
+                                          SIMD_MIX_MONO_AVG); }
+    LOOP      { SPLINE_8BIT(smpl, 0); SPLINE_8BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+
+    SAVE_FILTER_STEREO();
+}
+
+MIXER(monoout_stereo_16bit_spline_filter_simd)
+{
+    VAR_SPLINE_STEREO(int16);
+    VAR_FILTER_STEREO;
+    VAR_MONOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_MONOOUT;
+
+    LOOP_AC   { SPLINE_16BIT(smpl, 0); SPLINE_16BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_MONO_AVG_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_STEREO(SIMD_SPLINE_STEREO_16BIT,
+                                          SIMD_MIX_MONO_AVG); }
+    LOOP      { SPLINE_16BIT(smpl, 0); SPLINE_16BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_MONO_AVG(smpl, smpr); UPDATE_POS(); }
+
+    SAVE_FILTER_STEREO();
+}
+
+MIXER(stereoout_mono_8bit_spline_filter_simd)
+{
+    VAR_SPLINE_MONO(int8);
+    VAR_FILTER_MONO;
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREOOUT;
+
+    LOOP_AC   { SPLINE_8BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_STEREO_AC(smpl, smpl); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_MONO(SIMD_SPLINE_8BIT,
+                                        SIMD_MIX_STEREO); }
+    LOOP      { SPLINE_8BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+
+    SAVE_FILTER_MONO();
+}
+
+MIXER(stereoout_mono_16bit_spline_filter_simd)
+{
+    VAR_SPLINE_MONO(int16);
+    VAR_FILTER_MONO;
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREOOUT;
+
+    LOOP_AC   { SPLINE_16BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_STEREO_AC(smpl, smpl); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_MONO(SIMD_SPLINE_16BIT,
+                                        SIMD_MIX_STEREO); }
+    LOOP      { SPLINE_16BIT(smpl, 0);
+                FILTER_MONO(smpl); MIX_STEREO(smpl, smpl); UPDATE_POS(); }
+
+    SAVE_FILTER_MONO();
+}
+
+MIXER(stereoout_stereo_8bit_spline_filter_simd)
+{
+    VAR_SPLINE_STEREO(int8);
+    VAR_FILTER_STEREO;
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+
+    LOOP_AC   { SPLINE_8BIT(smpl, 0); SPLINE_8BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_STEREO_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_STEREO(SIMD_SPLINE_STEREO_8BIT,
+                                          SIMD_MIX_STEREO_LR); }
+    LOOP      { SPLINE_8BIT(smpl, 0); SPLINE_8BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+
+    SAVE_FILTER_STEREO();
+}
+
+MIXER(stereoout_stereo_16bit_spline_filter_simd)
+{
+    VAR_SPLINE_STEREO(int16);
+    VAR_FILTER_STEREO;
+    VAR_STEREOOUT;
+    VAR_SIMD;
+    VAR_SIMD_FILTER;
+    VAR_SIMD_STEREO;
+    VAR_SIMD_STEREOOUT_LR;
+
+    LOOP_AC   { SPLINE_16BIT(smpl, 0); SPLINE_16BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_STEREO_AC(smpl, smpr); UPDATE_POS(); }
+    LOOP_SIMD_FILTER { SIMD_FILTER_STEREO(SIMD_SPLINE_STEREO_16BIT,
+                                          SIMD_MIX_STEREO_LR); }
+    LOOP      { SPLINE_16BIT(smpl, 0); SPLINE_16BIT(smpr, 1);
+                FILTER_STEREO(smpl, smpr); MIX_STEREO(smpl, smpr); UPDATE_POS(); }
+
+    SAVE_FILTER_STEREO();
+}
+
+#endif
+
+const MIXER_FP libxmp_nearest_mixers_simd[] = {
+	LIST_MIX_FUNCTIONS(nearest_simd),
+
+#ifndef LIBXMP_CORE_DISABLE_IT
+	LIST_MIX_FUNCTIONS(nearest)
+#endif
+};
+
+const MIXER_FP libxmp_linear_mixers_simd[] = {
+	LIST_MIX_FUNCTIONS(linear_simd),
+
+#ifndef LIBXMP_CORE_DISABLE_IT
+	LIST_MIX_FUNCTIONS(linear_filter_simd)
+#endif
+};
+
+const MIXER_FP libxmp_spline_mixers_simd[] = {
+	LIST_MIX_FUNCTIONS(spline_simd),
+
+#ifndef LIBXMP_CORE_DISABLE_IT
+	LIST_MIX_FUNCTIONS(spline_filter_simd)
+#endif
+};
+
+#endif /* LIBXMP_MIX_SIMD */
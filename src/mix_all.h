@@ -29,6 +29,23 @@ typedef void (*MIXER_FP)(struct mixer_voice * LIBXMP_RESTRICT vi,
 	libxmp_mix_stereoout_stereo_8bit_ ## type, \
 	libxmp_mix_stereoout_stereo_16bit_ ## type
 
+/* Vectorized versions of the mixers. SSE2 and NEON are always
+ * present on x86-64 and AArch64, so they're enabled at compile time for
+ * these targets and selected by the mixer whenever they're available.
+ */
+#if !defined(LIBXMP_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define LIBXMP_MIX_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LIBXMP_MIX_NEON
+#endif
+#endif
+
+#if defined(LIBXMP_MIX_SSE2) || defined(LIBXMP_MIX_NEON)
+#define LIBXMP_MIX_SIMD
+#endif
+
 #define LIST_MIX_FUNCTIONS_PAULA(type) \
 	libxmp_mix_monoout_mono_ ## type, NULL, NULL, NULL, \
 	libxmp_mix_stereoout_mono_ ## type, NULL, NULL, NULL, \
@@ -41,6 +58,12 @@ extern const MIXER_FP libxmp_nearest_mixers[];
 extern const MIXER_FP libxmp_linear_mixers[];
 extern const MIXER_FP libxmp_spline_mixers[];
 
+#ifdef LIBXMP_MIX_SIMD
+extern const MIXER_FP libxmp_nearest_mixers_simd[];
+extern const MIXER_FP libxmp_linear_mixers_simd[];
+extern const MIXER_FP libxmp_spline_mixers_simd[];
+#endif
+
 /* mix_paula.c */
 #ifdef LIBXMP_PAULA_SIMULATOR
 extern const MIXER_FP libxmp_a500_mixers[];
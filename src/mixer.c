@@ -68,6 +68,17 @@ struct loop_data
 /* #define FLAG_SYNTH	0x20 */
 #define FIDX_FLAGMASK	(FLAG_16_BITS | FLAG_STEREO | FLAG_STEREOOUT | FLAG_FILTER)
 
+/* Use the vectorized mixers if the target has them (see mix_all.h) */
+#ifdef LIBXMP_MIX_SIMD
+#define NEAREST_MIXERS	libxmp_nearest_mixers_simd
+#define LINEAR_MIXERS	libxmp_linear_mixers_simd
+#define SPLINE_MIXERS	libxmp_spline_mixers_simd
+#else
+#define NEAREST_MIXERS	libxmp_nearest_mixers
+#define LINEAR_MIXERS	libxmp_linear_mixers
+#define SPLINE_MIXERS	libxmp_spline_mixers
+#endif
+
 
 /* Downmix 32bit samples to 8bit, signed or unsigned, mono or stereo output */
 static void downmix_int_8bit(int8 *LIBXMP_RESTRICT dest,
@@ -137,6 +148,18 @@ static void downmix_int_32bit(int32 *LIBXMP_RESTRICT dest,
 	}
 }
 
+/* Convert 32bit samples to normalized float, mono or stereo output.
+ * Samples are not clamped, so any headroom left in the mix is kept. */
+static void downmix_float(float *LIBXMP_RESTRICT dest,
+			  const int32 *src, int num, int amp)
+{
+	float scale = (float)(1 << amp) / (1 << (DOWNMIX_SHIFT + 15));
+
+	for (; num--; src++, dest++) {
+		*dest = *src * scale;
+	}
+}
+
 static void anticlick(struct mixer_voice *vi)
 {
 	vi->flags |= ANTICLICK;
@@ -468,10 +491,14 @@ static void libxmp_mixer_prepare(struct context_data *ctx)
 	memset(s->buf32, 0, bytelen);
 }
 
-/* Fill the output buffer calling one of the handlers. The buffer contains
- * sound for one tick (a PAL frame or 1/50s for standard vblank-timed mods)
+/* Mix all voices into a segment of the tick, starting at the given
+ * sample frame. The tick is split in more than one segment when timed
+ * events change the voices in the middle of it. If mixerset is NULL,
+ * the voice positions are advanced through the sample and its loops
+ * without mixing any samples.
  */
-void libxmp_mixer_softmixer(struct context_data *ctx)
+static void mix_voices(struct context_data *ctx, const MIXER_FP *mixerset,
+		       int offset, int count)
 {
 	struct player_data *p = &ctx->p;
 	struct mixer_data *s = &ctx->s;
@@ -485,44 +512,14 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 	int samples, size;
 	int vol, vol_l, vol_r, voc, usmp;
 	int prev_l, prev_r = 0;
-	int32 *buf_pos;
+	int32 *buf_pos, *buf_start;
 	MIXER_FP  mix_fn;
-	const MIXER_FP *mixerset;
+	int rest;
 
-	switch (s->interp) {
-	case XMP_INTERP_NEAREST:
-		mixerset = libxmp_nearest_mixers;
-		break;
-	case XMP_INTERP_LINEAR:
-		mixerset = libxmp_linear_mixers;
-		break;
-	case XMP_INTERP_SPLINE:
-		mixerset = libxmp_spline_mixers;
-		break;
-	default:
-		mixerset = libxmp_linear_mixers;
-	}
+	buf_start = s->buf32 + offset * s->output_chn;
 
-#ifdef LIBXMP_PAULA_SIMULATOR
-	if (p->flags & XMP_FLAGS_A500) {
-		if (IS_AMIGA_MOD()) {
-			if (p->filter) {
-				mixerset = libxmp_a500led_mixers;
-			} else {
-				mixerset = libxmp_a500_mixers;
-			}
-		}
-	}
-#endif
-
-#ifndef LIBXMP_CORE_DISABLE_IT
-	/* OpenMPT Bidi-Loops.it: "In Impulse Tracker's software
-	 * mixer, ping-pong loops are shortened by one sample."
-	 */
-	s->bidir_adjust = IS_PLAYER_MODE_IT() ? 1 : 0;
-#endif
-
-	libxmp_mixer_prepare(ctx);
+	/* Samples left in the tick after this segment */
+	rest = s->ticksize - offset - count;
 
 	for (voc = 0; voc < p->virt.maxvoc; voc++) {
 		int c5spd, rampsize, delta_l, delta_r;
@@ -530,8 +527,8 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 		vi = &p->virt.voice_array[voc];
 
 		if (vi->flags & ANTICLICK) {
-			if (s->interp > XMP_INTERP_NEAREST) {
-				do_anticlick(ctx, voc, NULL, 0);
+			if (mixerset != NULL && s->interp > XMP_INTERP_NEAREST) {
+				do_anticlick(ctx, voc, buf_start, s->ticksize - offset);
 			}
 			vi->flags &= ~ANTICLICK;
 		}
@@ -552,7 +549,7 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 
 		vi->pos0 = vi->pos;
 
-		buf_pos = s->buf32;
+		buf_pos = buf_start;
 		vol = vi->vol;
 
 		/* Mix volume (S3M and IT) */
@@ -581,7 +578,11 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 			get_current_sample(ctx, vi, &xxs, &xtra, &c5spd);
 		}
 
-		step = C4_PERIOD * c5spd / s->freq / vi->period;
+		/* The step only changes with the period and sample */
+		if (vi->step == 0.0) {
+			vi->step = C4_PERIOD * c5spd / s->freq / vi->period;
+		}
+		step = vi->step;
 
 		/* Don't allow <=0, otherwise m5v-nwlf.it crashes
 		 * Extremely high values that can cause undefined float/int
@@ -590,13 +591,18 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 			continue;
 		}
 
-		init_sample_wraparound(s, &loop_data, vi, xxs);
+		if (mixerset != NULL) {
+			init_sample_wraparound(s, &loop_data, vi, xxs);
+		} else {
+			loop_data.active = 0;
+			vi->sleft = vi->sright = 0;
+		}
 
 		rampsize = s->ticksize >> ANTICLICK_SHIFT;
 		delta_l = (vol_l - vi->old_vl) / rampsize;
 		delta_r = (vol_r - vi->old_vr) / rampsize;
 
-		for (size = usmp = s->ticksize; size > 0; ) {
+		for (size = usmp = count; size > 0; ) {
 			int split_noloop = 0;
 
 			if (p->xc_data[vi->chn].split) {
@@ -635,7 +641,7 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 				step_dir = -step;
 			}
 
-			if (vi->vol) {
+			if (vi->vol && mixerset != NULL) {
 				int mix_size = samples;
 				int mixer_id = vi->fidx & FIDX_FLAGMASK;
 
@@ -707,7 +713,10 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 			if ((!has_active_loop(ctx, vi, xxs) || split_noloop) &&
 			    !(vi->flags & SAMPLE_QUEUED)) {
 				if (size > 0) {
-					do_anticlick(ctx, voc, buf_pos, size);
+					if (mixerset != NULL) {
+						do_anticlick(ctx, voc, buf_pos,
+							     size + rest);
+					}
 					set_sample_end(ctx, voc, 1);
 					/* Next sample should ramp. */
 					vol_l = vol_r = 0;
@@ -724,7 +733,10 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 			     ((vi->flags & VOICE_REVERSE) && vi->pos <= vi->start)) {
 				if (vi->flags & SAMPLE_QUEUED) {
 					/* Protracker sample swap */
-					do_anticlick(ctx, voc, buf_pos, size);
+					if (mixerset != NULL) {
+						do_anticlick(ctx, voc, buf_pos,
+							     size + rest);
+					}
 					if (vi->queued.smp < 0 ||
 					    (!has_active_loop(ctx, vi, xxs) &&
 					     !(mod->xxs[vi->queued.smp].flg & XMP_SAMPLE_LOOP))) {
@@ -745,11 +757,14 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 					reset_sample_wraparound(&loop_data);
 					hotswap_sample(ctx, vi, voc, vi->queued.smp);
 					get_current_sample(ctx, vi, &xxs, &xtra, &c5spd);
-					init_sample_wraparound(s, &loop_data, vi, xxs);
+					if (mixerset != NULL) {
+						init_sample_wraparound(s, &loop_data, vi, xxs);
+					}
 					vi->pos = vi->start;
 					continue;
 				}
-				if (loop_reposition(ctx, vi, xxs, xtra)) {
+				if (loop_reposition(ctx, vi, xxs, xtra) &&
+				    mixerset != NULL) {
 					reset_sample_wraparound(&loop_data);
 					init_sample_wraparound(s, &loop_data, vi, xxs);
 				}
@@ -760,32 +775,128 @@ void libxmp_mixer_softmixer(struct context_data *ctx)
 		vi->old_vl = vol_l;
 		vi->old_vr = vol_r;
 	}
+}
 
-	/* Render final frame */
+/* Fill the output buffer calling one of the handlers. The buffer contains
+ * sound for one tick (a PAL frame or 1/50s for standard vblank-timed mods)
+ */
+static void softmixer(struct context_data *ctx, int mix)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct module_data *m = &ctx->m;
+	const MIXER_FP *mixerset;
+	int offset;
 
-	size = s->ticksize;
-	if (~s->format & XMP_FORMAT_MONO) {
-		size *= 2;
+	switch (s->interp) {
+	case XMP_INTERP_NEAREST:
+		mixerset = NEAREST_MIXERS;
+		break;
+	case XMP_INTERP_LINEAR:
+		mixerset = LINEAR_MIXERS;
+		break;
+	case XMP_INTERP_SPLINE:
+		mixerset = SPLINE_MIXERS;
+		break;
+	default:
+		mixerset = LINEAR_MIXERS;
 	}
 
-	if (size > s->total_size) {
-		size = s->total_size;
+#ifdef LIBXMP_PAULA_SIMULATOR
+	if (p->flags & XMP_FLAGS_A500) {
+		if (IS_AMIGA_MOD()) {
+			if (p->filter) {
+				mixerset = libxmp_a500led_mixers;
+			} else {
+				mixerset = libxmp_a500_mixers;
+			}
+		}
 	}
+#endif
 
-	if (s->format & XMP_FORMAT_32BIT) {
-		downmix_int_32bit((int32 *)s->buffer, s->buf32, size, s->amplify,
-				s->format & XMP_FORMAT_UNSIGNED ? 0x80000000u : 0u);
-	} else if (~s->format & XMP_FORMAT_8BIT) {
-		downmix_int_16bit((int16 *)s->buffer, s->buf32, size, s->amplify,
-				s->format & XMP_FORMAT_UNSIGNED ? 0x8000u : 0u);
-	} else {
-		downmix_int_8bit((int8 *)s->buffer, s->buf32, size, s->amplify,
-				s->format & XMP_FORMAT_UNSIGNED ? 0x80u : 0u);
+	if (!mix) {
+		mixerset = NULL;
+	}
+
+#ifndef LIBXMP_CORE_DISABLE_IT
+	/* OpenMPT Bidi-Loops.it: "In Impulse Tracker's software
+	 * mixer, ping-pong loops are shortened by one sample."
+	 */
+	s->bidir_adjust = IS_PLAYER_MODE_IT() ? 1 : 0;
+#endif
+
+	libxmp_mixer_prepare(ctx);
+
+	/* Split the tick at the timed events that fall inside it */
+	offset = 0;
+	while (p->num_timed > 0 && p->timed[0].offset < s->ticksize) {
+		if (p->timed[0].offset > offset) {
+			mix_voices(ctx, mixerset, offset,
+				   p->timed[0].offset - offset);
+			offset = p->timed[0].offset;
+		}
+		libxmp_play_timed_event(ctx);
 	}
+	mix_voices(ctx, mixerset, offset, s->ticksize - offset);
+	libxmp_advance_timed_events(ctx, s->ticksize);
 
 	s->dtright = s->dtleft = 0;
 }
 
+void libxmp_mixer_softmixer(struct context_data *ctx)
+{
+	softmixer(ctx, 1);
+}
+
+/* Advance the voices by one tick without mixing, to quickly reach a
+ * point in the module when seeking. The mixer buffer is left silent.
+ */
+void libxmp_mixer_advance(struct context_data *ctx)
+{
+	softmixer(ctx, 0);
+}
+
+/* Convert count sample frames of the mixed tick, starting at the given
+ * frame, to the output format and write them to dest.
+ */
+void libxmp_mixer_downmix(struct context_data *ctx, void *dest,
+			  int offset, int count)
+{
+	struct mixer_data *s = &ctx->s;
+	const int32 *src;
+	int size;
+
+	if (offset + count > s->ticksize) {
+		count = s->ticksize - offset;
+	}
+	if (count <= 0) {
+		return;
+	}
+
+	src = s->buf32 + offset * s->output_chn;
+	size = count * s->output_chn;
+
+	libxmp_downmix(dest, src, size, s->format, s->amplify);
+}
+
+/* Convert size 32-bit mixed samples to the given output format */
+void libxmp_downmix(void *dest, const int32 *src, int size, int format,
+		    int amp)
+{
+	if (format & XMP_FORMAT_FLOAT) {
+		downmix_float((float *)dest, src, size, amp);
+	} else if (format & XMP_FORMAT_32BIT) {
+		downmix_int_32bit((int32 *)dest, src, size, amp,
+				format & XMP_FORMAT_UNSIGNED ? 0x80000000u : 0u);
+	} else if (~format & XMP_FORMAT_8BIT) {
+		downmix_int_16bit((int16 *)dest, src, size, amp,
+				format & XMP_FORMAT_UNSIGNED ? 0x8000u : 0u);
+	} else {
+		downmix_int_8bit((int8 *)dest, src, size, amp,
+				format & XMP_FORMAT_UNSIGNED ? 0x80u : 0u);
+	}
+}
+
 void libxmp_mixer_voicepos(struct context_data *ctx, int voc, double pos, int ac)
 {
 	struct player_data *p = &ctx->p;
@@ -855,16 +966,20 @@ double libxmp_mixer_getvoicepos(struct context_data *ctx, int voc)
 void libxmp_mixer_setpatch(struct context_data *ctx, int voc, int smp, int ac)
 {
 	struct player_data *p = &ctx->p;
-#ifndef LIBXMP_CORE_DISABLE_IT
 	struct module_data *m = &ctx->m;
-#endif
 	struct mixer_data *s = &ctx->s;
 	struct mixer_voice *vi = &p->virt.voice_array[voc];
 	struct xmp_sample *xxs;
 
+	/* Samples loaded with XMP_SMPCTL_LAZY are decoded on first use */
+	if (smp >= 0 && smp < m->mod.smp && m->xtra[smp].packed != NULL) {
+		libxmp_unpack_sample(m, smp);
+	}
+
 	xxs = libxmp_get_sample(ctx, smp);
 
 	vi->smp = smp;
+	vi->step = 0.0;
 	vi->vol = 0;
 	vi->pan = 0;
 	vi->flags &= ~(SAMPLE_LOOP | SAMPLE_QUEUED | SAMPLE_PAUSED | VOICE_REVERSE | VOICE_BIDIR);
@@ -931,6 +1046,7 @@ void libxmp_mixer_setnote(struct context_data *ctx, int voc, int note)
 
 	vi->note = note;
 	vi->period = libxmp_note_to_period_mix(note, 0);
+	vi->step = 0.0;
 
 	anticlick(vi);
 }
@@ -940,7 +1056,10 @@ void libxmp_mixer_setperiod(struct context_data *ctx, int voc, double period)
 	struct player_data *p = &ctx->p;
 	struct mixer_voice *vi = &p->virt.voice_array[voc];
 
-	vi->period = period;
+	if (period != vi->period) {
+		vi->period = period;
+		vi->step = 0.0;
+	}
 }
 
 void libxmp_mixer_setvol(struct context_data *ctx, int voc, int vol)
@@ -1045,11 +1164,14 @@ int libxmp_mixer_numvoices(struct context_data *ctx, int num)
 int libxmp_mixer_on(struct context_data *ctx, int rate, int format, int c4rate)
 {
 	struct mixer_data *s = &ctx->s;
+	struct module_data *m = &ctx->m;
 	int total_size;
 	int sample_size;
 	int output_chn;
 
-	if (format & XMP_FORMAT_32BIT) {
+	if (format & XMP_FORMAT_FLOAT) {
+		sample_size = sizeof(float);
+	} else if (format & XMP_FORMAT_32BIT) {
 		sample_size = 4;
 	} else if (~format & XMP_FORMAT_8BIT) {
 		sample_size = 2;
@@ -1073,11 +1195,11 @@ int libxmp_mixer_on(struct context_data *ctx, int rate, int format, int c4rate)
 	 * 49170 for a long time, so make that the minimum size for now. */
 	CLAMP(total_size, 5 * 49170 * 2 / 20, XMP_MAX_FRAMESIZE);
 
-	s->buffer = (char *) calloc(total_size, sample_size);
+	s->buffer = (char *) libxmp_calloc(m, total_size, sample_size);
 	if (s->buffer == NULL)
 		goto err;
 
-	s->buf32 = (int32 *) calloc(total_size, sizeof(int32));
+	s->buf32 = (int32 *) libxmp_calloc(m, total_size, sizeof(int32));
 	if (s->buf32 == NULL)
 		goto err1;
 
@@ -1095,10 +1217,14 @@ int libxmp_mixer_on(struct context_data *ctx, int rate, int format, int c4rate)
 	s->dtright = s->dtleft = 0;
 	s->bidir_adjust = 0;
 
+#ifndef LIBXMP_CORE_DISABLE_IT
+	libxmp_filter_init(s);
+#endif
+
 	return 0;
 
     err1:
-	free(s->buffer);
+	libxmp_free(m, s->buffer);
 	s->buffer = NULL;
     err:
 	return -1;
@@ -1107,9 +1233,10 @@ int libxmp_mixer_on(struct context_data *ctx, int rate, int format, int c4rate)
 void libxmp_mixer_off(struct context_data *ctx)
 {
 	struct mixer_data *s = &ctx->s;
+	struct module_data *m = &ctx->m;
 
-	free(s->buffer);
-	free(s->buf32);
+	libxmp_free(m, s->buffer);
+	libxmp_free(m, s->buf32);
 	s->buf32 = NULL;
 	s->buffer = NULL;
 }
@@ -24,6 +24,7 @@ struct mixer_voice {
 	int pan;		/* */
 	int vol;		/* */
 	double period;		/* current period */
+	double step;		/* sample step for period, 0 if not set */
 	double pos;		/* position in sample */
 	int pos0;		/* position in sample before mixing */
 	int fidx;		/* mixer function index */
@@ -78,6 +79,9 @@ void    libxmp_mixer_seteffect	(struct context_data *, int, int, int);
 void    libxmp_mixer_setpan	(struct context_data *, int, int);
 int	libxmp_mixer_numvoices	(struct context_data *, int);
 void	libxmp_mixer_softmixer	(struct context_data *);
+void	libxmp_mixer_advance	(struct context_data *);
+void	libxmp_mixer_downmix	(struct context_data *, void *, int, int);
+void	libxmp_downmix		(void *, const int32 *, int, int, int);
 void	libxmp_mixer_reset	(struct context_data *);
 void	libxmp_mixer_setpatch	(struct context_data *, int, int, int);
 void	libxmp_mixer_queuepatch	(struct context_data *, int, int);
@@ -25,6 +25,7 @@
 
 #include "common.h"
 #include "period.h"
+#include "precomp_pitch.h"
 
 #include <math.h>
 
@@ -141,6 +142,42 @@ static inline double libxmp_round(double val)
 	return (val >= 0.0)? floor(val + 0.5) : ceil(val - 0.5);
 }
 
+/* Pitches are handled in units of 1/100 finetune step, 153600 units per
+ * octave. Get 2^(-x/153600) from the pitch tables, see lutgen.c.
+ */
+static double pitch_factor(int x)
+{
+	int oct, semi, fine;
+
+	/* Round down for negative pitches */
+	oct = x >= 0 ? x / PITCH_OCTAVE : -((PITCH_OCTAVE - 1 - x) / PITCH_OCTAVE);
+	x -= oct * PITCH_OCTAVE;
+	semi = x / 12800;
+	x -= semi * 12800;
+	fine = x / 100;
+
+	return ldexp(pitch_semitone_lut[semi] *
+		     (pitch_finetune_lut[fine] * pitch_frac_lut[x - fine * 100]),
+		     -oct);
+}
+
+/* Get 153600 * log2(x), the pitch interval of a period ratio */
+static double pitch_interval(double x)
+{
+	double r;
+	int exp, i;
+
+	x = 2.0 * frexp(x, &exp);	/* 1.0 <= x < 2.0 */
+	exp--;
+
+	i = (int)((x - 1.0) * (1 << LOG2_LUTBITS));
+	r = x * pitch_recip_lut[i] - 1.0;
+
+	/* log2(1 + r) for |r| < 2^-LOG2_LUTBITS */
+	return (double)exp * PITCH_OCTAVE + pitch_log2_lut[i] +
+		r * (1.0 - r * (0.5 - r / 3.0)) * (PITCH_OCTAVE / M_LN2);
+}
+
 #ifdef LIBXMP_PAULA_SIMULATOR
 /* Get period from note using Protracker tuning */
 static inline int libxmp_note_to_period_pt(int n, int f)
@@ -179,17 +216,16 @@ double libxmp_note_to_period(struct context_data *ctx, int n, int f, double adj)
 	}
 #endif
 
-	d = (double)n + (double)f / 128;
-
 	switch (m->period_type) {
 	case PERIOD_LINEAR:
+		d = (double)n + (double)f / 128;
 		per = (240.0 - d) * 16;				/* Linear */
 		break;
 	case PERIOD_CSPD:
-		per = 8363.0 * pow(2, n / 12.0) / 32 + f;	/* Hz */
+		per = 8363.0 * pitch_factor(-n * 12800) / 32 + f;	/* Hz */
 		break;
 	default:
-		per = PERIOD_BASE / pow(2, d / 12);		/* Amiga */
+		per = PERIOD_BASE * pitch_factor(n * 12800 + f * 100);	/* Amiga */
 	}
 
 #ifndef LIBXMP_CORE_PLAYER
@@ -204,8 +240,7 @@ double libxmp_note_to_period(struct context_data *ctx, int n, int f, double adj)
 /* For the software mixer */
 double libxmp_note_to_period_mix(int n, int b)
 {
-	double d = (double)n + (double)b / 12800;
-	return PERIOD_BASE / pow(2, d / 12);
+	return PERIOD_BASE * pitch_factor(n * 12800 + b);
 }
 
 /* Get note from period */
@@ -229,16 +264,21 @@ int libxmp_period_to_bend(struct context_data *ctx, double p, int n, double adj)
 		return 0;
 	}
 
-	switch (m->period_type) {
-	case PERIOD_LINEAR:
+	if (m->period_type == PERIOD_LINEAR) {
 		return 100 * (8 * (((240 - n) * 16) - p));
-	case PERIOD_CSPD:
-		d = libxmp_note_to_period(ctx, n, 0, adj);
-		return libxmp_round(100.0 * (1536.0 / M_LN2) * log(p / d));
-	default:
+	}
+
+	/* Protracker tuning has no periods for notes out of range */
+	d = libxmp_note_to_period(ctx, n, 0, adj);
+	if (d < 0.1) {
+		return 0;
+	}
+
+	if (m->period_type == PERIOD_CSPD) {
+		return libxmp_round(pitch_interval(p / d));
+	} else {
 		/* Amiga */
-		d = libxmp_note_to_period(ctx, n, 0, adj);
-		return libxmp_round(100.0 * (1536.0 / M_LN2) * log(d / p));
+		return libxmp_round(pitch_interval(d / p));
 	}
 }
 
@@ -877,12 +877,13 @@ static inline int get_channel_vol(struct context_data *ctx, int chn)
 	return p->channel_vol[root];
 }
 
-static int tremor_ft2(struct context_data *ctx, int chn, int finalvol)
+static int tremor_ft2(struct context_data *ctx, int chn, int finalvol,
+		      int step)
 {
 	struct player_data *p = &ctx->p;
 	struct channel_data *xc = &p->xc_data[chn];
 
-	if (TEST(TREMOR) && p->frame != 0) {
+	if (step && TEST(TREMOR) && p->frame != 0) {
 		xc->tremor.count &= ~TREMOR_SUPPRESS;
 		if (xc->tremor.count == 0) {
 			/* end of down cycle, set up counter for up  */
@@ -902,21 +903,24 @@ static int tremor_ft2(struct context_data *ctx, int chn, int finalvol)
 	return finalvol;
 }
 
-static int tremor_s3m(struct context_data *ctx, int chn, int finalvol)
+static int tremor_s3m(struct context_data *ctx, int chn, int finalvol,
+		      int step)
 {
 	struct player_data *p = &ctx->p;
 	struct channel_data *xc = &p->xc_data[chn];
 
 	if (TEST(TREMOR)) {
-		if (xc->tremor.count == 0) {
-			/* end of down cycle, set up counter for up  */
-			xc->tremor.count = xc->tremor.up | TREMOR_ON;
-		} else if (xc->tremor.count == TREMOR_ON) {
-			/* end of up cycle, set up counter for down */
-			xc->tremor.count = xc->tremor.down;
-		}
+		if (step) {
+			if (xc->tremor.count == 0) {
+				/* end of down cycle, set up counter for up  */
+				xc->tremor.count = xc->tremor.up | TREMOR_ON;
+			} else if (xc->tremor.count == TREMOR_ON) {
+				/* end of up cycle, set up counter for down */
+				xc->tremor.count = xc->tremor.down;
+			}
 
-		xc->tremor.count--;
+			xc->tremor.count--;
+		}
 
 		if (~xc->tremor.count & TREMOR_ON) {
 			finalvol = 0;
@@ -968,7 +972,14 @@ static void delayed_keyoff(struct context_data *ctx, int chn)
 
 #define DOENV_RELEASE ((TEST_NOTE(NOTE_ENV_RELEASE) || act == VIRT_ACTION_OFF))
 
-static void process_volume(struct context_data *ctx, int chn, int act)
+/* The process functions compute the final volume, period and pan of a
+ * channel. If step is set they also advance the envelopes, LFOs and
+ * counters by one tick and save the modulation of the tick in xc->tick;
+ * otherwise they only apply the current state (e.g. for an event played
+ * in the middle of a tick).
+ */
+static void process_volume(struct context_data *ctx, int chn, int act,
+			   int step)
 {
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
@@ -1009,7 +1020,7 @@ static void process_volume(struct context_data *ctx, int chn, int act)
 		}
 	}
 
-	if (!TEST_PER(VENV_PAUSE)) {
+	if (step && !TEST_PER(VENV_PAUSE)) {
 		xc->v_idx = update_envelope(ctx, &instrument->aei, xc->v_idx,
 			DOENV_RELEASE, TEST(KEY_OFF));
 	}
@@ -1044,7 +1055,7 @@ static void process_volume(struct context_data *ctx, int chn, int act)
 		fade = 1;
 	}
 
-	if (fade) {
+	if (step && fade) {
 		if (xc->fadeout > xc->ins_fade) {
 			xc->fadeout -= xc->ins_fade;
 		} else {
@@ -1069,16 +1080,21 @@ static void process_volume(struct context_data *ctx, int chn, int act)
 		finalvol = xc->volume * (100 - xc->rvv) / 100;
 	}
 
-	if (TEST(TREMOLO)) {
-		/* OpenMPT VibratoReset.mod */
-		if (!is_first_frame(ctx) || !HAS_QUIRK(QUIRK_PROTRACK)) {
-			finalvol += libxmp_lfo_get(ctx, &xc->tremolo.lfo, 0) / (1 << 6);
-		}
+	if (step) {
+		xc->tick.tremolo = 0;
+		if (TEST(TREMOLO)) {
+			/* OpenMPT VibratoReset.mod */
+			if (!is_first_frame(ctx) || !HAS_QUIRK(QUIRK_PROTRACK)) {
+				xc->tick.tremolo = libxmp_lfo_get(ctx,
+					&xc->tremolo.lfo, 0) / (1 << 6);
+			}
 
-		if (!is_first_frame(ctx) || HAS_QUIRK(QUIRK_VIBALL)) {
-			libxmp_lfo_update(&xc->tremolo.lfo);
+			if (!is_first_frame(ctx) || HAS_QUIRK(QUIRK_VIBALL)) {
+				libxmp_lfo_update(&xc->tremolo.lfo);
+			}
 		}
 	}
+	finalvol += xc->tick.tremolo;
 
 	CLAMP(finalvol, 0, m->volbase);
 
@@ -1104,9 +1120,9 @@ static void process_volume(struct context_data *ctx, int chn, int act)
 	}
 
 	if (IS_PLAYER_MODE_FT2()) {
-		finalvol = tremor_ft2(ctx, chn, finalvol);
+		finalvol = tremor_ft2(ctx, chn, finalvol, step);
 	} else {
-		finalvol = tremor_s3m(ctx, chn, finalvol);
+		finalvol = tremor_s3m(ctx, chn, finalvol, step);
 	}
 #ifndef LIBXMP_CORE_DISABLE_IT
 	xc->macro.finalvol = finalvol;
@@ -1128,7 +1144,8 @@ static void process_volume(struct context_data *ctx, int chn, int act)
 	}
 }
 
-static void process_frequency(struct context_data *ctx, int chn, int act)
+static void process_frequency(struct context_data *ctx, int chn, int act,
+			      int step)
 {
 #ifndef LIBXMP_CORE_DISABLE_IT
 	struct mixer_data *s = &ctx->s;
@@ -1148,60 +1165,70 @@ static void process_frequency(struct context_data *ctx, int chn, int act)
 
 	instrument = libxmp_get_instrument(ctx, xc->ins);
 
-	if (!TEST_PER(FENV_PAUSE)) {
+	if (step && !TEST_PER(FENV_PAUSE)) {
 		xc->f_idx = update_envelope(ctx, &instrument->fei, xc->f_idx,
 			DOENV_RELEASE, TEST(KEY_OFF));
 	}
 	frq_envelope = get_envelope(&instrument->fei, xc->f_idx, 0);
 
+	if (step) {
 #ifndef LIBXMP_CORE_PLAYER
-	/* Do note slide */
+		/* Do note slide */
+
+		if (TEST(NOTE_SLIDE)) {
+			if (xc->noteslide.count == 0) {
+				xc->note += xc->noteslide.slide;
+				xc->period = libxmp_note_to_period(ctx, xc->note,
+						xc->finetune, xc->per_adj);
+				xc->noteslide.count = xc->noteslide.speed;
+			}
+			xc->noteslide.count--;
 
-	if (TEST(NOTE_SLIDE)) {
-		if (xc->noteslide.count == 0) {
-			xc->note += xc->noteslide.slide;
-			xc->period = libxmp_note_to_period(ctx, xc->note,
-					xc->finetune, xc->per_adj);
-			xc->noteslide.count = xc->noteslide.speed;
+			libxmp_virt_setnote(ctx, chn, xc->note);
 		}
-		xc->noteslide.count--;
-
-		libxmp_virt_setnote(ctx, chn, xc->note);
-	}
 #endif
 
-	/* Instrument vibrato */
-	vibrato = 1.0 * libxmp_lfo_get(ctx, &xc->insvib.lfo, 1) /
-				(4096 * (1 + xc->insvib.sweep));
-	libxmp_lfo_update(&xc->insvib.lfo);
-	if (xc->insvib.sweep > 1) {
-		xc->insvib.sweep -= 2;
-	} else {
-		xc->insvib.sweep = 0;
-	}
+		/* Instrument vibrato */
+		vibrato = 1.0 * libxmp_lfo_get(ctx, &xc->insvib.lfo, 1) /
+					(4096 * (1 + xc->insvib.sweep));
+		libxmp_lfo_update(&xc->insvib.lfo);
+		if (xc->insvib.sweep > 1) {
+			xc->insvib.sweep -= 2;
+		} else {
+			xc->insvib.sweep = 0;
+		}
 
-	/* Vibrato */
-	if (TEST(VIBRATO) || TEST_PER(VIBRATO)) {
-		/* OpenMPT VibratoReset.mod */
-		if (!is_first_frame(ctx) || !HAS_QUIRK(QUIRK_PROTRACK)) {
-			int shift = HAS_QUIRK(QUIRK_VIBHALF) ? 10 : 9;
-			int vib = libxmp_lfo_get(ctx, &xc->vibrato.lfo, 1) / (1 << shift);
+		/* Vibrato */
+		if (TEST(VIBRATO) || TEST_PER(VIBRATO)) {
+			/* OpenMPT VibratoReset.mod */
+			if (!is_first_frame(ctx) || !HAS_QUIRK(QUIRK_PROTRACK)) {
+				int shift = HAS_QUIRK(QUIRK_VIBHALF) ? 10 : 9;
+				int vib = libxmp_lfo_get(ctx, &xc->vibrato.lfo, 1) / (1 << shift);
 
-			if (HAS_QUIRK(QUIRK_VIBINV)) {
-				vibrato -= vib;
-			} else {
-				vibrato += vib;
+				if (HAS_QUIRK(QUIRK_VIBINV)) {
+					vibrato -= vib;
+				} else {
+					vibrato += vib;
+				}
 			}
-		}
 
-		if (!is_first_frame(ctx) || HAS_QUIRK(QUIRK_VIBALL)) {
-			libxmp_lfo_update(&xc->vibrato.lfo);
+			if (!is_first_frame(ctx) || HAS_QUIRK(QUIRK_VIBALL)) {
+				libxmp_lfo_update(&xc->vibrato.lfo);
+			}
 		}
+
+		xc->tick.vibrato = vibrato;
+#ifndef LIBXMP_CORE_PLAYER
+		xc->tick.period = libxmp_extras_get_period(ctx, xc);
+		xc->tick.bend = libxmp_extras_get_linear_bend(ctx, xc);
+#endif
+		xc->tick.arp = arpeggio(ctx, xc);
 	}
 
+	vibrato = xc->tick.vibrato;
 	period = xc->period;
 #ifndef LIBXMP_CORE_PLAYER
-	period += libxmp_extras_get_period(ctx, xc);
+	period += xc->tick.period;
 #endif
 
 	if (HAS_QUIRK(QUIRK_ST3BUGS)) {
@@ -1215,7 +1242,7 @@ static void process_frequency(struct context_data *ctx, int chn, int act)
 	}
 
 	/* Arpeggio */
-	arp = arpeggio(ctx, xc);
+	arp = xc->tick.arp;
 
 	/* Pitch bend */
 
@@ -1270,7 +1297,7 @@ static void process_frequency(struct context_data *ctx, int chn, int act)
 
 
 #ifndef LIBXMP_CORE_PLAYER
-	linear_bend += libxmp_extras_get_linear_bend(ctx, xc);
+	linear_bend += xc->tick.bend;
 #endif
 
 	final_period = libxmp_note_to_period_mix(xc->note, linear_bend);
@@ -1333,7 +1360,7 @@ static void process_frequency(struct context_data *ctx, int chn, int act)
 	 * See OpenMPT filter-reset.it, filter-reset-carry.it */
 	if (cutoff < 0xfe || resonance > 0 || xc->filter.can_disable) {
 		int a0, b0, b1;
-		libxmp_filter_setup(s->freq, cutoff, resonance, &a0, &b0, &b1);
+		libxmp_filter_setup(s, cutoff, resonance, &a0, &b0, &b1);
 		libxmp_virt_seteffect(ctx, chn, DSP_EFFECT_FILTER_A0, a0);
 		libxmp_virt_seteffect(ctx, chn, DSP_EFFECT_FILTER_B0, b0);
 		libxmp_virt_seteffect(ctx, chn, DSP_EFFECT_FILTER_B1, b1);
@@ -1345,7 +1372,8 @@ static void process_frequency(struct context_data *ctx, int chn, int act)
 #endif
 }
 
-static void process_pan(struct context_data *ctx, int chn, int act)
+static void process_pan(struct context_data *ctx, int chn, int act,
+			int step)
 {
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
@@ -1358,19 +1386,24 @@ static void process_pan(struct context_data *ctx, int chn, int act)
 
 	instrument = libxmp_get_instrument(ctx, xc->ins);
 
-	if (!TEST_PER(PENV_PAUSE)) {
+	if (step && !TEST_PER(PENV_PAUSE)) {
 		xc->p_idx = update_envelope(ctx, &instrument->pei, xc->p_idx,
 			DOENV_RELEASE, TEST(KEY_OFF));
 	}
 	pan_envelope = get_envelope(&instrument->pei, xc->p_idx, 32);
 
 #ifndef LIBXMP_CORE_DISABLE_IT
-	if (TEST(PANBRELLO)) {
-		panbrello = libxmp_lfo_get(ctx, &xc->panbrello.lfo, 0) / 512;
-		if (is_first_frame(ctx)) {
-			libxmp_lfo_update(&xc->panbrello.lfo);
+	if (step) {
+		xc->tick.panbrello = 0;
+		if (TEST(PANBRELLO)) {
+			xc->tick.panbrello = libxmp_lfo_get(ctx,
+					&xc->panbrello.lfo, 0) / 512;
+			if (is_first_frame(ctx)) {
+				libxmp_lfo_update(&xc->panbrello.lfo);
+			}
 		}
 	}
+	panbrello = xc->tick.panbrello;
 	xc->macro.notepan = xc->pan.val + panbrello + 0x80;
 #endif
 
@@ -1596,7 +1629,10 @@ static void update_pan(struct context_data *ctx, int chn)
 	}
 }
 
-static void play_channel(struct context_data *ctx, int chn)
+/* Advance the channel by one tick: delays, counters and slides. Returns
+ * the virtual channel state, or VIRT_INVALID if there's nothing to play.
+ */
+static int step_channel(struct context_data *ctx, int chn)
 {
 	struct player_data *p = &ctx->p;
 	struct smix_data *smix = &ctx->smix;
@@ -1631,18 +1667,18 @@ static void play_channel(struct context_data *ctx, int chn)
 	if (act == VIRT_INVALID) {
 		/* We need this to keep processing global volume slides */
 		update_volume(ctx, chn);
-		return;
+		return VIRT_INVALID;
 	}
 
 	if (p->frame == 0 && act != VIRT_ACTIVE) {
 		if (!IS_VALID_INSTRUMENT_OR_SFX(xc->ins) || act == VIRT_ACTION_CUT) {
 			libxmp_virt_resetchannel(ctx, chn);
-			return;
+			return VIRT_INVALID;
 		}
 	}
 
 	if (!IS_VALID_INSTRUMENT_OR_SFX(xc->ins))
-		return;
+		return VIRT_INVALID;
 
 #ifndef LIBXMP_CORE_PLAYER
 	libxmp_play_extras(ctx, xc, chn);
@@ -1691,9 +1727,26 @@ static void play_channel(struct context_data *ctx, int chn)
 	update_frequency(ctx, chn);
 	update_pan(ctx, chn);
 
-	process_volume(ctx, chn, act);
-	process_frequency(ctx, chn, act);
-	process_pan(ctx, chn, act);
+	return act;
+}
+
+static void play_channel(struct context_data *ctx, int chn)
+{
+	struct player_data *p = &ctx->p;
+#ifndef LIBXMP_CORE_PLAYER
+	struct module_data *m = &ctx->m;
+	struct xmp_module *mod = &m->mod;
+#endif
+	struct channel_data *xc = &p->xc_data[chn];
+	int act;
+
+	act = step_channel(ctx, chn);
+	if (act == VIRT_INVALID)
+		return;
+
+	process_volume(ctx, chn, act, 1);
+	process_frequency(ctx, chn, act, 1);
+	process_pan(ctx, chn, act, 1);
 
 #ifndef LIBXMP_CORE_PLAYER
 	if (HAS_QUIRK(QUIRK_PROTRACK | QUIRK_INVLOOP) && xc->ins < mod->ins) {
@@ -1708,6 +1761,30 @@ static void play_channel(struct context_data *ctx, int chn)
 	xc->info_position = libxmp_virt_getvoicepos(ctx, chn);
 }
 
+/* Send the current state of a channel to the mixer without advancing it.
+ * Used for events played in the middle of a tick, after the channel was
+ * already stepped for the tick in play_frame().
+ */
+static void apply_channel(struct context_data *ctx, int chn)
+{
+	struct player_data *p = &ctx->p;
+	struct smix_data *smix = &ctx->smix;
+	struct module_data *m = &ctx->m;
+	struct xmp_module *mod = &m->mod;
+	struct channel_data *xc = &p->xc_data[chn];
+	int act;
+
+	act = libxmp_virt_cstat(ctx, chn);
+	if (act == VIRT_INVALID || !IS_VALID_INSTRUMENT_OR_SFX(xc->ins))
+		return;
+
+	process_volume(ctx, chn, act, 0);
+	process_frequency(ctx, chn, act, 0);
+	process_pan(ctx, chn, act, 0);
+
+	xc->info_position = libxmp_virt_getvoicepos(ctx, chn);
+}
+
 /*
  * Event injection
  */
@@ -1727,6 +1804,66 @@ static void inject_event(struct context_data *ctx)
 			e->_flag = 0;
 		}
 	}
+
+	/* Timed events due at the start of the tick */
+	while (p->num_timed > 0 && p->timed[0].offset <= 0) {
+		struct timed_event *t = &p->timed[0];
+		libxmp_read_event(ctx, &t->e, t->chn);
+		memmove(t, t + 1, --p->num_timed * sizeof(struct timed_event));
+	}
+}
+
+/* Insert an event in the timed event queue, keeping it sorted by offset.
+ * Events with the same offset are played in the order they were queued.
+ */
+int libxmp_queue_timed_event(struct context_data *ctx, int chn,
+			     const struct xmp_event *e, int offset)
+{
+	struct player_data *p = &ctx->p;
+	struct timed_event *t;
+	int i;
+
+	if (p->num_timed >= MAX_TIMED_EVENTS)
+		return -1;
+
+	for (i = p->num_timed; i > 0 && p->timed[i - 1].offset > offset; i--);
+
+	t = &p->timed[i];
+	memmove(t + 1, t, (p->num_timed - i) * sizeof(struct timed_event));
+	t->chn = chn;
+	t->offset = offset;
+	t->e = *e;
+	t->e._flag = 1;
+	p->num_timed++;
+
+	return 0;
+}
+
+/* Play the first event of the timed event queue in the middle of a tick.
+ * The channel state is applied again so the mixer voice picks up the new
+ * note, volume and period from this point on. Slides, envelopes and
+ * counters were already advanced for this tick and are left alone.
+ */
+void libxmp_play_timed_event(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct timed_event *t = &p->timed[0];
+	int chn = t->chn;
+
+	libxmp_read_event(ctx, &t->e, chn);
+	memmove(t, t + 1, --p->num_timed * sizeof(struct timed_event));
+	apply_channel(ctx, chn);
+}
+
+/* Make the offsets of the pending events relative to the next tick */
+void libxmp_advance_timed_events(struct context_data *ctx, int ticksize)
+{
+	struct player_data *p = &ctx->p;
+	int i;
+
+	for (i = 0; i < p->num_timed; i++) {
+		p->timed[i].offset -= ticksize;
+	}
 }
 
 /*
@@ -1945,6 +2082,9 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 	if (ctx->state > XMP_STATE_LOADED)
 		xmp_end_player(opaque);
 
+	if (libxmp_deferred_scan(ctx) < 0)
+		return -XMP_ERROR_LOAD;
+
 	if (libxmp_mixer_on(ctx, rate, format, m->c4rate) < 0)
 		return -XMP_ERROR_INTERNAL;
 
@@ -1958,6 +2098,9 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 	p->current_time = 0;
 	p->loop_count = 0;
 	p->sequence = 0;
+	p->num_timed = 0;
+	p->render_data.pos = 0;
+	p->render_data.size = 0;
 
 	/* Set default volume and mute status */
 	for (i = 0; i < XMP_MAX_CHANNELS; i++) {
@@ -2001,13 +2144,13 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 
 	libxmp_reset_flow(ctx);
 
-	f->loop = (struct pattern_loop *) calloc(p->virt.virt_channels, sizeof(struct pattern_loop));
+	f->loop = (struct pattern_loop *) libxmp_calloc(m, p->virt.virt_channels, sizeof(struct pattern_loop));
 	if (f->loop == NULL) {
 		ret = -XMP_ERROR_SYSTEM;
 		goto err;
 	}
 
-	p->xc_data = (struct channel_data *) calloc(p->virt.virt_channels, sizeof(struct channel_data));
+	p->xc_data = (struct channel_data *) libxmp_calloc(m, p->virt.virt_channels, sizeof(struct channel_data));
 	if (p->xc_data == NULL) {
 		ret = -XMP_ERROR_SYSTEM;
 		goto err1;
@@ -2034,11 +2177,11 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 
 #ifndef LIBXMP_CORE_PLAYER
     err2:
-	free(p->xc_data);
+	libxmp_free(m, p->xc_data);
 	p->xc_data = NULL;
 #endif
     err1:
-	free(f->loop);
+	libxmp_free(m, f->loop);
 	f->loop = NULL;
     err:
 	return ret;
@@ -2061,9 +2204,12 @@ static void check_end_of_module(struct context_data *ctx)
 	}
 }
 
-int xmp_play_frame(xmp_context opaque)
+/* Play one frame and mix it, leaving the mixed samples in the mixer
+ * buffer to be downmixed to the output format by the caller. If mix is
+ * zero, the voices are advanced without mixing.
+ */
+static int play_frame(struct context_data *ctx, int mix)
 {
-	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
 	struct xmp_module *mod = &m->mod;
@@ -2166,15 +2312,41 @@ int xmp_play_frame(xmp_context opaque)
 		play_channel(ctx, i);
 	}
 
+	libxmp_virt_cull(ctx);
+
 	f->rowdelay_set &= ~ROWDELAY_FIRST_FRAME;
 
 	p->current_time += libxmp_get_frame_time(ctx);
 
-	libxmp_mixer_softmixer(ctx);
+	if (mix) {
+		libxmp_mixer_softmixer(ctx);
+	} else {
+		libxmp_mixer_advance(ctx);
+	}
 
 	return 0;
 }
 
+/* Play one frame without producing any samples */
+int libxmp_advance_frame(struct context_data *ctx)
+{
+	return play_frame(ctx, 0);
+}
+
+int xmp_play_frame(xmp_context opaque)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct mixer_data *s = &ctx->s;
+	int ret;
+
+	ret = play_frame(ctx, 1);
+	if (ret == 0) {
+		libxmp_mixer_downmix(ctx, s->buffer, 0, s->ticksize);
+	}
+
+	return ret;
+}
+
 int xmp_play_buffer(xmp_context opaque, void *out_buffer, int size, int loop)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
@@ -2232,10 +2404,84 @@ int xmp_play_buffer(xmp_context opaque, void *out_buffer, int size, int loop)
 	return ret;
 }
 
+/* Mix the next frame if all sample frames of the current one were
+ * rendered. The sample frames left to render are in the mixer buffer
+ * from render_data.pos to render_data.size.
+ */
+int libxmp_render_frame(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	int ret;
+
+	if (p->render_data.pos < p->render_data.size)
+		return 0;
+
+	ret = play_frame(ctx, 1);
+	p->render_data.pos = 0;
+	p->render_data.size = ret == 0 ? s->ticksize : 0;
+
+	return ret;
+}
+
+int xmp_render_samples(xmp_context opaque, void *out_buffer, int num, int loop)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	char *out = (char *)out_buffer;
+	int ret = 0, frame_size, count;
+
+	/* Reset internal state
+	 * Syncs buffer start with frame start */
+	if (out_buffer == NULL) {
+		p->loop_count = 0;
+		p->render_data.pos = 0;
+		p->render_data.size = 0;
+		return 0;
+	}
+
+	if (ctx->state < XMP_STATE_PLAYING)
+		return -XMP_ERROR_STATE;
+
+	frame_size = s->output_chn * s->sample_size;
+
+	while (num > 0) {
+		/* Mix the next frame when the current one is used up */
+		if (p->render_data.pos == p->render_data.size) {
+			ret = libxmp_render_frame(ctx);
+
+			/* Check end of module */
+			if (ret < 0 || (loop > 0 && p->loop_count >= loop)) {
+				p->render_data.size = 0;
+
+				/* Start of buffer, return end of replay */
+				if (out == (char *)out_buffer) {
+					return -XMP_END;
+				}
+
+				/* Fill remaining of this buffer */
+				memset(out, 0, num * frame_size);
+				return 0;
+			}
+		}
+
+		/* Downmix straight into the user buffer */
+		count = MIN(num, p->render_data.size - p->render_data.pos);
+		libxmp_mixer_downmix(ctx, out, p->render_data.pos, count);
+		p->render_data.pos += count;
+		out += count * frame_size;
+		num -= count;
+	}
+
+	return ret;
+}
+
 void xmp_end_player(xmp_context opaque)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
 	struct flow_control *f = &p->flow;
 #ifndef LIBXMP_CORE_PLAYER
 	struct channel_data *xc;
@@ -2257,8 +2503,8 @@ void xmp_end_player(xmp_context opaque)
 
 	libxmp_virt_off(ctx);
 
-	free(p->xc_data);
-	free(f->loop);
+	libxmp_free(m, p->xc_data);
+	libxmp_free(m, f->loop);
 
 	p->xc_data = NULL;
 	f->loop = NULL;
@@ -2271,14 +2517,18 @@ void xmp_get_module_info(xmp_context opaque, struct xmp_module_info *info)
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct module_data *m = &ctx->m;
 	struct xmp_module *mod = &m->mod;
+	int scanned;
 
 	if (ctx->state < XMP_STATE_LOADED)
 		return;
 
+	/* Don't report sequences from a failed deferred scan */
+	scanned = libxmp_deferred_scan(ctx) == 0;
+
 	memcpy(info->md5, m->md5, 16);
 	info->mod = mod;
 	info->comment = m->comment;
-	info->num_sequences = m->num_sequences;
+	info->num_sequences = scanned ? m->num_sequences : 0;
 	info->seq_data = m->seq_data;
 	info->vol_base = m->volbase;
 }
@@ -2297,6 +2547,12 @@ void xmp_get_frame_info(xmp_context opaque, struct xmp_frame_info *info)
 	if (ctx->state < XMP_STATE_LOADED)
 		return;
 
+	/* A failed deferred scan leaves no frame data to report */
+	if (libxmp_deferred_scan(ctx) < 0) {
+		memset(info, 0, sizeof(struct xmp_frame_info));
+		return;
+	}
+
 	chn = mod->chn;
 
 	if (p->pos >= 0 && p->pos < mod->len) {
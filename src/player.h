@@ -78,7 +78,9 @@ struct retrig_control {
  * samples of >0 length and bound the loop values for these samples. */
 #define IS_VALID_INSTRUMENT(x) ((uint32)(x) < mod->ins && mod->xxi[(x)].nsm > 0)
 #define IS_VALID_INSTRUMENT_OR_SFX(x) (((uint32)(x) < mod->ins && mod->xxi[(x)].nsm > 0) || (smix->ins > 0 && (uint32)(x) < mod->ins + smix->ins))
-#define IS_VALID_SAMPLE(x) ((uint32)(x) < mod->smp && mod->xxs[(x)].data != NULL)
+/* Samples loaded with XMP_SMPCTL_LAZY are valid before they're decoded */
+#define IS_VALID_SAMPLE(x) ((uint32)(x) < mod->smp && \
+	(mod->xxs[(x)].data != NULL || m->xtra[(x)].packed != NULL))
 #define IS_VALID_NOTE(x) ((uint32)(x) < XMP_MAX_KEYS)
 
 struct instrument_vibrato {
@@ -268,6 +270,19 @@ struct channel_data {
 	void *extra;
 #endif
 
+	struct {
+		int tremolo;	/* Tremolo volume offset */
+		double vibrato;	/* Vibrato period offset */
+		int arp;	/* Arpeggio note offset */
+#ifndef LIBXMP_CORE_PLAYER
+		int period;	/* Extras period offset */
+		int bend;	/* Extras linear bend */
+#endif
+#ifndef LIBXMP_CORE_DISABLE_IT
+		int panbrello;	/* Panbrello pan offset */
+#endif
+	} tick;			/* Modulation computed in the current tick */
+
 	struct xmp_event delayed_event;
 	int delayed_ins;	/* IT save instrument emulation */
 	int key_memory;		/* Previous key (XM) */
@@ -283,7 +298,8 @@ LIBXMP_BEGIN_DECLS
 
 void	libxmp_process_fx	(struct context_data *, struct channel_data *,
 				 int, const struct xmp_event *, int);
-void	libxmp_filter_setup	(int, int, int, int*, int*, int *);
+void	libxmp_filter_init	(struct mixer_data *);
+void	libxmp_filter_setup	(struct mixer_data *, int, int, int *, int *, int *);
 int	libxmp_read_event	(struct context_data *, const struct xmp_event *, int);
 
 void	libxmp_process_pattern_loop	(struct context_data *,
@@ -295,6 +311,18 @@ void	libxmp_process_pattern_break	(struct context_data *,
 void	libxmp_process_line_jump	(struct context_data *,
 	struct flow_control *f, int, int);
 
+/* For the mixer to split ticks at timed events */
+int	libxmp_queue_timed_event	(struct context_data *, int,
+	const struct xmp_event *, int);
+void	libxmp_play_timed_event		(struct context_data *);
+void	libxmp_advance_timed_events	(struct context_data *, int);
+
+/* For the mixing bus */
+int	libxmp_render_frame		(struct context_data *);
+
+/* For seeking */
+int	libxmp_advance_frame		(struct context_data *);
+
 /* For virt_pastnote() */
 void	libxmp_player_set_release	(struct context_data *, int);
 void	libxmp_player_set_fadeout	(struct context_data *, int);
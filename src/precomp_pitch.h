@@ -0,0 +1,206 @@
+#define PITCH_OCTAVE 153600
+#define LOG2_LUTBITS 8
+
+static const double pitch_semitone_lut[12] = {
+	 1, 0.94387431268169353, 0.89089871814033927, 0.8408964152537145,
+	 0.79370052598409979, 0.74915353843834076, 0.70710678118654757, 0.66741992708501718,
+	 0.6299605249474366, 0.59460355750136051, 0.56123102415468651, 0.52973154717964765,
+};
+
+static const double pitch_finetune_lut[128] = {
+	 1, 0.99954883411027506, 0.99909787177121012, 0.99864711289097019,
+	 0.99819655737776147, 0.9977462051398317, 0.99729605608547012, 0.99684611012300717,
+	 0.99639636716081459, 0.99594682710730575, 0.99549748987093523, 0.99504835536019864,
+	 0.99459942348363317, 0.99415069414981727, 0.99370216726737048, 0.99325384274495365,
+	 0.99280572049126892, 0.9923578004150595, 0.9919100824251097, 0.99146256643024522,
+	 0.99101525233933274, 0.99056814006128002, 0.99012122950503612, 0.98967452057959093,
+	 0.98922801319397546, 0.988781707257262, 0.98833560267856346, 0.98788969936703419,
+	 0.98744399723186915, 0.9869984961823044, 0.98655319612761716, 0.9861080969771252,
+	 0.98566319864018759, 0.9852185010262039, 0.9847740040446149, 0.98432970760490213,
+	 0.98388561161658794, 0.98344171598923535, 0.98299802063244834, 0.98255452545587185,
+	 0.98211123036919135, 0.98166813528213293, 0.98122524010446366, 0.98078254474599136,
+	 0.98034004911656436, 0.97989775312607164, 0.97945565668444312, 0.97901375970164894,
+	 0.97857206208770009, 0.9781305637526484, 0.97768926460658567, 0.97724816455964492,
+	 0.97680726352199931, 0.97636656140386258, 0.97592605811548916, 0.97548575356717371,
+	 0.9750456476692515, 0.97460574033209846, 0.97416603146613046, 0.97372652098180423,
+	 0.97328720878961661, 0.97284809480010515, 0.97240917892384748, 0.97197046107146157,
+	 0.97153194115360586, 0.97109361908097913, 0.97065549476432023, 0.9702175681144084,
+	 0.96977983904206333, 0.96934230745814454, 0.96890497327355218, 0.96846783639922629,
+	 0.96803089674614717, 0.96759415422533546, 0.96715760874785173, 0.96672126022479676,
+	 0.96628510856731142, 0.96584915368657664, 0.96541339549381355, 0.96497783390028324,
+	 0.96454246881728678, 0.9641073001561653, 0.96367232782830003, 0.96323755174511205,
+	 0.96280297181806251, 0.96236858795865232, 0.96193440007842257, 0.96150040808895421,
+	 0.96106661190186782, 0.96063301142882418, 0.9601996065815237, 0.95976639727170687,
+	 0.9593333834111536, 0.95890056491168407, 0.95846794168515792, 0.95803551364347472,
+	 0.9576032806985737, 0.9571712427624337, 0.95673939974707367, 0.95630775156455183,
+	 0.95587629812696639, 0.95544503934645497, 0.95501397513519493, 0.95458310540540325,
+	 0.95415243006933659, 0.95372194903929119, 0.95329166222760264, 0.95286156954664636,
+	 0.95243167090883707, 0.95200196622662925, 0.95157245541251678, 0.95114313837903275,
+	 0.95071401503875019, 0.95028508530428135, 0.94985634908827765, 0.94942780630343027,
+	 0.94899945686246978, 0.94857130067816597, 0.94814333766332792, 0.94771556773080423,
+	 0.9472879907934828, 0.94686060676429074, 0.94643341555619442, 0.94600641708219957,
+	 0.94557961125535117, 0.94515299798873331, 0.9447265771954696, 0.94430034878872238,
+};
+
+static const double pitch_frac_lut[100] = {
+	 1, 0.9999954873332253, 0.99999097468681486, 0.99998646206076847,
+	 0.99998194945508601, 0.99997743686976737, 0.99997292430481266, 0.99996841176022155,
+	 0.99996389923599405, 0.99995938673213014, 0.99995487424862961, 0.99995036178549246,
+	 0.99994584934271857, 0.99994133692030773, 0.99993682451826005, 0.9999323121365753,
+	 0.99992779977525337, 0.99992328743429426, 0.99991877511369787, 0.99991426281346407,
+	 0.99990975053359277, 0.99990523827408384, 0.99990072603493729, 0.9998962138161529,
+	 0.99989170161773078, 0.99988718943967059, 0.99988267728197244, 0.99987816514463612,
+	 0.99987365302766151, 0.99986914093104862, 0.99986462885479732, 0.99986011679890752,
+	 0.9998556047633792, 0.99985109274821216, 0.99984658075340627, 0.99984206877896153,
+	 0.99983755682487785, 0.9998330448911551, 0.99982853297779317, 0.99982402108479207,
+	 0.99981950921215168, 0.99981499735987178, 0.99981048552795238, 0.99980597371639335,
+	 0.9998014619251947, 0.99979695015435621, 0.99979243840387777, 0.99978792667375949,
+	 0.99978341496400103, 0.9997789032746025, 0.99977439160556369, 0.9997698799568846,
+	 0.999765368328565, 0.99976085672060488, 0.99975634513300415, 0.99975183356576269,
+	 0.9997473220188805, 0.99974281049235736, 0.99973829898619326, 0.99973378750038799,
+	 0.99972927603494166, 0.99972476458985404, 0.99972025316512503, 0.99971574176075462,
+	 0.9997112303767427, 0.99970671901308916, 0.9997022076697939, 0.99969769634685679,
+	 0.99969318504427773, 0.99968867376205672, 0.99968416250019365, 0.99967965125868841,
+	 0.99967514003754088, 0.99967062883675095, 0.99966611765631863, 0.99966160649624369,
+	 0.99965709535652614, 0.99965258423716585, 0.99964807313816284, 0.99964356205951677,
+	 0.99963905100122774, 0.99963453996329565, 0.99963002894572039, 0.99962551794850185,
+	 0.9996210069716398, 0.99961649601513447, 0.99961198507898552, 0.99960747416319284,
+	 0.99960296326775655, 0.99959845239267631, 0.99959394153795222, 0.99958943070358408,
+	 0.99958491988957188, 0.99958040909591539, 0.99957589832261462, 0.99957138756966957,
+	 0.99956687683708001, 0.99956236612484584, 0.99955785543296705, 0.99955334476144342,
+};
+
+static const double pitch_log2_lut[256] = {
+	 0, 863.93075617967713, 1724.5064330118328, 2581.7529886546772,
+	 3435.6960811706131, 4286.3610731342569, 5133.7730361523636, 5977.9567552976414,
+	 6818.9367334584476, 7656.7371956062516, 8491.3820929827234, 9322.8951072082855,
+	 10151.299654313845, 10976.618888697467, 11798.875707007626, 12618.092751954671,
+	 13434.292416052132, 14247.496845289335, 15057.727942736905, 15865.007372086573,
+	 16669.35656112677, 17470.796705155328, 18269.34877033074, 19065.033496963213,
+	 19857.871402746849, 20647.882785934249, 21435.087728454691, 22219.506098977126,
+	 23001.157555919162, 23780.061550403178, 24556.237329160613, 25329.703937385642,
+	 26100.480221539183, 26868.584832104265, 27634.036226293938, 28396.8526707124,
+	 29157.052243970644, 29914.652839257273, 30669.672166865574, 31422.127756677673,
+	 32172.036960606685, 32919.416954997629, 33664.28474298802, 34406.657156828936,
+	 35146.550860167299, 35883.982350290229, 36618.967960332127, 37351.523861445261,
+	 38081.666064934732, 38809.41042435819, 39534.772637591319, 40257.768248859553,
+	 40978.412650736849, 41696.721086111931, 42412.708650122891, 43126.390292060554,
+	 43837.780817241342, 44546.894888850176, 45253.747029753911, 45958.351624286028,
+	 46660.722920003012, 47360.87502941295, 48058.821931676983, 48754.577474283942,
+	 49448.155374698857, 50139.569221985759, 50828.832478405166, 51515.958480986861,
+	 52200.960443078366, 52883.851455869466, 53564.644489893515, 54243.352396505477,
+	 54919.987909337658, 55594.563645733098, 56267.092108157303, 56937.585685588638,
+	 57606.056654887638, 58272.517182145864, 58936.979324014428, 59599.455029012694,
+	 60259.956138817579, 60918.494389533458, 61575.081412943509, 62229.728737742429,
+	 62882.447790751001, 63533.249898112896, 64182.146286473908, 64829.148084143977,
+	 65474.266322242249, 66117.511935825634, 66758.895765000911, 67398.428556020881,
+	 68036.120962364672, 68671.983545802592, 69306.026777445702, 69938.261038780533,
+	 70568.696622688847, 71197.343734453301, 71824.212492748411, 72449.31293061802,
+	 73072.654996438694, 73694.248554869715, 74314.103387789786, 74932.229195220702,
+	 75548.635596238033, 76163.332129869465, 76776.328255980348, 77387.633356147315,
+	 77997.256734519746, 78605.207618669519, 79211.495160428924, 79816.128436717481,
+	 80419.116450357178, 81020.468130876849, 81620.192335305546, 82218.297848955393,
+	 82814.793386193618, 83409.687591204536, 84002.989038740998, 84594.706234866171,
+	 85184.847617685111, 85773.421558066839, 86360.436360356747, 86945.900263079704,
+	 87529.821439633597, 88112.207998974263, 88693.067986291004, 89272.40938367341,
+	 89850.240110769591, 90426.568025435714, 91001.400924377158, 91574.746543781424,
+	 92146.61255994282, 92717.006589879078, 93285.9361919402, 93853.408866409314,
+	 94419.43205609599, 94984.013146921963, 95547.159468499391, 96108.878294701863,
+	 96669.176844228045, 97228.062281158331, 97785.541715504456, 98341.622203752311,
+	 98896.310749397715, 99449.614303475755, 100001.53976508343, 100552.0939818958,
+	 101101.28375067568, 101649.11581777722, 102195.59687964307, 102740.73358329554,
+	 103284.53252682173, 103827.00025985262, 104368.1432840365, 104907.96805350648,
+	 105446.48097534236, 105983.68841002682, 106519.59667189635, 107054.2120295865,
+	 107587.54070647177, 108119.58888110034, 108650.36268762359, 109179.86821622042,
+	 109708.11151351644, 110235.09858299844, 110760.83538542363, 111285.32783922429,
+	 111808.58182090741, 112330.60316544984, 112851.39766668875, 113370.97107770733,
+	 113889.32911121617, 114406.4774399302, 114922.42169694112, 115437.16747608548,
+	 115950.72033230879, 116463.08578202497, 116974.26930347203, 117484.27633706351,
+	 117993.1122857359, 118500.78251529191, 119007.29235474023, 119512.64709663103,
+	 120016.85199738773, 120519.91227763516, 121021.83312252391, 121522.61968205082,
+	 122022.27707137629, 122520.81037113754, 123018.22462775881, 123514.52485375763,
+	 124009.71602804799, 124503.80309624017, 124996.79097093691, 125488.68453202653,
+	 125979.48862697286, 126469.20807110172, 126957.84764788454, 127445.4121092186,
+	 127931.90617570434, 128417.33453691953, 128901.7018516906, 129385.01274836091,
+	 129867.27182505604, 130348.48364994633, 130828.65276150644, 131307.78366877232,
+	 131785.88085159508, 132262.94876089247, 132738.99181889743, 133214.01441940409,
+	 133688.02092801093, 134161.01568236185, 134633.00299238396, 135103.9871405235,
+	 135573.97238197882, 136042.96294493112, 136510.9630307726, 136977.97681433245,
+	 137444.00844410012, 137909.0620424466, 138373.14170584298, 138836.25150507729,
+	 139298.39548546844, 139759.57766707844, 140219.80204492211, 140679.07258917476,
+	 141137.39324537769, 141594.76793464168, 142051.20055384794, 142506.69497584776,
+	 142961.25504965935, 143414.88460066312, 143867.58743079484, 144319.36731873685,
+	 144770.22802010726, 145220.17326764722, 145669.20677140649, 146117.33221892689,
+	 146564.55327542403, 147010.87358396716, 147456.29676565723, 147900.82641980323,
+	 148344.46612409657, 148787.21943478403, 149229.0898868386, 149670.08099412898,
+	 150110.19624958717, 150549.43912537454, 150987.81307304604, 151425.32152371309,
+	 151861.96788820467, 152297.7555572268, 152732.68790152058, 153166.76827201867,
+};
+
+static const double pitch_recip_lut[256] = {
+	 1, 0.99610894941634243, 0.99224806201550386, 0.98841698841698844,
+	 0.98461538461538467, 0.98084291187739459, 0.97709923664122134, 0.97338403041825095,
+	 0.96969696969696972, 0.96603773584905661, 0.96240601503759393, 0.95880149812734083,
+	 0.95522388059701491, 0.95167286245353155, 0.94814814814814818, 0.94464944649446492,
+	 0.94117647058823528, 0.93772893772893773, 0.93430656934306566, 0.93090909090909091,
+	 0.92753623188405798, 0.92418772563176899, 0.92086330935251803, 0.91756272401433692,
+	 0.91428571428571426, 0.91103202846975084, 0.90780141843971629, 0.90459363957597172,
+	 0.90140845070422537, 0.89824561403508774, 0.8951048951048951, 0.89198606271777003,
+	 0.88888888888888884, 0.88581314878892736, 0.88275862068965516, 0.8797250859106529,
+	 0.87671232876712324, 0.87372013651877134, 0.87074829931972786, 0.8677966101694915,
+	 0.86486486486486491, 0.86195286195286192, 0.85906040268456374, 0.85618729096989965,
+	 0.85333333333333339, 0.85049833887043191, 0.84768211920529801, 0.84488448844884489,
+	 0.84210526315789469, 0.83934426229508197, 0.83660130718954251, 0.83387622149837137,
+	 0.83116883116883122, 0.82847896440129454, 0.82580645161290323, 0.82315112540192925,
+	 0.82051282051282048, 0.8178913738019169, 0.8152866242038217, 0.8126984126984127,
+	 0.810126582278481, 0.80757097791798105, 0.80503144654088055, 0.80250783699059558,
+	 0.80000000000000004, 0.79750778816199375, 0.79503105590062106, 0.79256965944272451,
+	 0.79012345679012341, 0.78769230769230769, 0.78527607361963192, 0.78287461773700306,
+	 0.78048780487804881, 0.77811550151975684, 0.77575757575757576, 0.77341389728096677,
+	 0.77108433734939763, 0.76876876876876876, 0.76646706586826352, 0.76417910447761195,
+	 0.76190476190476186, 0.75964391691394662, 0.75739644970414199, 0.75516224188790559,
+	 0.75294117647058822, 0.75073313782991202, 0.74853801169590639, 0.74635568513119532,
+	 0.7441860465116279, 0.74202898550724639, 0.73988439306358378, 0.73775216138328525,
+	 0.73563218390804597, 0.73352435530085958, 0.73142857142857143, 0.72934472934472938,
+	 0.72727272727272729, 0.72521246458923516, 0.7231638418079096, 0.72112676056338032,
+	 0.7191011235955056, 0.71708683473389356, 0.71508379888268159, 0.71309192200557103,
+	 0.71111111111111114, 0.70914127423822715, 0.70718232044198892, 0.70523415977961434,
+	 0.70329670329670335, 0.70136986301369864, 0.69945355191256831, 0.6975476839237057,
+	 0.69565217391304346, 0.69376693766937669, 0.69189189189189193, 0.69002695417789761,
+	 0.68817204301075274, 0.68632707774798929, 0.68449197860962563, 0.68266666666666664,
+	 0.68085106382978722, 0.67904509283819625, 0.67724867724867721, 0.67546174142480209,
+	 0.67368421052631577, 0.67191601049868765, 0.67015706806282727, 0.66840731070496084,
+	 0.66666666666666663, 0.66493506493506493, 0.66321243523316065, 0.66149870801033595,
+	 0.65979381443298968, 0.65809768637532129, 0.65641025641025641, 0.65473145780051156,
+	 0.65306122448979587, 0.65139949109414763, 0.64974619289340096, 0.64810126582278482,
+	 0.64646464646464652, 0.64483627204030225, 0.64321608040201006, 0.64160401002506262,
+	 0.64000000000000001, 0.63840399002493764, 0.63681592039800994, 0.63523573200992556,
+	 0.63366336633663367, 0.63209876543209875, 0.63054187192118227, 0.62899262899262898,
+	 0.62745098039215685, 0.62591687041564792, 0.62439024390243902, 0.62287104622871048,
+	 0.62135922330097082, 0.61985472154963683, 0.61835748792270528, 0.61686746987951813,
+	 0.61538461538461542, 0.61390887290167862, 0.61244019138755978, 0.61097852028639621,
+	 0.60952380952380958, 0.60807600950118768, 0.60663507109004744, 0.60520094562647753,
+	 0.60377358490566035, 0.60235294117647054, 0.60093896713615025, 0.59953161592505855,
+	 0.59813084112149528, 0.59673659673659674, 0.59534883720930232, 0.59396751740139209,
+	 0.59259259259259256, 0.59122401847575057, 0.58986175115207373, 0.58850574712643677,
+	 0.58715596330275233, 0.58581235697940504, 0.58447488584474883, 0.58314350797266512,
+	 0.58181818181818179, 0.58049886621315194, 0.579185520361991, 0.57787810383747173,
+	 0.57657657657657657, 0.57528089887640455, 0.57399103139013452, 0.57270693512304249,
+	 0.5714285714285714, 0.57015590200445432, 0.56888888888888889, 0.56762749445676275,
+	 0.5663716814159292, 0.56512141280353201, 0.56387665198237891, 0.56263736263736264,
+	 0.56140350877192979, 0.56017505470459517, 0.55895196506550215, 0.55773420479302838,
+	 0.55652173913043479, 0.55531453362255967, 0.55411255411255411, 0.55291576673866094,
+	 0.55172413793103448, 0.55053763440860215, 0.54935622317596566, 0.54817987152034264,
+	 0.54700854700854706, 0.54584221748400852, 0.5446808510638298, 0.54352441613588109,
+	 0.5423728813559322, 0.54122621564482032, 0.54008438818565396, 0.53894736842105262,
+	 0.53781512605042014, 0.5366876310272537, 0.53556485355648531, 0.53444676409185798,
+	 0.53333333333333333, 0.53222453222453225, 0.53112033195020747, 0.53002070393374745,
+	 0.52892561983471076, 0.52783505154639176, 0.52674897119341568, 0.52566735112936347,
+	 0.52459016393442626, 0.52351738241308798, 0.52244897959183678, 0.52138492871690423,
+	 0.52032520325203258, 0.51926977687626774, 0.51821862348178138, 0.51717171717171717,
+	 0.5161290322580645, 0.51509054325955739, 0.51405622489959835, 0.51302605210420837,
+	 0.51200000000000001, 0.51097804391217561, 0.50996015936254979, 0.50894632206759438,
+	 0.50793650793650791, 0.50693069306930694, 0.50592885375494068, 0.50493096646942803,
+	 0.50393700787401574, 0.50294695481335949, 0.50196078431372548, 0.50097847358121328,
+};
+
@@ -726,7 +726,7 @@ int libxmp_scan_sequences(struct context_data *ctx)
 	int seq;
 	unsigned char temp_ep[XMP_MAX_MOD_LENGTH];
 
-	s = (struct scan_data *) realloc(p->scan, MAX(1, mod->len) * sizeof(struct scan_data));
+	s = (struct scan_data *) libxmp_realloc(m, p->scan, MAX(1, mod->len) * sizeof(struct scan_data));
 	if (!s) {
 		D_(D_CRIT "failed to allocate scan data");
 		return -1;
@@ -776,7 +776,7 @@ int libxmp_scan_sequences(struct context_data *ctx)
 	}
 
 	if (seq < mod->len) {
-		s = (struct scan_data *) realloc(p->scan, seq * sizeof(struct scan_data));
+		s = (struct scan_data *) libxmp_realloc(m, p->scan, seq * sizeof(struct scan_data));
 		if (s != NULL) {
 			p->scan = s;
 		}
@@ -814,3 +814,24 @@ int libxmp_scan_sequences(struct context_data *ctx)
 
 	return 0;
 }
+
+/* Scan the module if the scan was deferred when loading it. The scan
+ * data is released if the scan fails, so the module is scanned again and
+ * the error is reported on every call. */
+int libxmp_deferred_scan(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+
+	if (p->scan != NULL) {
+		return 0;
+	}
+
+	if (libxmp_scan_sequences(ctx) < 0) {
+		libxmp_free(m, p->scan);
+		p->scan = NULL;
+		return -1;
+	}
+
+	return 0;
+}
@@ -198,6 +198,7 @@ int xmp_start_smix(xmp_context opaque, int chn, int smp)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct smix_data *smix = &ctx->smix;
+	struct module_data *m = &ctx->m;
 	int smp_alloc;
 
 	if (ctx->state > XMP_STATE_LOADED) {
@@ -217,11 +218,11 @@ int xmp_start_smix(xmp_context opaque, int chn, int smp)
 	 * but do not allow usage of the extra sample. */
 	smp_alloc = MAX(smp, 1);
 
-	smix->xxi = (struct xmp_instrument *) calloc(smp_alloc, sizeof(struct xmp_instrument));
+	smix->xxi = (struct xmp_instrument *) libxmp_calloc(m, smp_alloc, sizeof(struct xmp_instrument));
 	if (smix->xxi == NULL) {
 		goto err;
 	}
-	smix->xxs = (struct xmp_sample *) calloc(smp_alloc, sizeof(struct xmp_sample));
+	smix->xxs = (struct xmp_sample *) libxmp_calloc(m, smp_alloc, sizeof(struct xmp_sample));
 	if (smix->xxs == NULL) {
 		goto err1;
 	}
@@ -232,7 +233,7 @@ int xmp_start_smix(xmp_context opaque, int chn, int smp)
 	return 0;
 
     err1:
-	free(smix->xxi);
+	libxmp_free(m, smix->xxi);
 	smix->xxi = NULL;
     err:
 	return -XMP_ERROR_INTERNAL;
@@ -352,7 +353,7 @@ int xmp_smix_load_sample(xmp_context opaque, int num, const char *path)
 
 	/* Init instrument */
 
-	xxi->sub = (struct xmp_subinstrument *) calloc(1, sizeof(struct xmp_subinstrument));
+	xxi->sub = (struct xmp_subinstrument *) libxmp_calloc(m, 1, sizeof(struct xmp_subinstrument));
 	if (xxi->sub == NULL) {
 		hio_close(h);
 		return -XMP_ERROR_SYSTEM;
@@ -369,7 +370,7 @@ int xmp_smix_load_sample(xmp_context opaque, int num, const char *path)
 	retval = libxmp_load_wav_sample(m, xxs, &wav, h);
 	hio_close(h);
 	if (retval != 0) {
-		free(xxi->sub);
+		libxmp_free(m, xxi->sub);
 		xxi->sub = NULL;
 		return retval;
 	}
@@ -384,6 +385,7 @@ int xmp_smix_release_sample(xmp_context opaque, int num)
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct smix_data *smix = &ctx->smix;
 	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
 	struct xmp_instrument *xxi;
 	struct xmp_sample *xxs;
 	int i;
@@ -405,8 +407,8 @@ int xmp_smix_release_sample(xmp_context opaque, int num)
 		}
 	}
 
-	libxmp_free_sample(xxs);
-	free(xxi->sub);
+	libxmp_free_sample(m, xxs);
+	libxmp_free(m, xxi->sub);
 
 	xxs->data = NULL;
 	xxi->sub = NULL;
@@ -418,6 +420,7 @@ void xmp_end_smix(xmp_context opaque)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct smix_data *smix = &ctx->smix;
+	struct module_data *m = &ctx->m;
 	int i;
 
 	if (smix->xxs == NULL) {
@@ -428,8 +431,8 @@ void xmp_end_smix(xmp_context opaque)
 		xmp_smix_release_sample(opaque, i);
 	}
 
-	free(smix->xxs);
-	free(smix->xxi);
+	libxmp_free(m, smix->xxs);
+	libxmp_free(m, smix->xxi);
 	smix->xxs = NULL;
 	smix->xxi = NULL;
 	smix->chn = 0;
@@ -31,6 +31,135 @@
 
 #define	FREE	-1
 
+/* Voice allocation
+ *
+ * A new note takes the free voice with the lowest number. If all voices
+ * are in use, the background voice (a voice left playing in a virtual
+ * channel by a new note action) with the lowest volume is stolen, or the
+ * lowest numbered one if several voices have the same volume. Free voices
+ * and background voices are kept in binary heaps with these orderings, so
+ * we don't need to scan all voices for each new note.
+ */
+
+static void free_push(struct virt_control *v, int voc)
+{
+	int i = v->num_free++;
+	int parent;
+
+	while (i > 0 && voc < v->free_voice[parent = (i - 1) / 2]) {
+		v->free_voice[i] = v->free_voice[parent];
+		i = parent;
+	}
+	v->free_voice[i] = voc;
+}
+
+static int free_pop(struct virt_control *v)
+{
+	int voc = v->free_voice[0];
+	int last = v->free_voice[--v->num_free];
+	int i = 0, child;
+
+	while ((child = 2 * i + 1) < v->num_free) {
+		if (child + 1 < v->num_free &&
+		    v->free_voice[child + 1] < v->free_voice[child]) {
+			child++;
+		}
+		if (last < v->free_voice[child]) {
+			break;
+		}
+		v->free_voice[i] = v->free_voice[child];
+		i = child;
+	}
+	v->free_voice[i] = last;
+
+	return voc;
+}
+
+static int bg_before(struct virt_control *v, int a, int b)
+{
+	int vol_a = v->voice_array[a].vol;
+	int vol_b = v->voice_array[b].vol;
+
+	return vol_a < vol_b || (vol_a == vol_b && a < b);
+}
+
+static void bg_set(struct virt_control *v, int i, int voc)
+{
+	v->bg_voice[i] = voc;
+	v->bg_pos[voc] = i;
+}
+
+/* Move the voice at position i up or down to its place in the heap */
+static void bg_sift(struct virt_control *v, int i)
+{
+	int voc = v->bg_voice[i];
+	int parent, child;
+
+	while (i > 0 && bg_before(v, voc, v->bg_voice[parent = (i - 1) / 2])) {
+		bg_set(v, i, v->bg_voice[parent]);
+		i = parent;
+	}
+
+	while ((child = 2 * i + 1) < v->num_bg) {
+		if (child + 1 < v->num_bg &&
+		    bg_before(v, v->bg_voice[child + 1], v->bg_voice[child])) {
+			child++;
+		}
+		if (!bg_before(v, v->bg_voice[child], voc)) {
+			break;
+		}
+		bg_set(v, i, v->bg_voice[child]);
+		i = child;
+	}
+
+	bg_set(v, i, voc);
+}
+
+static void bg_remove(struct virt_control *v, int voc)
+{
+	int i = v->bg_pos[voc];
+	int last = v->bg_voice[--v->num_bg];
+
+	v->bg_pos[voc] = -1;
+	if (i < v->num_bg) {
+		bg_set(v, i, last);
+		bg_sift(v, i);
+	}
+}
+
+/* Update the background voice heap after the voice channel or volume
+ * has changed */
+static void update_voice(struct virt_control *v, int voc)
+{
+	int i = v->bg_pos[voc];
+
+	if (v->voice_array[voc].chn >= v->num_tracks) {
+		if (i < 0) {
+			i = v->num_bg++;
+			v->bg_voice[i] = voc;
+		}
+		bg_sift(v, i);
+	} else if (i >= 0) {
+		bg_remove(v, voc);
+	}
+}
+
+static void build_heaps(struct virt_control *v)
+{
+	int i;
+
+	v->num_free = v->num_bg = 0;
+
+	for (i = 0; i < v->maxvoc; i++) {
+		v->bg_pos[i] = -1;
+		if (v->voice_array[i].chn == FREE) {
+			free_push(v, i);
+		} else {
+			update_voice(v, i);
+		}
+	}
+}
+
 
 /* Get parent channel */
 int libxmp_virt_getroot(struct context_data *ctx, int chn)
@@ -93,9 +222,22 @@ void libxmp_virt_resetvoice(struct context_data *ctx, int voc, int mute)
 	p->virt.virt_channel[vi->root].count--;
 	p->virt.virt_channel[vi->chn].map = FREE;
 
+	if (p->virt.bg_pos[voc] >= 0) {
+		bg_remove(&p->virt, voc);
+	}
+	if (vi->chn != FREE) {
+		free_push(&p->virt, voc);
+	}
+
 	do_virt_resetvoice(vi);
 }
 
+/* Rebuild the voice allocation heaps after the voices were replaced */
+void libxmp_virt_rebuild(struct context_data *ctx)
+{
+	build_heaps(&ctx->p.virt);
+}
+
 /* virt_on (number of tracks) */
 int libxmp_virt_on(struct context_data *ctx, int num)
 {
@@ -116,7 +258,7 @@ int libxmp_virt_on(struct context_data *ctx, int num)
 
 	p->virt.maxvoc = libxmp_mixer_numvoices(ctx, num);
 
-	p->virt.voice_array = (struct mixer_voice *) calloc(p->virt.maxvoc,
+	p->virt.voice_array = (struct mixer_voice *) libxmp_calloc(m, p->virt.maxvoc,
 						sizeof(struct mixer_voice));
 	if (p->virt.voice_array == NULL)
 		goto err;
@@ -130,7 +272,7 @@ int libxmp_virt_on(struct context_data *ctx, int num)
 	/* Initialize Paula simulator */
 	if (IS_AMIGA_MOD()) {
 		for (i = 0; i < p->virt.maxvoc; i++) {
-			p->virt.voice_array[i].paula = (struct paula_state *) calloc(1, sizeof(struct paula_state));
+			p->virt.voice_array[i].paula = (struct paula_state *) libxmp_calloc(m, 1, sizeof(struct paula_state));
 			if (p->virt.voice_array[i].paula == NULL) {
 				goto err2;
 			}
@@ -139,7 +281,7 @@ int libxmp_virt_on(struct context_data *ctx, int num)
 	}
 #endif
 
-	p->virt.virt_channel = (struct virt_channel *) malloc(p->virt.virt_channels *
+	p->virt.virt_channel = (struct virt_channel *) libxmp_malloc(m, p->virt.virt_channels *
 							sizeof(struct virt_channel));
 	if (p->virt.virt_channel == NULL)
 		goto err2;
@@ -149,19 +291,32 @@ int libxmp_virt_on(struct context_data *ctx, int num)
 		p->virt.virt_channel[i].count = 0;
 	}
 
+	p->virt.free_voice = (int *) libxmp_malloc(m, 3 * p->virt.maxvoc *
+							sizeof(int));
+	if (p->virt.free_voice == NULL)
+		goto err3;
+
+	p->virt.bg_voice = p->virt.free_voice + p->virt.maxvoc;
+	p->virt.bg_pos = p->virt.bg_voice + p->virt.maxvoc;
+	build_heaps(&p->virt);
+
 	p->virt.virt_used = 0;
+	p->virt.culled = 0;
 
 	return 0;
 
+      err3:
+	libxmp_free(m, p->virt.virt_channel);
+	p->virt.virt_channel = NULL;
       err2:
 #ifdef LIBXMP_PAULA_SIMULATOR
 	if (IS_AMIGA_MOD()) {
 		for (i = 0; i < p->virt.maxvoc; i++) {
-			free(p->virt.voice_array[i].paula);
+			libxmp_free(m, p->virt.voice_array[i].paula);
 		}
 	}
 #endif
-	free(p->virt.voice_array);
+	libxmp_free(m, p->virt.voice_array);
 	p->virt.voice_array = NULL;
       err:
 	return -1;
@@ -170,6 +325,7 @@ int libxmp_virt_on(struct context_data *ctx, int num)
 void libxmp_virt_off(struct context_data *ctx)
 {
 	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
 #ifdef LIBXMP_PAULA_SIMULATOR
 	int i;
 #endif
@@ -178,7 +334,7 @@ void libxmp_virt_off(struct context_data *ctx)
 	/* Free Paula simulator state */
 	/* Player type may have been changed; always free this. */
 	for (i = 0; i < p->virt.maxvoc; i++) {
-		free(p->virt.voice_array[i].paula);
+		libxmp_free(m, p->virt.voice_array[i].paula);
 	}
 #endif
 
@@ -186,10 +342,15 @@ void libxmp_virt_off(struct context_data *ctx)
 	p->virt.virt_channels = 0;
 	p->virt.num_tracks = 0;
 
-	free(p->virt.voice_array);
-	free(p->virt.virt_channel);
+	libxmp_free(m, p->virt.voice_array);
+	libxmp_free(m, p->virt.virt_channel);
+	libxmp_free(m, p->virt.free_voice);
 	p->virt.voice_array = NULL;
 	p->virt.virt_channel = NULL;
+	p->virt.free_voice = NULL;
+	p->virt.bg_voice = NULL;
+	p->virt.bg_pos = NULL;
+	p->virt.num_free = p->virt.num_bg = 0;
 }
 
 void libxmp_virt_reset(struct context_data *ctx)
@@ -217,25 +378,18 @@ void libxmp_virt_reset(struct context_data *ctx)
 		p->virt.virt_channel[i].count = 0;
 	}
 
+	build_heaps(&p->virt);
+
 	p->virt.virt_used = 0;
 }
 
 static int free_voice(struct context_data *ctx)
 {
 	struct player_data *p = &ctx->p;
-	int i, num, vol;
-
-	/* Find background voice with lowest volume*/
-	num = FREE;
-	vol = INT_MAX;
-	for (i = 0; i < p->virt.maxvoc; i++) {
-		struct mixer_voice *vi = &p->virt.voice_array[i];
+	int num;
 
-		if (vi->chn >= p->virt.num_tracks && vi->vol < vol) {
-			num = i;
-			vol = vi->vol;
-		}
-	}
+	/* Find background voice with lowest volume */
+	num = p->virt.num_bg > 0 ? p->virt.bg_voice[0] : FREE;
 
 	/* Free voice */
 	if (num >= 0) {
@@ -253,13 +407,9 @@ static int alloc_voice(struct context_data *ctx, int chn)
 	int i;
 
 	/* Find free voice */
-	for (i = 0; i < p->virt.maxvoc; i++) {
-		if (p->virt.voice_array[i].chn == FREE)
-			break;
-	}
-
-	/* not found */
-	if (i == p->virt.maxvoc) {
+	if (p->virt.num_free > 0) {
+		i = free_pop(&p->virt);
+	} else {
 		i = free_voice(ctx);
 	}
 
@@ -270,6 +420,7 @@ static int alloc_voice(struct context_data *ctx, int chn)
 		p->virt.voice_array[i].chn = chn;
 		p->virt.voice_array[i].root = chn;
 		p->virt.virt_channel[chn].map = i;
+		update_voice(&p->virt, i);
 	}
 
 	return i;
@@ -309,7 +460,7 @@ void libxmp_virt_resetchannel(struct context_data *ctx, int chn)
 void libxmp_virt_setvol(struct context_data *ctx, int chn, int vol)
 {
 	struct player_data *p = &ctx->p;
-	int voc, root;
+	int voc, root, changed;
 
 	if ((voc = map_virt_channel(p, chn)) < 0) {
 		return;
@@ -320,8 +471,13 @@ void libxmp_virt_setvol(struct context_data *ctx, int chn, int vol)
 		vol = 0;
 	}
 
+	changed = p->virt.voice_array[voc].vol != vol;
 	libxmp_mixer_setvol(ctx, voc, vol);
 
+	if (changed && p->virt.bg_pos[voc] >= 0) {
+		bg_sift(&p->virt, p->virt.bg_pos[voc]);
+	}
+
 	if (vol == 0 && chn >= p->virt.num_tracks) {
 		libxmp_virt_resetvoice(ctx, voc, 1);
 	}
@@ -408,6 +564,7 @@ void libxmp_virt_setsmp(struct context_data *ctx, int chn, int smp)
 	pos = libxmp_mixer_getvoicepos(ctx, voc);
 	libxmp_mixer_setpatch(ctx, voc, smp, 0);
 	libxmp_mixer_voicepos(ctx, voc, pos, 0);	/* Restore old position */
+	update_voice(&p->virt, voc);
 }
 
 #endif
@@ -520,6 +677,7 @@ int libxmp_virt_setpatch(struct context_data *ctx, int chn, int ins, int smp,
 
 			p->virt.voice_array[voc].chn = --chn;
 			p->virt.virt_channel[chn].map = voc;
+			update_voice(&p->virt, voc);
 			voc = vfree;
 		}
 	} else {
@@ -536,6 +694,7 @@ int libxmp_virt_setpatch(struct context_data *ctx, int chn, int ins, int smp,
 
 	libxmp_mixer_setpatch(ctx, voc, smp, 1);
 	libxmp_mixer_setnote(ctx, voc, note);
+	update_voice(&p->virt, voc);
 	p->virt.voice_array[voc].ins = ins;
 	p->virt.voice_array[voc].act = nna;
 	p->virt.voice_array[voc].key = key;
@@ -643,3 +802,74 @@ int libxmp_virt_cstat(struct context_data *ctx, int chn)
 
 	return p->virt.voice_array[voc].act;
 }
+
+/* Volume of a voice as used by the mixer */
+static int mix_volume(struct context_data *ctx, int voc)
+{
+	struct module_data *m = &ctx->m;
+	int vol = ctx->p.virt.voice_array[voc].vol;
+
+	if (m->mvolbase > 0 && m->mvol != m->mvolbase) {
+		vol = vol * m->mvol / m->mvolbase;
+	}
+
+	return vol;
+}
+
+/* Find the voice with the lowest priority. Background voices have lower
+ * priority than voices playing in module channels, and quieter voices
+ * have lower priority than louder ones.
+ */
+static int lowest_priority_voice(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	int i, num, vol;
+
+	if (p->virt.num_bg > 0) {
+		return p->virt.bg_voice[0];
+	}
+
+	num = FREE;
+	vol = INT_MAX;
+	for (i = 0; i < p->virt.maxvoc; i++) {
+		struct mixer_voice *vi = &p->virt.voice_array[i];
+
+		if (vi->chn != FREE && vi->vol < vol) {
+			num = i;
+			vol = vi->vol;
+		}
+	}
+
+	return num;
+}
+
+/* Stop background voices that became inaudible, and the voices with the
+ * lowest priority if more voices are in use than the voice budget allows.
+ */
+void libxmp_virt_cull(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	int voc;
+
+	if (s->cull_vol > 0) {
+		while (p->virt.num_bg > 0) {
+			voc = p->virt.bg_voice[0];
+			if (mix_volume(ctx, voc) >= s->cull_vol) {
+				break;
+			}
+			libxmp_virt_resetvoice(ctx, voc, 1);
+			p->virt.culled++;
+		}
+	}
+
+	if (s->voice_budget > 0) {
+		while (p->virt.virt_used > s->voice_budget) {
+			if ((voc = lowest_priority_voice(ctx)) < 0) {
+				break;
+			}
+			libxmp_virt_resetvoice(ctx, voc, 1);
+			p->virt.culled++;
+		}
+	}
+}
@@ -35,6 +35,8 @@ int	libxmp_virt_mapchannel	(struct context_data *, int);
 void	libxmp_virt_resetchannel(struct context_data *, int);
 void	libxmp_virt_resetvoice	(struct context_data *, int, int);
 void	libxmp_virt_reset	(struct context_data *);
+void	libxmp_virt_rebuild	(struct context_data *);
+void	libxmp_virt_cull	(struct context_data *);
 void	libxmp_virt_release	(struct context_data *, int, int);
 void	libxmp_virt_reverse	(struct context_data *, int, int);
 int	libxmp_virt_getroot	(struct context_data *, int);
@@ -26,10 +26,10 @@ void create_simple_module(struct context_data *ctx, int ins, int pat)
 	mod->xxo[0] = 0;
 	mod->xxo[1] = 1;
 
-	libxmp_init_pattern(mod);
+	libxmp_init_pattern(m);
 
 	for (i = 0; i < mod->pat; i++) {
-		libxmp_alloc_pattern_tracks(mod, i, 64);
+		libxmp_alloc_pattern_tracks(m, i, 64);
 	}
 
 	libxmp_init_instrument(m);
@@ -40,7 +40,7 @@ void create_simple_module(struct context_data *ctx, int ins, int pat)
 		/* Give each instrument two subinstruments mapped to the
 		 * same sample. By default, only the first will be used. */
 		xxi->nsm = 2;
-		libxmp_alloc_subinstrument(mod, i, 2);
+		libxmp_alloc_subinstrument(m, i, 2);
 
 		for (j = 0; j < xxi->nsm; j++) {
 			sub = &xxi->sub[j];
@@ -0,0 +1,130 @@
+#include "test.h"
+#include "../src/loaders/loader.h"
+
+#define REFBUF_SIZE	72000
+#define NUM		(REFBUF_SIZE / 2 / 4)
+
+static short buffer[NUM];
+
+static xmp_context create_player(void)
+{
+	xmp_context opaque;
+	int ret;
+
+	opaque = xmp_create_context();
+	fail_unless(opaque != NULL, "can't create context");
+	ret = xmp_load_module(opaque, "data/storlek_03.it");
+	fail_unless(ret == 0, "module load error");
+	xmp_start_player(opaque, 8000, XMP_FORMAT_MONO);
+	xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_LINEAR);
+
+	return opaque;
+}
+
+static void destroy_player(xmp_context opaque)
+{
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+
+static int max_diff(const short *a, const short *b, int num)
+{
+	int i, max = 0;
+
+	for (i = 0; i < num; i++) {
+		int d = abs(a[i] - b[i]);
+		if (d > max)
+			max = d;
+	}
+
+	return max;
+}
+
+TEST(test_api_bus)
+{
+	xmp_bus bus;
+	xmp_context c1, c2;
+	FILE *f;
+	int i, ret;
+	short *ref;
+
+	f = fopen("data/pcm_buffer.raw", "rb");
+	ref = (short *) calloc(1, REFBUF_SIZE);
+	fail_unless(ref != NULL, "buffer allocation error");
+
+	ret = fread(ref, 1, REFBUF_SIZE, f);
+	fail_unless(ret > 0, "read error");
+	if (is_big_endian()) {
+		convert_endian((unsigned char *)ref, REFBUF_SIZE / 2);
+	}
+
+	bus = xmp_create_bus(1000, XMP_FORMAT_MONO);
+	fail_unless(bus == NULL, "invalid rate");
+	bus = xmp_create_bus(8000, XMP_FORMAT_MONO);
+	fail_unless(bus != NULL, "can't create bus");
+
+	/* One context at full gain renders the same as the player */
+	c1 = create_player();
+	ret = xmp_bus_attach(bus, c1, 100);
+	fail_unless(ret == 0, "can't attach context");
+	ret = xmp_bus_attach(bus, c1, 100);
+	fail_unless(ret == -XMP_ERROR_INVALID, "context attached twice");
+
+	for (i = 0; i < 4; i++) {
+		xmp_bus_render(bus, buffer, NUM / 4);
+	}
+	xmp_bus_render(bus, buffer, 0);
+	fail_unless(memcmp(buffer, ref + NUM / 4 * 3, NUM / 4 * 2) == 0,
+		    "single context output");
+
+	/* Two contexts at half gain */
+	xmp_start_player(c1, 8000, XMP_FORMAT_MONO);
+	c2 = create_player();
+	xmp_bus_set_gain(bus, c1, 50, 0);
+	ret = xmp_bus_attach(bus, c2, 50);
+	fail_unless(ret == 0, "can't attach context");
+	xmp_bus_render(bus, buffer, NUM);
+	fail_unless(memcmp(buffer, ref, NUM * 2) == 0, "two context output");
+
+	/* Crossfade between the two contexts */
+	xmp_start_player(c1, 8000, XMP_FORMAT_MONO);
+	xmp_start_player(c2, 8000, XMP_FORMAT_MONO);
+	xmp_bus_set_gain(bus, c1, 100, 0);
+	xmp_bus_set_gain(bus, c2, 0, 0);
+	ret = xmp_bus_set_gain(bus, c1, 0, 4096);
+	fail_unless(ret == 0, "can't set gain");
+	ret = xmp_bus_set_gain(bus, c2, 100, 4096);
+	fail_unless(ret == 0, "can't set gain");
+	xmp_bus_render(bus, buffer, NUM);
+	fail_unless(max_diff(buffer, ref, NUM) <= 1, "crossfade output");
+
+	/* Invalid parameters */
+	ret = xmp_bus_set_gain(bus, c1, 101, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid gain");
+	ret = xmp_bus_set_gain(bus, c1, 100, -1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid fade");
+	ret = xmp_bus_render(bus, buffer, -1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid size");
+
+	/* Detached and stopped contexts are silent */
+	ret = xmp_bus_detach(bus, c2);
+	fail_unless(ret == 0, "can't detach context");
+	ret = xmp_bus_detach(bus, c2);
+	fail_unless(ret == -XMP_ERROR_INVALID, "context detached twice");
+	ret = xmp_bus_set_gain(bus, c2, 100, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "context not attached");
+	xmp_end_player(c1);
+	memset(buffer, 0x55, sizeof(buffer));
+	xmp_bus_render(bus, buffer, 100);
+	for (i = 0; i < 100; i++) {
+		fail_unless(buffer[i] == 0, "not silent");
+	}
+
+	xmp_free_bus(bus);
+	destroy_player(c1);
+	destroy_player(c2);
+	free(ref);
+	fclose(f);
+}
+END_TEST
@@ -0,0 +1,121 @@
+#include "test.h"
+#include "../src/mixer.h"
+#include "../src/virtual.h"
+
+static void create_module(struct context_data *ctx, int nna)
+{
+	int i, j;
+
+	create_simple_module(ctx, 2, 2);
+	set_instrument_nna(ctx, 0, 0, nna, XMP_INST_DCT_OFF, XMP_INST_DCA_CUT);
+	set_instrument_fadeout(ctx, 0, 0x400);
+
+	for (i = 0; i < 64; i++) {
+		for (j = 0; j < 4; j++) {
+			new_event(ctx, 0, i, j, 60, 1, 0, 0, 0, 0, 0);
+		}
+	}
+	set_quirk(ctx, QUIRKS_IT, READ_EVENT_IT);
+}
+
+TEST(test_api_cull_voices)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct player_data *p;
+	struct xmp_frame_info fi;
+	int i, voc, ret, max_used;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+	p = &ctx->p;
+
+	/* Parameters */
+	ret = xmp_get_player(opaque, XMP_PLAYER_CULL_VOLUME);
+	fail_unless(ret == 0, "default culling volume");
+	ret = xmp_get_player(opaque, XMP_PLAYER_VOICE_BUDGET);
+	fail_unless(ret == 0, "default voice budget");
+	ret = xmp_set_player(opaque, XMP_PLAYER_CULL_VOLUME, -1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid culling volume");
+	ret = xmp_set_player(opaque, XMP_PLAYER_CULL_VOLUME, 1025);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid culling volume");
+	ret = xmp_set_player(opaque, XMP_PLAYER_VOICE_BUDGET, -1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid voice budget");
+	ret = xmp_get_player(opaque, XMP_PLAYER_CULLED);
+	fail_unless(ret == -XMP_ERROR_STATE, "culled voices before playing");
+
+	/* Fading background voices */
+	create_module(ctx, XMP_INST_NNA_FADE);
+	xmp_start_player(opaque, 44100, 0);
+
+	max_used = 0;
+	for (i = 0; i < 64 * 6; i++) {
+		xmp_play_frame(opaque);
+		xmp_get_frame_info(opaque, &fi);
+		if (fi.virt_used > max_used)
+			max_used = fi.virt_used;
+	}
+	ret = xmp_get_player(opaque, XMP_PLAYER_CULLED);
+	fail_unless(ret == 0, "voices culled when disabled");
+
+	/* Fading voices are stopped when below the culling volume */
+	xmp_start_player(opaque, 44100, 0);
+	ret = xmp_set_player(opaque, XMP_PLAYER_CULL_VOLUME, 256);
+	fail_unless(ret == 0, "can't set culling volume");
+
+	for (i = 0; i < 64 * 6; i++) {
+		xmp_play_frame(opaque);
+		xmp_get_frame_info(opaque, &fi);
+		fail_unless(fi.virt_used < max_used, "voices not culled");
+		if (p->virt.num_bg > 0) {
+			voc = p->virt.bg_voice[0];
+			fail_unless(p->virt.voice_array[voc].vol >= 256,
+				    "inaudible voice not culled");
+		}
+	}
+	ret = xmp_get_player(opaque, XMP_PLAYER_CULLED);
+	fail_unless(ret > 0, "culled voices not counted");
+
+	ret = xmp_set_player(opaque, XMP_PLAYER_CULLED, 0);
+	fail_unless(ret < 0, "culled voices count is read only");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+
+	/* Voice budget with background voices that keep playing */
+	create_module(ctx, XMP_INST_NNA_CONT);
+	xmp_start_player(opaque, 44100, 0);
+	ret = xmp_set_player(opaque, XMP_PLAYER_VOICE_BUDGET, 10);
+	fail_unless(ret == 0, "can't set voice budget");
+
+	for (i = 0; i < 64 * 6; i++) {
+		xmp_play_frame(opaque);
+		xmp_get_frame_info(opaque, &fi);
+		fail_unless(fi.virt_used <= 10, "voice budget exceeded");
+
+		/* Voices in module channels are kept */
+		if (i % 6 == 0) {
+			fail_unless(map_channel(p, 0) >= 0, "channel 0 culled");
+			fail_unless(map_channel(p, 3) >= 0, "channel 3 culled");
+		}
+	}
+	ret = xmp_get_player(opaque, XMP_PLAYER_CULLED);
+	fail_unless(ret == 63 * 4 - 6, "wrong number of culled voices");
+
+	/* Module channel voices are culled if the budget is too small */
+	ret = xmp_set_player(opaque, XMP_PLAYER_VOICE_BUDGET, 2);
+	fail_unless(ret == 0, "can't set voice budget");
+	xmp_play_frame(opaque);
+	xmp_get_frame_info(opaque, &fi);
+	fail_unless(fi.virt_used == 2, "voice budget exceeded");
+
+	/* Culled count is reset when the player starts */
+	xmp_start_player(opaque, 44100, 0);
+	ret = xmp_get_player(opaque, XMP_PLAYER_CULLED);
+	fail_unless(ret == 0, "culled voices not reset");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+END_TEST
@@ -0,0 +1,101 @@
+#include "test.h"
+
+static int sample_size(const struct xmp_sample *xxs)
+{
+	int size = xxs->len;
+
+	if (xxs->flg & XMP_SAMPLE_16BIT)
+		size *= 2;
+	if (xxs->flg & XMP_SAMPLE_STEREO)
+		size *= 2;
+
+	return size;
+}
+
+/* Load a module with and without XMP_SMPCTL_LAZY, decode all deferred
+ * samples and compare them with the samples decoded at load time. */
+static int compare_lazy(const char *path)
+{
+	xmp_context c1, c2;
+	struct xmp_module_info info1, info2;
+	int i, ret1, ret2, deferred = 0;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+	fail_unless(c1 != NULL && c2 != NULL, "can't create context");
+
+	xmp_set_player(c2, XMP_PLAYER_SMPCTL, XMP_SMPCTL_LAZY);
+
+	ret1 = xmp_load_module(c1, path);
+	ret2 = xmp_load_module(c2, path);
+	fail_unless(ret1 == ret2, "load result mismatch");
+	if (ret1 < 0) {
+		xmp_free_context(c1);
+		xmp_free_context(c2);
+		return 0;
+	}
+
+	xmp_get_module_info(c1, &info1);
+	xmp_get_module_info(c2, &info2);
+	fail_unless(info1.mod->smp == info2.mod->smp, "sample count mismatch");
+
+	for (i = 0; i < info2.mod->smp; i++) {
+		struct xmp_sample *xxs1 = &info1.mod->xxs[i];
+		struct xmp_sample *xxs2 = &info2.mod->xxs[i];
+
+		if (xxs1->data != NULL && xxs2->data == NULL) {
+			deferred++;
+		}
+
+		fail_unless(xmp_decode_sample(c2, i) == 0, "can't decode sample");
+		/* Decoding again does nothing */
+		fail_unless(xmp_decode_sample(c2, i) == 0, "can't decode sample again");
+
+		fail_unless(xxs1->len == xxs2->len, "length mismatch");
+		fail_unless(xxs1->lps == xxs2->lps, "loop start mismatch");
+		fail_unless(xxs1->lpe == xxs2->lpe, "loop end mismatch");
+		fail_unless(xxs1->flg == xxs2->flg, "flags mismatch");
+		fail_unless((xxs1->data == NULL) == (xxs2->data == NULL), "data mismatch");
+		if (xxs1->data != NULL) {
+			fail_unless(memcmp(xxs1->data, xxs2->data,
+				    sample_size(xxs1)) == 0, "sample data mismatch");
+		}
+	}
+
+	fail_unless(xmp_decode_sample(c2, -1) == -XMP_ERROR_INVALID,
+		    "invalid sample number accepted");
+	fail_unless(xmp_decode_sample(c2, info2.mod->smp) == -XMP_ERROR_INVALID,
+		    "invalid sample number accepted");
+
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+	fail_unless(xmp_decode_sample(c2, 0) == -XMP_ERROR_STATE,
+		    "decoded sample without module");
+
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+
+	return deferred;
+}
+
+TEST(test_api_decode_sample)
+{
+	int ret;
+
+	/* 8-bit, IT 2.14 and 2.15 compression */
+	ret = compare_lazy("data/m/4th_Symmetriad.it");
+	fail_unless(ret == 17, "samples not deferred (8-bit)");
+
+	/* 16-bit and stereo */
+	ret = compare_lazy("data/stereo.it");
+	fail_unless(ret == 2, "samples not deferred (stereo)");
+	ret = compare_lazy("data/test.it");
+	fail_unless(ret == 4, "samples not deferred (16-bit)");
+
+	/* Truncated or corrupted compressed data is decoded at load time */
+	compare_lazy("data/f/load_it_invalid_compressed.it");
+	compare_lazy("data/f/load_it_invalid_compressed2.it");
+	compare_lazy("data/f/load_it_invalid_compressed3.it");
+	compare_lazy("data/f/load_it_invalid_compressed4.it");
+}
+END_TEST
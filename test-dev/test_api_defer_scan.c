@@ -0,0 +1,92 @@
+#include "test.h"
+
+TEST(test_api_defer_scan)
+{
+	xmp_context opaque, opaque2;
+	struct context_data *ctx;
+	struct xmp_module_info mi, mi2;
+	struct xmp_frame_info fi, fi2;
+	unsigned char xxo[XMP_MAX_MOD_LENGTH];
+	int ret, i;
+
+	opaque = xmp_create_context();
+	opaque2 = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+
+	ret = xmp_get_player(opaque, XMP_PLAYER_DEFER_SCAN);
+	fail_unless(ret == 0, "scan deferred by default");
+	ret = xmp_set_player(opaque, XMP_PLAYER_DEFER_SCAN, 1);
+	fail_unless(ret == 0, "can't defer scan");
+	ret = xmp_get_player(opaque, XMP_PLAYER_DEFER_SCAN);
+	fail_unless(ret == 1, "scan not deferred");
+
+	ret = xmp_load_module(opaque, "data/scan_240_seq.it");
+	fail_unless(ret == 0, "load error");
+	ret = xmp_load_module(opaque2, "data/scan_240_seq.it");
+	fail_unless(ret == 0, "load error");
+	fail_unless(ctx->p.scan == NULL, "module scanned when loading");
+
+	ret = xmp_set_player(opaque, XMP_PLAYER_DEFER_SCAN, 0);
+	fail_unless(ret == -XMP_ERROR_STATE, "can change after loading");
+
+	/* Getting module info runs the scan */
+	xmp_get_module_info(opaque, &mi);
+	xmp_get_module_info(opaque2, &mi2);
+	fail_unless(ctx->p.scan != NULL, "module not scanned");
+	fail_unless(mi.num_sequences == mi2.num_sequences, "sequences");
+	for (i = 0; i < mi.num_sequences; i++) {
+		fail_unless(mi.seq_data[i].entry_point ==
+			    mi2.seq_data[i].entry_point, "entry point");
+		fail_unless(mi.seq_data[i].duration ==
+			    mi2.seq_data[i].duration, "duration");
+	}
+	xmp_release_module(opaque);
+
+	/* Starting the player runs the scan */
+	ret = xmp_load_module(opaque, "data/scan_240_seq.it");
+	fail_unless(ret == 0, "load error");
+	fail_unless(ctx->p.scan == NULL, "module scanned when loading");
+	ret = xmp_start_player(opaque, 44100, 0);
+	fail_unless(ret == 0, "can't start player");
+	xmp_start_player(opaque2, 44100, 0);
+	for (i = 0; i < 100; i++) {
+		xmp_play_frame(opaque);
+		xmp_play_frame(opaque2);
+		xmp_get_frame_info(opaque, &fi);
+		xmp_get_frame_info(opaque2, &fi2);
+		fail_unless(fi.total_time == fi2.total_time, "total time");
+		fail_unless(fi.pos == fi2.pos && fi.row == fi2.row, "position");
+	}
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+
+	/* A failed scan is reported on every call */
+	ret = xmp_load_module(opaque, "data/scan_240_seq.it");
+	fail_unless(ret == 0, "load error");
+	memcpy(xxo, ctx->m.mod.xxo, sizeof(xxo));
+	memset(ctx->m.mod.xxo, 0xfe, ctx->m.mod.len);
+	for (i = 0; i < 2; i++) {
+		xmp_get_module_info(opaque, &mi);
+		fail_unless(mi.num_sequences == 0, "sequences after failed scan");
+		fail_unless(ctx->p.scan == NULL, "failed scan kept");
+		memset(&fi, 0xff, sizeof(fi));
+		xmp_get_frame_info(opaque, &fi);
+		fail_unless(fi.total_time == 0 && fi.buffer == NULL,
+			    "frame info not cleared after failed scan");
+		ret = xmp_start_player(opaque, 44100, 0);
+		fail_unless(ret == -XMP_ERROR_LOAD, "failed scan not reported");
+	}
+	memcpy(ctx->m.mod.xxo, xxo, sizeof(xxo));
+	ret = xmp_start_player(opaque, 44100, 0);
+	fail_unless(ret == 0, "can't start player");
+	xmp_get_module_info(opaque, &mi);
+	fail_unless(mi.num_sequences == mi2.num_sequences, "sequences");
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+
+	xmp_free_context(opaque);
+	xmp_end_player(opaque2);
+	xmp_release_module(opaque2);
+	xmp_free_context(opaque2);
+}
+END_TEST
@@ -0,0 +1,170 @@
+#include "../src/common.h"
+#include "../src/effects.h"
+#include "../src/player.h"
+#include "test.h"
+
+/* Return the first nonzero sample in the frame buffer, or -1 */
+static int first_sound(xmp_context opaque, int *size)
+{
+	struct xmp_frame_info fi;
+	short *b;
+	int i;
+
+	xmp_play_frame(opaque);
+	xmp_get_frame_info(opaque, &fi);
+
+	b = (short *)fi.buffer;
+	*size = fi.buffer_size / 2;
+	for (i = 0; i < *size; i++) {
+		if (b[i] != 0)
+			return i;
+	}
+
+	return -1;
+}
+
+static xmp_context create_slide_module(void)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+
+	create_simple_module(ctx, 2, 2);
+	set_instrument_envelope(ctx, 0, 0, 0, 64);
+	set_instrument_envelope(ctx, 0, 1, 64, 0);
+	new_event(ctx, 0, 0, 0, 60, 1, 0, FX_VOLSLIDE, 0x01, FX_GVOL_SLIDE, 0x01);
+	new_event(ctx, 0, 0, 1, 60, 1, 0, FX_VOLSLIDE, 0x01, 0, 0);
+
+	xmp_start_player(opaque, 44100, 0);
+
+	return opaque;
+}
+
+/* An event played in the middle of a tick must not advance the slides,
+ * envelopes or counters a second time in that tick. Compare with the
+ * same event injected at the start of the next tick.
+ */
+static void check_slides(void)
+{
+	xmp_context opaque, opaque2;
+	struct player_data *p, *p2;
+	struct xmp_event event = { 0, 0, 0, FX_VOLSLIDE, 0x02, FX_GVOL_SLIDE, 0x02, 0 };
+	int i, j;
+
+	opaque = create_slide_module();
+	opaque2 = create_slide_module();
+	p = &((struct context_data *)opaque)->p;
+	p2 = &((struct context_data *)opaque2)->p;
+
+	xmp_play_frame(opaque);
+	xmp_play_frame(opaque2);
+
+	xmp_inject_event_at(opaque, 1, &event, 100);
+	xmp_play_frame(opaque);
+	xmp_play_frame(opaque2);
+	fail_unless(p->gvol == p2->gvol, "global volume slid mid-tick");
+	fail_unless(p->xc_data[1].v_idx == p2->xc_data[1].v_idx,
+					"envelope advanced mid-tick");
+
+	xmp_inject_event(opaque2, 1, &event);
+	for (i = 0; i < 4; i++) {
+		xmp_play_frame(opaque);
+		xmp_play_frame(opaque2);
+		fail_unless(p->gvol == p2->gvol, "global volume");
+		for (j = 0; j < 2; j++) {
+			struct channel_data *xc = &p->xc_data[j];
+			struct channel_data *xc2 = &p2->xc_data[j];
+			fail_unless(xc->volume == xc2->volume, "volume");
+			fail_unless(xc->v_idx == xc2->v_idx, "envelope");
+			fail_unless(xc->info_finalvol == xc2->info_finalvol,
+							"final volume");
+		}
+	}
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+	xmp_end_player(opaque2);
+	xmp_release_module(opaque2);
+	xmp_free_context(opaque2);
+}
+
+TEST(test_api_inject_event_at)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct xmp_module *mod;
+	struct xmp_event event = { 60, 1, 0, 0, 0, 0, 0, 0 };
+	char buf[200];
+	int ret, size, i;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+	mod = &ctx->m.mod;
+
+	create_simple_module(ctx, 2, 2);
+	memset(mod->xxs[0].data, 0x40, mod->xxs[0].len);
+
+	ret = xmp_inject_event_at(opaque, 0, &event, 0);
+	fail_unless(ret == -XMP_ERROR_STATE, "not playing");
+
+	xmp_start_player(opaque, 44100, XMP_FORMAT_MONO);
+	xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_NEAREST);
+	xmp_play_frame(opaque);
+
+	/* Note starts in the middle of a tick */
+	ret = xmp_inject_event_at(opaque, 0, &event, 100);
+	fail_unless(ret == 0, "can't inject event");
+	ret = first_sound(opaque, &size);
+	fail_unless(ret == 100, "note not started at offset");
+
+	/* Note starts in the next tick */
+	xmp_start_player(opaque, 44100, XMP_FORMAT_MONO);
+	xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_NEAREST);
+	xmp_play_frame(opaque);
+	xmp_inject_event_at(opaque, 0, &event, size + 50);
+	ret = first_sound(opaque, &size);
+	fail_unless(ret == -1, "note started too early");
+	ret = first_sound(opaque, &size);
+	fail_unless(ret == 50, "note not started at offset in next tick");
+
+	/* Offset counts from the data not yet returned by xmp_play_buffer */
+	xmp_start_player(opaque, 44100, XMP_FORMAT_MONO);
+	xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_NEAREST);
+	xmp_play_frame(opaque);
+	xmp_play_buffer(opaque, NULL, 0, 0);
+	xmp_play_buffer(opaque, buf, sizeof(buf), 0);
+	xmp_inject_event_at(opaque, 0, &event, size - 100 + 10);
+	ret = first_sound(opaque, &size);
+	fail_unless(ret == 10, "play buffer data not taken into account");
+
+	/* Invalid parameters */
+	ret = xmp_inject_event_at(opaque, -1, &event, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid channel");
+	ret = xmp_inject_event_at(opaque, mod->chn, &event, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid channel");
+	ret = xmp_inject_event_at(opaque, 0, &event, -1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid offset");
+
+	/* Queue full */
+	for (i = 0; i < 64; i++) {
+		ret = xmp_inject_event_at(opaque, 0, &event, 1000 + i);
+		fail_unless(ret == 0, "can't queue event");
+	}
+	ret = xmp_inject_event_at(opaque, 0, &event, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "queue not full");
+
+	/* Queue cleared when the player starts */
+	xmp_start_player(opaque, 44100, XMP_FORMAT_MONO);
+	ret = xmp_inject_event_at(opaque, 0, &event, 0);
+	fail_unless(ret == 0, "queue not cleared");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+
+	check_slides();
+}
+END_TEST
@@ -0,0 +1,252 @@
+#include "test.h"
+#include "../src/common.h"
+#include "../src/med_extras.h"
+
+/* Keep the size of each block in a header to track the memory in use */
+struct mem_stats {
+	unsigned long used;
+	unsigned long peak;
+	unsigned long limit;
+	int count;
+	int errors;
+};
+
+#define HEADER 16
+
+static void *test_alloc(unsigned long size, void *priv)
+{
+	struct mem_stats *st = (struct mem_stats *)priv;
+	unsigned char *p;
+
+	if (st->limit && st->used + size > st->limit)
+		return NULL;
+	if ((p = (unsigned char *)malloc(size + HEADER)) == NULL)
+		return NULL;
+
+	*(unsigned long *)p = size;
+	st->used += size;
+	if (st->used > st->peak)
+		st->peak = st->used;
+	st->count++;
+	return p + HEADER;
+}
+
+static void test_release(void *ptr, void *priv)
+{
+	struct mem_stats *st = (struct mem_stats *)priv;
+	unsigned char *p = (unsigned char *)ptr - HEADER;
+	unsigned long size = *(unsigned long *)p;
+
+	if (size > st->used) {
+		st->errors++;
+		return;
+	}
+	st->used -= size;
+	free(p);
+}
+
+static void *test_resize(void *ptr, unsigned long size, void *priv)
+{
+	struct mem_stats *st = (struct mem_stats *)priv;
+	unsigned char *p = (unsigned char *)ptr - HEADER;
+	unsigned long old = *(unsigned long *)p;
+
+	if (st->limit && st->used - old + size > st->limit)
+		return NULL;
+	if ((p = (unsigned char *)realloc(p, size + HEADER)) == NULL)
+		return NULL;
+
+	*(unsigned long *)p = size;
+	st->used = st->used - old + size;
+	if (st->used > st->peak)
+		st->peak = st->used;
+	return p + HEADER;
+}
+
+/* Format-specific extras are allocated and counted like the rest of the
+ * module, so the usage reported matches the allocator exactly */
+static void check_extras(struct xmp_allocator *a, struct mem_stats *st,
+			 const char *path)
+{
+	xmp_context opaque;
+	struct module_data *m;
+	struct xmp_memory_usage usage;
+	unsigned long context_size;
+	int ret, i;
+
+	memset(st, 0, sizeof(struct mem_stats));
+	opaque = xmp_create_context_with_allocator(a);
+	fail_unless(opaque != NULL, "can't create context");
+	context_size = st->used;
+
+	ret = xmp_load_module(opaque, path);
+	fail_unless(ret == 0, "load error");
+	xmp_get_memory_usage(opaque, &usage);
+	fail_unless(usage.total == st->used - context_size,
+		"module extras not counted");
+
+	/* The block header is only there if the extras come from the
+	 * context allocator */
+	m = &((struct context_data *)opaque)->m;
+	if (HAS_MED_MODULE_EXTRAS(*m)) {
+		fail_unless(*(unsigned long *)((unsigned char *)m->extra - HEADER)
+			== sizeof(struct med_module_extras),
+			"module extras not allocated by the context allocator");
+	}
+
+	ret = xmp_start_player(opaque, 44100, 0);
+	fail_unless(ret == 0, "can't start player");
+	for (i = 0; i < 10; i++)
+		xmp_play_frame(opaque);
+	xmp_get_memory_usage(opaque, &usage);
+	fail_unless(usage.total == st->used - context_size,
+		"channel extras not counted");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+	fail_unless(st->used == 0, "context memory not freed");
+	fail_unless(st->errors == 0, "invalid free");
+
+	for (i = 0; ; i++) {
+		memset(st, 0, sizeof(struct mem_stats));
+		st->limit = context_size + i * 1024;
+
+		opaque = xmp_create_context_with_allocator(a);
+		fail_unless(opaque != NULL, "can't create context");
+		ret = xmp_load_module(opaque, path);
+		if (ret == 0)
+			xmp_release_module(opaque);
+		xmp_free_context(opaque);
+		fail_unless(st->used == 0, "memory not freed after error");
+		fail_unless(st->errors == 0, "invalid free");
+		if (ret == 0)
+			break;
+	}
+}
+
+TEST(test_api_memory_usage)
+{
+	xmp_context opaque;
+	struct xmp_allocator a;
+	struct xmp_memory_usage usage;
+	struct mem_stats st;
+	unsigned long context_size;
+	int ret, i;
+
+	memset(&st, 0, sizeof(struct mem_stats));
+	a.alloc = test_alloc;
+	a.resize = test_resize;
+	a.release = test_release;
+	a.priv = &st;
+
+	opaque = xmp_create_context_with_allocator(&a);
+	fail_unless(opaque != NULL, "can't create context");
+	fail_unless(st.count == 1, "context not allocated");
+	context_size = st.used;
+
+	ret = xmp_get_memory_usage(opaque, &usage);
+	fail_unless(ret == 0, "can't get memory usage");
+	fail_unless(usage.total == 0, "memory in use before loading");
+
+	ret = xmp_load_module(opaque, "data/test.it");
+	fail_unless(ret == 0, "load error");
+
+	xmp_get_memory_usage(opaque, &usage);
+	fail_unless(usage.patterns > 0, "no pattern memory");
+	fail_unless(usage.samples > 0, "no sample memory");
+	fail_unless(usage.scan > 0, "no scan memory");
+	fail_unless(usage.mixer == 0, "mixer memory before playing");
+	fail_unless(usage.total == usage.patterns + usage.samples +
+		usage.scan + usage.mixer + usage.depack_cache, "total");
+	fail_unless(usage.total <= st.used - context_size,
+		"memory not allocated by the context allocator");
+
+	ret = xmp_start_player(opaque, 44100, 0);
+	fail_unless(ret == 0, "can't start player");
+	for (i = 0; i < 10; i++)
+		xmp_play_frame(opaque);
+
+	xmp_get_memory_usage(opaque, &usage);
+	fail_unless(usage.mixer > 0, "no mixer memory");
+	fail_unless(usage.total <= st.used - context_size,
+		"memory not allocated by the context allocator");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+
+	xmp_get_memory_usage(opaque, &usage);
+	fail_unless(usage.total == 0, "memory in use after release");
+	fail_unless(st.used == context_size, "module memory not freed");
+
+	xmp_free_context(opaque);
+	fail_unless(st.used == 0, "context memory not freed");
+	fail_unless(st.errors == 0, "invalid free");
+
+	/* Loading fails cleanly when the allocator refuses memory */
+	for (i = 0; ; i++) {
+		memset(&st, 0, sizeof(struct mem_stats));
+		st.limit = context_size + i * 1024;
+
+		opaque = xmp_create_context_with_allocator(&a);
+		fail_unless(opaque != NULL, "can't create context");
+		ret = xmp_load_module(opaque, "data/test.it");
+		if (ret == 0)
+			xmp_release_module(opaque);
+		xmp_free_context(opaque);
+		fail_unless(st.used == 0, "memory not freed after error");
+		fail_unless(st.errors == 0, "invalid free");
+		if (ret == 0)
+			break;
+	}
+	fail_unless(i > 0, "module loaded without memory");
+
+	/* Depacked data and the Vorbis decoder use the context allocator */
+	memset(&st, 0, sizeof(struct mem_stats));
+	opaque = xmp_create_context_with_allocator(&a);
+	fail_unless(opaque != NULL, "can't create context");
+	xmp_set_player(opaque, XMP_PLAYER_DEPACK_CACHE, 1024);
+	ret = xmp_load_module(opaque, "data/xzdata");
+	fail_unless(ret == 0, "load error");
+	xmp_get_memory_usage(opaque, &usage);
+	fail_unless(usage.depack_cache > 0, "depacked data not cached");
+	fail_unless(usage.total <= st.used - context_size,
+		"depacked data not allocated by the context allocator");
+	xmp_release_module(opaque);
+
+	st.peak = st.used;
+	ret = xmp_load_module(opaque, "data/beep.oxm");
+	fail_unless(ret == 0, "load error");
+	fail_unless(st.peak - st.used > 160 * 1024,
+		"Vorbis decoder not allocated by the context allocator");
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+	fail_unless(st.used == 0, "context memory not freed");
+	fail_unless(st.errors == 0, "invalid free");
+
+	for (i = 0; ; i++) {
+		memset(&st, 0, sizeof(struct mem_stats));
+		st.limit = context_size + i * 4096;
+
+		opaque = xmp_create_context_with_allocator(&a);
+		fail_unless(opaque != NULL, "can't create context");
+		ret = xmp_load_module(opaque, "data/beep.oxm");
+		if (ret == 0)
+			xmp_release_module(opaque);
+		xmp_free_context(opaque);
+		fail_unless(st.used == 0, "memory not freed after error");
+		fail_unless(st.errors == 0, "invalid free");
+		if (ret == 0)
+			break;
+	}
+
+	/* MED synth tables and FLT AM synth instruments */
+	check_extras(&a, &st, "data/MED.Synth-a-sysmic");
+	check_extras(&a, &st, "data/flt_am_envelope.mod");
+
+	/* All callbacks are required */
+	a.resize = NULL;
+	opaque = xmp_create_context_with_allocator(&a);
+	fail_unless(opaque == NULL, "context created without resize");
+}
+END_TEST
@@ -0,0 +1,65 @@
+#include "test.h"
+#include "../src/loaders/loader.h"
+
+static int vals[] = { 5, 58, 156, 350, 555, 1999, 3535, 5018, -1 };
+static short buffer[10000];
+
+#define REFBUF_SIZE 72000
+
+TEST(test_api_render_samples)
+{
+	xmp_context opaque;
+	FILE *f;
+	int i, ret, cmp, size, num;
+	char *ref_buffer;
+
+	f = fopen("data/pcm_buffer.raw", "rb");
+	ref_buffer = (char *) calloc(1, REFBUF_SIZE);
+	fail_unless(ref_buffer != NULL, "buffer allocation error");
+
+	ret = fread(ref_buffer, 1, REFBUF_SIZE, f);
+	fail_unless(ret > 0, "read error");
+	if (is_big_endian()) {
+		convert_endian((unsigned char *)ref_buffer, REFBUF_SIZE / 2);
+	}
+
+	opaque = xmp_create_context();
+
+	ret = xmp_load_module(opaque, "data/storlek_03.it");
+	fail_unless(ret == 0, "module load error");
+
+	ret = xmp_render_samples(opaque, buffer, 1, 0);
+	fail_unless(ret == -XMP_ERROR_STATE, "not playing");
+
+	/* Same output as xmp_play_buffer() for any buffer size */
+	for (i = 0; vals[i] > 0; i++) {
+		xmp_start_player(opaque, 8000, XMP_FORMAT_MONO);
+		xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_LINEAR);
+
+		size = 0;
+		num = vals[i];
+
+		xmp_render_samples(opaque, NULL, 0, 0);
+
+		while ((ret = xmp_render_samples(opaque, buffer, num, 1)) == 0) {
+			cmp = memcmp(buffer, ref_buffer + size, num * 2);
+			fail_unless(cmp == 0, "buffer comparison failed");
+
+			size += num * 2;
+			if ((size + num * 2) >= REFBUF_SIZE)
+				break;
+		}
+
+		/* check end of module */
+		fail_unless(ret == -XMP_END, "end of module");
+	}
+
+	fail_unless(vals[i] == -1, "didn't test all buffer sizes");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+	free(ref_buffer);
+	fclose(f);
+}
+END_TEST
@@ -0,0 +1,221 @@
+#include "test.h"
+
+/* Test xmp_save_state and xmp_restore_state. */
+
+#define NUM_FRAMES 50
+
+static unsigned frame_hash(const struct xmp_frame_info *fi)
+{
+	const unsigned char *b = (const unsigned char *)fi->buffer;
+	unsigned h = 2166136261u;
+	int i;
+
+	for (i = 0; i < fi->buffer_size; i++) {
+		h = (h ^ b[i]) * 16777619u;
+	}
+	return h ^ (fi->pos << 16) ^ (fi->row << 8) ^ fi->frame;
+}
+
+static void play_frames(xmp_context opaque, unsigned *hash)
+{
+	struct xmp_frame_info fi;
+	int i;
+
+	for (i = 0; i < NUM_FRAMES; i++) {
+		xmp_play_frame(opaque);
+		xmp_get_frame_info(opaque, &fi);
+		hash[i] = frame_hash(&fi);
+	}
+}
+
+static void check_module(const char *filename, int skip)
+{
+	xmp_context opaque, opaque2;
+	unsigned hash[NUM_FRAMES], hash2[NUM_FRAMES];
+	void *state;
+	int ret, size, i;
+
+	opaque = xmp_create_context();
+	opaque2 = xmp_create_context();
+	fail_unless(opaque != NULL && opaque2 != NULL, "can't create context");
+
+	ret = xmp_load_module(opaque, filename);
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(opaque2, filename);
+	fail_unless(ret == 0, "can't load module");
+
+	/* Not playing yet */
+	ret = xmp_save_state(opaque, NULL, 0);
+	fail_unless(ret == -XMP_ERROR_STATE, "save state error");
+
+	xmp_start_player(opaque, 44100, 0);
+	xmp_start_player(opaque2, 44100, 0);
+
+	for (i = 0; i < skip; i++) {
+		xmp_play_frame(opaque);
+	}
+
+	size = xmp_save_state(opaque, NULL, 0);
+	fail_unless(size > 0, "can't get state size");
+	state = malloc(size);
+	fail_unless(state != NULL, "can't allocate state");
+
+	ret = xmp_save_state(opaque, state, size - 1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "short buffer not detected");
+	ret = xmp_save_state(opaque, state, size);
+	fail_unless(ret == size, "can't save state");
+
+	play_frames(opaque, hash);
+
+	/* Restore in the same context */
+	ret = xmp_restore_state(opaque, state, size);
+	fail_unless(ret == 0, "can't restore state");
+	play_frames(opaque, hash2);
+	fail_unless(memcmp(hash, hash2, sizeof(hash)) == 0, "same context mismatch");
+
+	/* Restore in a different context */
+	ret = xmp_restore_state(opaque2, state, size - 1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "short state not detected");
+	ret = xmp_restore_state(opaque2, state, size);
+	fail_unless(ret == 0, "can't restore state");
+	play_frames(opaque2, hash2);
+	fail_unless(memcmp(hash, hash2, sizeof(hash)) == 0, "new context mismatch");
+
+	free(state);
+	xmp_end_player(opaque);
+	xmp_end_player(opaque2);
+	xmp_release_module(opaque);
+	xmp_release_module(opaque2);
+	xmp_free_context(opaque);
+	xmp_free_context(opaque2);
+}
+
+/* Frames left over by xmp_render_samples() are discarded on restore */
+static void check_render(const char *filename)
+{
+	xmp_context opaque, opaque2;
+	static short buffer[2048 * 2], buffer2[2048 * 2];
+	void *state;
+	int ret, size, i;
+
+	opaque = xmp_create_context();
+	opaque2 = xmp_create_context();
+	xmp_load_module(opaque, filename);
+	xmp_load_module(opaque2, filename);
+	xmp_start_player(opaque, 44100, 0);
+	xmp_start_player(opaque2, 44100, 0);
+
+	for (i = 0; i < 20; i++) {
+		xmp_render_samples(opaque, buffer, 1000, 0);
+	}
+
+	size = xmp_save_state(opaque, NULL, 0);
+	state = malloc(size);
+	fail_unless(state != NULL, "can't allocate state");
+	ret = xmp_save_state(opaque, state, size);
+	fail_unless(ret == size, "can't save state");
+
+	/* Leave part of a frame unconsumed */
+	xmp_render_samples(opaque, buffer, 100, 0);
+
+	ret = xmp_restore_state(opaque, state, size);
+	fail_unless(ret == 0, "can't restore state");
+	xmp_render_samples(opaque, buffer, 2048, 0);
+
+	ret = xmp_restore_state(opaque2, state, size);
+	fail_unless(ret == 0, "can't restore state");
+	xmp_render_samples(opaque2, buffer2, 2048, 0);
+
+	fail_unless(memcmp(buffer, buffer2, sizeof(buffer)) == 0,
+		    "rendered samples mismatch after restore");
+
+	free(state);
+	xmp_end_player(opaque);
+	xmp_end_player(opaque2);
+	xmp_release_module(opaque);
+	xmp_release_module(opaque2);
+	xmp_free_context(opaque);
+	xmp_free_context(opaque2);
+}
+
+/* The loop count is restored with the rest of the player state */
+static void check_loop_count(const char *filename)
+{
+	xmp_context opaque;
+	struct xmp_frame_info fi;
+	void *state;
+	int ret, size, i;
+
+	opaque = xmp_create_context();
+	xmp_load_module(opaque, filename);
+	xmp_start_player(opaque, 44100, 0);
+
+	for (i = 0; i < 100000; i++) {
+		xmp_play_frame(opaque);
+		xmp_get_frame_info(opaque, &fi);
+		if (fi.loop_count > 0)
+			break;
+	}
+	fail_unless(fi.loop_count == 1, "module didn't loop");
+
+	size = xmp_save_state(opaque, NULL, 0);
+	state = malloc(size);
+	fail_unless(state != NULL, "can't allocate state");
+	ret = xmp_save_state(opaque, state, size);
+	fail_unless(ret == size, "can't save state");
+
+	xmp_restart_module(opaque);
+	xmp_play_frame(opaque);
+	xmp_get_frame_info(opaque, &fi);
+	fail_unless(fi.loop_count == 0, "loop count not reset");
+
+	ret = xmp_restore_state(opaque, state, size);
+	fail_unless(ret == 0, "can't restore state");
+	xmp_get_frame_info(opaque, &fi);
+	fail_unless(fi.loop_count == 1, "loop count not restored");
+
+	free(state);
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+
+TEST(test_api_save_state)
+{
+	xmp_context opaque;
+	void *state;
+	int ret, size;
+
+	check_module("data/ode2ptk.mod", 300);
+	check_module("data/storlek_22.it", 40);
+	check_module("data/MED.Synth-a-sysmic", 200);
+	check_render("data/ode2ptk.mod");
+	check_loop_count("data/storlek_03.it");
+
+	/* State from a different module */
+	opaque = xmp_create_context();
+	xmp_load_module(opaque, "data/ode2ptk.mod");
+	xmp_start_player(opaque, 44100, 0);
+	size = xmp_save_state(opaque, NULL, 0);
+	state = malloc(size);
+	fail_unless(state != NULL, "can't allocate state");
+	xmp_save_state(opaque, state, size);
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+
+	xmp_load_module(opaque, "data/storlek_22.it");
+	xmp_start_player(opaque, 44100, 0);
+	ret = xmp_restore_state(opaque, state, size);
+	fail_unless(ret == -XMP_ERROR_INVALID, "module mismatch not detected");
+
+	/* Different sampling rate */
+	xmp_start_player(opaque, 22050, 0);
+	ret = xmp_restore_state(opaque, state, size);
+	fail_unless(ret == -XMP_ERROR_INVALID, "rate mismatch not detected");
+
+	free(state);
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+END_TEST
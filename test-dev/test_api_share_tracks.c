@@ -0,0 +1,88 @@
+#include "test.h"
+
+TEST(test_api_share_tracks)
+{
+	xmp_context opaque, opaque2;
+	struct xmp_module_info mi, mi2;
+	struct xmp_module *mod, *mod2;
+	struct xmp_frame_info fi, fi2;
+	int ret, i, j, shared;
+
+	opaque = xmp_create_context();
+	opaque2 = xmp_create_context();
+
+	ret = xmp_get_player(opaque, XMP_PLAYER_SHARE_TRACKS);
+	fail_unless(ret == 0, "tracks shared by default");
+	ret = xmp_set_player(opaque, XMP_PLAYER_SHARE_TRACKS, 1);
+	fail_unless(ret == 0, "can't share tracks");
+	ret = xmp_get_player(opaque, XMP_PLAYER_SHARE_TRACKS);
+	fail_unless(ret == 1, "tracks not shared");
+
+	ret = xmp_load_module(opaque, "data/ice234_filter.mod");
+	fail_unless(ret == 0, "load error");
+	ret = xmp_load_module(opaque2, "data/ice234_filter.mod");
+	fail_unless(ret == 0, "load error");
+
+	ret = xmp_set_player(opaque, XMP_PLAYER_SHARE_TRACKS, 0);
+	fail_unless(ret == -XMP_ERROR_STATE, "can change after loading");
+
+	xmp_get_module_info(opaque, &mi);
+	xmp_get_module_info(opaque2, &mi2);
+	mod = mi.mod;
+	mod2 = mi2.mod;
+
+	/* Track numbers are kept, and all tracks have the same events */
+	fail_unless(mod->trk == mod2->trk, "number of tracks");
+	for (i = 0; i < mod->pat; i++) {
+		for (j = 0; j < mod->chn; j++) {
+			fail_unless(mod->xxp[i]->index[j] ==
+				    mod2->xxp[i]->index[j], "pattern index");
+		}
+	}
+
+	shared = 0;
+	for (i = 0; i < mod->trk; i++) {
+		fail_unless(mod->xxt[i]->rows == mod2->xxt[i]->rows, "rows");
+		fail_unless(memcmp(mod->xxt[i]->event, mod2->xxt[i]->event,
+			    mod->xxt[i]->rows * sizeof(struct xmp_event)) == 0,
+			    "track events");
+		for (j = 0; j < i; j++) {
+			int same = memcmp(mod->xxt[i]->event, mod->xxt[j]->event,
+				mod->xxt[i]->rows * sizeof(struct xmp_event)) == 0 &&
+				mod->xxt[i]->rows == mod->xxt[j]->rows;
+
+			fail_unless(mod2->xxt[i] != mod2->xxt[j],
+				    "tracks shared without option");
+			if (same) {
+				fail_unless(mod->xxt[i] == mod->xxt[j],
+					    "identical tracks not shared");
+				shared++;
+			} else {
+				fail_unless(mod->xxt[i] != mod->xxt[j],
+					    "different tracks shared");
+			}
+		}
+	}
+	fail_unless(shared > 0, "no shared tracks");
+
+	/* Both modules play the same */
+	xmp_start_player(opaque, 44100, 0);
+	xmp_start_player(opaque2, 44100, 0);
+	for (i = 0; i < 100; i++) {
+		xmp_play_frame(opaque);
+		xmp_play_frame(opaque2);
+		xmp_get_frame_info(opaque, &fi);
+		xmp_get_frame_info(opaque2, &fi2);
+		fail_unless(fi.buffer_size == fi2.buffer_size, "buffer size");
+		fail_unless(memcmp(fi.buffer, fi2.buffer, fi.buffer_size) == 0,
+			    "output differs");
+	}
+
+	xmp_end_player(opaque);
+	xmp_end_player(opaque2);
+	xmp_release_module(opaque);
+	xmp_release_module(opaque2);
+	xmp_free_context(opaque);
+	xmp_free_context(opaque2);
+}
+END_TEST
@@ -0,0 +1,80 @@
+#include "test.h"
+
+static void check_batch_item(const struct xmp_batch_info *b, int flags)
+{
+	struct xmp_frame_info fi;
+	struct xmp_module_info mi;
+	xmp_context c;
+	int ret;
+
+	c = xmp_create_context();
+	fail_unless(c != NULL, "can't create context");
+
+	if (b->path != NULL) {
+		ret = xmp_load_module(c, b->path);
+	} else {
+		ret = xmp_load_module_from_memory(c, b->mem, b->size);
+	}
+	fail_unless(ret == 0, "can't load module");
+
+	xmp_get_module_info(c, &mi);
+	fail_unless(b->error == 0, "error");
+	fail_unless(strcmp(b->name, mi.mod->name) == 0, "name");
+	fail_unless(strcmp(b->type, mi.mod->type) == 0, "type");
+	fail_unless(b->chn == mi.mod->chn, "channels");
+
+	xmp_start_player(c, 44100, 0);
+	xmp_get_frame_info(c, &fi);
+	if (flags & XMP_BATCH_SCAN) {
+		fail_unless(b->time == fi.total_time, "duration");
+	} else {
+		fail_unless(b->time == -1, "duration not skipped");
+	}
+
+	xmp_end_player(c);
+	xmp_release_module(c);
+	xmp_free_context(c);
+}
+
+TEST(test_api_test_module_batch)
+{
+	struct xmp_batch_info b[5];
+	void *buf;
+	long size;
+	int ret, flags;
+
+	read_file_to_memory("data/storlek_05.it", &buf, &size);
+	fail_unless(buf != NULL, "can't read file");
+
+	for (flags = 0; flags <= XMP_BATCH_SCAN; flags += XMP_BATCH_SCAN) {
+		memset(b, 0, sizeof(b));
+		b[0].path = "data/xm_portamento_target.xm";
+		b[1].path = "data/m/sonic_boom.669";
+		b[2].mem = buf;
+		b[2].size = size;
+		b[3].path = "data/storlek_01.data";
+		b[4].path = "data/not_there";
+
+		ret = xmp_test_module_batch(b, 5, flags);
+		fail_unless(ret == 3, "wrong number of modules");
+
+		check_batch_item(&b[0], flags);
+		check_batch_item(&b[1], flags);
+		check_batch_item(&b[2], flags);
+		fail_unless(b[3].error == -XMP_ERROR_FORMAT, "unsupported format");
+		fail_unless(b[3].time == -1 && b[3].chn == 0, "invalid item");
+		fail_unless(b[4].error == -XMP_ERROR_SYSTEM, "missing file");
+	}
+
+	/* empty item */
+	memset(b, 0, sizeof(b));
+	ret = xmp_test_module_batch(b, 1, 0);
+	fail_unless(ret == 0, "empty item");
+	fail_unless(b[0].error == -XMP_ERROR_INVALID, "empty item error");
+
+	ret = xmp_test_module_batch(NULL, 1, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "null items");
+
+	free(buf);
+}
+END_TEST
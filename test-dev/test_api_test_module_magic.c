@@ -0,0 +1,84 @@
+#include "test.h"
+
+/* Loaders with a known magic are skipped when the module doesn't have
+ * it; make sure format detection still gives the same result as testing
+ * each loader in order, for formats with and without magic bytes. */
+
+static const struct {
+	const char *path;
+	const char *type;	/* NULL if not a module */
+} modules[] = {
+	{ "data/m/3d_foot.gdm", "General Digital Music" },
+	{ "data/m/4th_Symmetriad.it", "Impulse Tracker" },
+	{ "data/m/AOM-Mind.Tracker", "Archimedes Tracker" },
+	{ "data/m/APATHY.MOD", "Amiga Protracker/Compatible" },
+	{ "data/m/Avoid.amf", "DSMI Advanced Module Format" },
+	{ "data/m/Crepequs.mod", "Soundtracker" },
+	{ "data/m/Diamond.j2b", "MUSE container" },
+	{ "data/m/FROZEN.DMF", "Amiga Protracker/Compatible" },
+	{ "data/m/FutureBrain.stx", "STMIK 0.2" },
+	{ "data/m/IMS.beast-busters1.st", "Images Music System" },
+	{ "data/m/Jarre-Like.MED", "MED 2.10/OctaMED" },
+	{ "data/m/MRHPx-HBTN LUCiFER.xm", "Fast Tracker II" },
+	{ "data/m/Millenium2.Coconizer", "Coconizer" },
+	{ "data/m/NP2.Multica", "NoisePacker v2" },
+	{ "data/m/OKT.Yes-PartII", "Oktalyzer" },
+	{ "data/m/SFX.Crockett's_theme", "SoundFX v1.3/2.0" },
+	{ "data/m/STIM.intro_1", "Slamtilt" },
+	{ "data/m/Song.med", "MED 2.00 MED3" },
+	{ "data/m/Synth-a-sysmic.med", "MED 2.10 MED4" },
+	{ "data/m/WasteOfTime.liq", "Liquid Tracker" },
+	{ "data/m/alf.abk", "AMOS Music Bank" },
+	{ "data/m/alloyrun.rad", NULL },
+	{ "data/m/astaris.imf", "Imago Orpheus v1.0" },
+	{ "data/m/battleship.fnk", "Funktracker" },
+	{ "data/m/breaking.mdl", "Digitrakker" },
+	{ "data/m/call_me.dtm", "Digital Tracker" },
+	{ "data/m/cybocult.ult", "Ultra Tracker" },
+	{ "data/m/drwhofinl4.dsym", "Digital Symphony" },
+	{ "data/m/elysium.emod", "Quadra Composer" },
+	{ "data/m/ep-song1.psm", "Epic MegaGames MASI" },
+	{ "data/m/fall1.mtm", "Multitracker" },
+	{ "data/m/fcslide1.sts", "Scream Tracker 2" },
+	{ "data/m/funkowyhenrykibalbina.dbm", "DigiBooster Pro" },
+	{ "data/m/gmc.ingame", "Game Music Creator" },
+	{ "data/m/inside_out.s3m", "Scream Tracker 3" },
+	{ "data/m/lind.mod", "His Master's Noise" },
+	{ "data/m/m07.amf", "Asylum Music Format v1.0" },
+	{ "data/m/med2test.med", "MED 1.12 MED2" },
+	{ "data/m/mfp.crystaldragon title", "Magnetic Fields Packer" },
+	{ "data/m/mmdc.TTUNE", "MED 2.10/OctaMED" },
+	{ "data/m/mod.OUR-ROUT.Travellers Tales", "Chiptracker" },
+	{ "data/m/mod.sad-song", "UNIC Tracker" },
+	{ "data/m/odyssey.rtm", "Real Tracker" },
+	{ "data/m/order_of_death_ii.mod", "Soundtracker 2.6/Ice Tracker" },
+	{ "data/m/redoctober-sub-docking.ims", "Images Music System" },
+	{ "data/m/rew_vibr.ptm", "Poly Tracker" },
+	{ "data/m/silly venture.mgt", "Megatracker" },
+	{ "data/m/silver-song0.psm", "Epic MegaGames MASI 16" },
+	{ "data/m/sonic_boom.669", "Composer 669" },
+	{ "data/m/the new beginning.pt36", "Protracker 3" },
+	{ "data/m/thunddrm.far", "Farandole Composer" },
+	{ "data/m/time after time.liq", "Liquid Tracker NO" },
+	{ "data/m/yyde2.digi", "DIGI Booster" },
+	{ "data/m/zob-the-zob.mod", "Startrekker" },
+	{ "data/m/zob-the-zob.mod.nt", NULL },
+	{ NULL, NULL }
+};
+
+TEST(test_api_test_module_magic)
+{
+	struct xmp_test_info ti;
+	int i, ret;
+
+	for (i = 0; modules[i].path != NULL; i++) {
+		ret = xmp_test_module(modules[i].path, &ti);
+		if (modules[i].type == NULL) {
+			fail_unless(ret == -XMP_ERROR_FORMAT, "format detected");
+			continue;
+		}
+		fail_unless(ret == 0, "format not detected");
+		fail_unless(strcmp(ti.type, modules[i].type) == 0, "wrong format");
+	}
+}
+END_TEST
@@ -0,0 +1,72 @@
+#include "test.h"
+#include "../src/depackers/depacker.h"
+
+static void load_and_check(xmp_context c, const char *path, const char *md5)
+{
+	struct xmp_module_info info;
+	int ret;
+
+	ret = xmp_load_module(c, path);
+	fail_unless(ret == 0, "can't load module");
+	xmp_get_module_info(c, &info);
+	ret = compare_md5(info.md5, md5);
+	fail_unless(ret == 0, "MD5 error");
+	xmp_release_module(c);
+}
+
+TEST(test_depack_cache)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct depack_cache *cache;
+	long used;
+	int ret;
+
+	opaque = xmp_create_context();
+	fail_unless(opaque != NULL, "can't create context");
+	ctx = (struct context_data *)opaque;
+
+	ret = xmp_get_player(opaque, XMP_PLAYER_DEPACK_CACHE);
+	fail_unless(ret == 0, "cache enabled by default");
+	ret = xmp_set_player(opaque, XMP_PLAYER_DEPACK_CACHE, -1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid size");
+
+	ret = xmp_set_player(opaque, XMP_PLAYER_DEPACK_CACHE, 1024);
+	fail_unless(ret == 0, "can't enable cache");
+	ret = xmp_get_player(opaque, XMP_PLAYER_DEPACK_CACHE);
+	fail_unless(ret == 1024, "wrong cache size");
+	cache = ctx->m.depack_cache;
+	fail_unless(cache != NULL, "cache not allocated");
+
+	/* Depacked data is cached on first load and reused after that */
+	load_and_check(opaque, "data/xzdata", "37b8afe62ec42a47b1237b794193e785");
+	fail_unless(cache->used > 0, "data not cached");
+	used = cache->used;
+	load_and_check(opaque, "data/xzdata", "37b8afe62ec42a47b1237b794193e785");
+	fail_unless(cache->used == used, "data cached twice");
+
+	load_and_check(opaque, "data/bzip2data", "0350baf25b96d6d125f537c63f03e3db");
+	fail_unless(cache->used > used, "data not cached");
+
+	/* Unpacked files aren't cached */
+	used = cache->used;
+	load_and_check(opaque, "data/storlek_05.it", "444afa46fb9914dd2dcdce15ec70baa3");
+	fail_unless(cache->used == used, "unpacked data cached");
+
+	/* Shrinking the cache drops the least recently used data */
+	load_and_check(opaque, "data/xzdata", "37b8afe62ec42a47b1237b794193e785");
+	ret = xmp_set_player(opaque, XMP_PLAYER_DEPACK_CACHE, (used - 1) / 1024);
+	fail_unless(ret == 0, "can't resize cache");
+	fail_unless(cache->used > 0 && cache->used < used, "data not dropped");
+	load_and_check(opaque, "data/xzdata", "37b8afe62ec42a47b1237b794193e785");
+	load_and_check(opaque, "data/bzip2data", "0350baf25b96d6d125f537c63f03e3db");
+
+	ret = xmp_set_player(opaque, XMP_PLAYER_DEPACK_CACHE, 0);
+	fail_unless(ret == 0, "can't disable cache");
+	fail_unless(cache->used == 0, "data not dropped");
+	load_and_check(opaque, "data/xzdata", "37b8afe62ec42a47b1237b794193e785");
+	fail_unless(cache->used == 0, "data cached with cache disabled");
+
+	xmp_free_context(opaque);
+}
+END_TEST
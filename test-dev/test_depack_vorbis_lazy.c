@@ -0,0 +1,90 @@
+#include "test.h"
+#include "../src/mixer.h"
+
+
+TEST(test_depack_vorbis_lazy)
+{
+	int i, ret, voc;
+	void *buf, *state;
+	int16 *pcm16;
+	long size;
+	xmp_context c, c2;
+	struct context_data *ctx2;
+	struct xmp_module_info info;
+	struct xmp_event event = { 49, 1, 0, 0, 0, 0, 0, 0 };
+
+	c = xmp_create_context();
+	fail_unless(c != NULL, "can't create context");
+
+	xmp_set_player(c, XMP_PLAYER_SMPCTL, XMP_SMPCTL_LAZY);
+	ret = xmp_get_player(c, XMP_PLAYER_SMPCTL);
+	fail_unless(ret == XMP_SMPCTL_LAZY, "can't set lazy sample mode");
+
+	ret = xmp_load_module(c, "data/beep.oxm");
+	fail_unless(ret == 0, "can't load module");
+
+	/* Sample length is known, but the sample isn't decoded yet */
+	xmp_get_module_info(c, &info);
+	fail_unless(info.mod->xxs[0].len == 9376, "sample length error");
+	fail_unless(info.mod->xxs[0].data == NULL, "sample already decoded");
+
+	/* Playing a note with the sample decodes it */
+	xmp_start_player(c, 44100, 0);
+	xmp_inject_event(c, 0, &event);
+	xmp_play_frame(c);
+	fail_unless(info.mod->xxs[0].data != NULL, "sample not decoded");
+	fail_unless(info.mod->xxs[0].len == 9376, "decoded length error");
+
+	read_file_to_memory("data/beep.raw", &buf, &size);
+	fail_unless(buf != NULL, "can't open raw data file");
+
+	pcm16 = (int16 *)info.mod->xxs[0].data;
+	if (is_big_endian()) { /* convert little-endian to host-endian */
+		convert_endian((unsigned char *)buf, size / 2);
+	}
+
+	for (i = 0; i < (9376 / 2); i++) {
+		if (pcm16[i] != ((int16 *)buf)[i])
+			fail_unless(abs(pcm16[i] - ((int16 *)buf)[i]) <= 1, "data error");
+	}
+
+	/* Restoring a voice decodes its sample */
+	size = xmp_save_state(c, NULL, 0);
+	state = malloc(size);
+	fail_unless(state != NULL, "can't allocate state");
+	ret = xmp_save_state(c, state, size);
+	fail_unless(ret == size, "can't save state");
+
+	c2 = xmp_create_context();
+	xmp_set_player(c2, XMP_PLAYER_SMPCTL, XMP_SMPCTL_LAZY);
+	ret = xmp_load_module(c2, "data/beep.oxm");
+	fail_unless(ret == 0, "can't load module");
+	xmp_start_player(c2, 44100, 0);
+	ret = xmp_restore_state(c2, state, size);
+	fail_unless(ret == 0, "can't restore state");
+
+	ctx2 = (struct context_data *)c2;
+	voc = map_channel(&ctx2->p, 0);
+	fail_unless(voc >= 0, "voice not restored");
+	fail_unless(ctx2->m.mod.xxs[0].data != NULL, "restored sample not decoded");
+	fail_unless(ctx2->p.virt.voice_array[voc].sptr == ctx2->m.mod.xxs[0].data,
+		    "restored voice has no sample data");
+
+	xmp_end_player(c2);
+	xmp_release_module(c2);
+	xmp_free_context(c2);
+	free(state);
+
+	xmp_end_player(c);
+
+	/* Release a module with samples that were never decoded */
+	ret = xmp_load_module(c, "data/jerry-boleti.oxm");
+	fail_unless(ret == 0, "can't load module (jerry-boleti)");
+	xmp_get_module_info(c, &info);
+	fail_unless(info.mod->xxs[4].len == 5492, "sample length error (jerry-boleti)");
+
+	xmp_release_module(c);
+	xmp_free_context(c);
+	free(buf);
+}
+END_TEST
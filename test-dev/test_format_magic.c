@@ -0,0 +1,77 @@
+#include "test.h"
+#include "../src/format.h"
+
+/* libxmp_format_magic_match() walks format_magic[] in lockstep with
+ * format_loaders[], so the magic entries of each loader must be
+ * consecutive and in the same order as the loaders. An entry out of order
+ * is never reached, and the filter silently stops skipping loaders.
+ *
+ * Both tables are internal to the library, so they are read from the
+ * source. Entries in conditional blocks are all listed, which also checks
+ * the order for every build configuration.
+ */
+
+#define MAX_ENTRIES 128
+#define LOADER_PREFIX "&libxmp_loader_"
+
+static int read_table(FILE *f, const char *table, char (*name)[32],
+		      int *offset, int *size)
+{
+	char line[256], *s;
+	int num = 0, in_table = 0;
+
+	rewind(f);
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (!in_table) {
+			in_table = strstr(line, table) != NULL &&
+				   strchr(line, '{') != NULL;
+			continue;
+		}
+		if (strncmp(line, "};", 2) == 0) {
+			break;
+		}
+		if ((s = strstr(line, LOADER_PREFIX)) == NULL) {
+			continue;
+		}
+		fail_unless(num < MAX_ENTRIES, "too many entries");
+		offset[num] = size[num] = 0;
+		sscanf(s + strlen(LOADER_PREFIX), "%31[a-z0-9_], %d, %d",
+		       name[num], &offset[num], &size[num]);
+		num++;
+	}
+
+	return num;
+}
+
+TEST(test_format_magic)
+{
+	static char loader[MAX_ENTRIES][32], magic[MAX_ENTRIES][32];
+	static int offset[MAX_ENTRIES], size[MAX_ENTRIES];
+	int num_loaders, num_magic;
+	int i, j;
+	FILE *f;
+
+	f = fopen("../src/format.c", "r");
+	fail_unless(f != NULL, "can't open format.c");
+
+	num_loaders = read_table(f, "format_loaders[", loader, offset, size);
+	num_magic = read_table(f, "format_magic[] =", magic, offset, size);
+	fclose(f);
+
+	fail_unless(num_loaders > 0, "format_loaders[] not found");
+	fail_unless(num_magic > 0, "format_magic[] not found");
+
+	for (j = 0; j < num_magic; j++) {
+		fail_unless(size[j] > 0 && offset[j] >= 0, "invalid magic size");
+		fail_unless(offset[j] + size[j] <= FORMAT_MAGIC_SIZE,
+			    "magic beyond FORMAT_MAGIC_SIZE");
+	}
+
+	for (i = j = 0; i < num_loaders; i++) {
+		while (j < num_magic && strcmp(magic[j], loader[i]) == 0) {
+			j++;
+		}
+	}
+	fail_unless(j == num_magic, "format_magic[] out of loader order");
+}
+END_TEST
@@ -0,0 +1,90 @@
+#include "test.h"
+#include "../src/mixer.h"
+#include "../src/virtual.h"
+
+/* Seeking advances the voices without mixing. Check that the voices end
+ * at the same sample positions as when the same frames are mixed. */
+
+static const char *const modules[] = {
+	"openmpt/it/Bidi-Loops.it",
+	"openmpt/it/SusAfterLoop.it",
+	"openmpt/mod/PTInstrSwap.mod",
+	"openmpt/mod/PTSwapNoLoop.mod",
+	"data/reverse_it.it",
+	"data/bidi_sync.it",
+	NULL
+};
+
+static xmp_context create_player(const char *mod)
+{
+	xmp_context opaque;
+	int ret;
+
+	opaque = xmp_create_context();
+	ret = xmp_load_module(opaque, mod);
+	fail_unless(ret == 0, "module load error");
+	xmp_start_player(opaque, 44100, 0);
+
+	return opaque;
+}
+
+static void check_seek(const char *mod, int time)
+{
+	xmp_context o1, o2;
+	struct player_data *p1, *p2;
+	struct mixer_voice *v1, *v2;
+	int i;
+
+	o1 = create_player(mod);
+	o2 = create_player(mod);
+	p1 = &((struct context_data *)o1)->p;
+	p2 = &((struct context_data *)o2)->p;
+
+	xmp_seek_time_frame(o1, time);
+
+	/* Play the same frames mixing them */
+	xmp_seek_time(o2, time);
+	for (i = 0; i < (1 << 13); i++) {
+		if (p2->pos == p1->pos && p2->row == p1->row &&
+		    p2->frame == p1->frame &&
+		    p2->current_time == p1->current_time)
+			break;
+		fail_unless(xmp_play_frame(o2) == 0, "play frame");
+	}
+	fail_unless(i < (1 << 13), "frame not reached");
+
+	fail_unless(p1->virt.maxvoc == p2->virt.maxvoc, "voices");
+	for (i = 0; i < p1->virt.maxvoc; i++) {
+		v1 = &p1->virt.voice_array[i];
+		v2 = &p2->virt.voice_array[i];
+		fail_unless(v1->chn == v2->chn, "voice channel");
+		if (v1->chn < 0)
+			continue;
+		fail_unless(v1->smp == v2->smp, "voice sample");
+		fail_unless(v1->pos == v2->pos, "voice position");
+		fail_unless(v1->start == v2->start, "voice loop start");
+		fail_unless(v1->end == v2->end, "voice loop end");
+		fail_unless((v1->flags & ~ANTICLICK) == (v2->flags & ~ANTICLICK),
+			    "voice flags");
+		fail_unless(v1->fidx == v2->fidx, "voice active");
+	}
+
+	xmp_end_player(o1);
+	xmp_release_module(o1);
+	xmp_free_context(o1);
+	xmp_end_player(o2);
+	xmp_release_module(o2);
+	xmp_free_context(o2);
+}
+
+TEST(test_mixer_advance)
+{
+	int i;
+
+	for (i = 0; modules[i] != NULL; i++) {
+		check_seek(modules[i], 1234);
+		check_seek(modules[i], 4321);
+		check_seek(modules[i], 60000);
+	}
+}
+END_TEST
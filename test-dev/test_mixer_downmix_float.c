@@ -0,0 +1,45 @@
+#include "test.h"
+
+TEST(test_mixer_downmix_float)
+{
+	xmp_context opaque, opaque2;
+	struct xmp_frame_info info, info2;
+	int i, j;
+
+	opaque = xmp_create_context();
+	opaque2 = xmp_create_context();
+
+	xmp_load_module(opaque, "data/test.xm");
+	xmp_load_module(opaque2, "data/test.xm");
+
+	new_event((struct context_data *)opaque, 0, 0, 0, 48, 1, 0, 0x0f, 2, 0, 0);
+	new_event((struct context_data *)opaque2, 0, 0, 0, 48, 1, 0, 0x0f, 2, 0, 0);
+
+	xmp_start_player(opaque, 22050, XMP_FORMAT_FLOAT);
+	xmp_start_player(opaque2, 22050, 0);
+
+	/* Float output should match 16-bit output scaled to [-1, 1] */
+	for (i = 0; i < 2; i++) {
+		float *b;
+		int16 *b2;
+		xmp_play_frame(opaque);
+		xmp_play_frame(opaque2);
+		xmp_get_frame_info(opaque, &info);
+		xmp_get_frame_info(opaque2, &info2);
+		b = (float *)info.buffer;
+		b2 = (int16 *)info2.buffer;
+		fail_unless(info.buffer_size == info2.buffer_size * 2, "buffer size");
+		for (j = 0; j < info2.buffer_size / 2; j++) {
+			double val = b[j] * 32768.0;
+			fail_unless(fabs(val - b2[j]) <= 1.0, "downmix error");
+		}
+	}
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+	xmp_end_player(opaque2);
+	xmp_release_module(opaque2);
+	xmp_free_context(opaque2);
+}
+END_TEST
@@ -0,0 +1,113 @@
+#include "test.h"
+#include "../src/mixer.h"
+#include "../src/virtual.h"
+
+/* The voice used by a new note should be the free voice with the lowest
+ * number or, if no voices are free, the background voice with the lowest
+ * volume and the lowest number.
+ */
+static int expected_voice(struct player_data *p)
+{
+	int i, num = -1, vol = INT_MAX;
+
+	for (i = 0; i < p->virt.maxvoc; i++) {
+		if (p->virt.voice_array[i].chn < 0)
+			return i;
+	}
+
+	for (i = 0; i < p->virt.maxvoc; i++) {
+		struct mixer_voice *vi = &p->virt.voice_array[i];
+
+		if (vi->chn >= p->virt.num_tracks && vi->vol < vol) {
+			num = i;
+			vol = vi->vol;
+		}
+	}
+
+	return num;
+}
+
+static void check_heaps(struct player_data *p)
+{
+	int i, num_free = 0, num_bg = 0;
+
+	for (i = 0; i < p->virt.maxvoc; i++) {
+		struct mixer_voice *vi = &p->virt.voice_array[i];
+
+		if (vi->chn < 0) {
+			num_free++;
+		} else if (vi->chn >= p->virt.num_tracks) {
+			num_bg++;
+			fail_unless(p->virt.bg_voice[p->virt.bg_pos[i]] == i,
+				    "background voice position");
+		} else {
+			fail_unless(p->virt.bg_pos[i] < 0,
+				    "foreground voice in background heap");
+		}
+	}
+
+	fail_unless(p->virt.num_free == num_free, "number of free voices");
+	fail_unless(p->virt.num_bg == num_bg, "number of background voices");
+}
+
+TEST(test_player_voice_steal)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct player_data *p;
+	static char state[200000];
+	int i, j, voc, ret;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+	p = &ctx->p;
+
+	create_simple_module(ctx, 2, 2);
+	set_instrument_nna(ctx, 0, 0, XMP_INST_NNA_CONT, XMP_INST_DCT_OFF,
+							XMP_INST_DCA_CUT);
+
+	/* Notes with repeating volumes, so some background voices have
+	 * the same volume */
+	for (i = 0; i < 64; i++) {
+		new_event(ctx, 0, i, 0, 60, 1, 8 + 12 * ((i * 3) % 5), 0, 0, 0, 0);
+	}
+	set_quirk(ctx, QUIRKS_IT, READ_EVENT_IT);
+
+	xmp_set_player(opaque, XMP_PLAYER_VOICES, 6);
+	xmp_start_player(opaque, 44100, 0);
+	fail_unless(p->virt.maxvoc == 6, "number of voices");
+
+	for (i = 0; i < 64; i++) {
+		voc = expected_voice(p);
+
+		xmp_play_frame(opaque);
+		check_heaps(p);
+		fail_unless(map_channel(p, 0) == voc, "voice allocation");
+
+		for (j = 1; j < p->speed; j++) {
+			xmp_play_frame(opaque);
+			check_heaps(p);
+		}
+
+		/* Voices are restored with the player state */
+		if (i == 20) {
+			ret = xmp_save_state(opaque, state, sizeof(state));
+			fail_unless(ret > 0, "can't save state");
+		} else if (i == 40) {
+			ret = xmp_restore_state(opaque, state, sizeof(state));
+			fail_unless(ret == 0, "can't restore state");
+			check_heaps(p);
+		}
+	}
+
+	/* Restart resets all voices */
+	xmp_restart_module(opaque);
+	xmp_play_frame(opaque);
+	check_heaps(p);
+	fail_unless(map_channel(p, 0) == 0, "voice allocation after restart");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+END_TEST
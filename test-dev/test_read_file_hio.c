@@ -0,0 +1,63 @@
+#include "test.h"
+#include "../src/hio.h"
+
+/* Files opened by path may be memory mapped; make sure the handle
+ * behaves exactly like the stdio handle. */
+
+TEST(test_read_file_hio)
+{
+	HIO_HANDLE *h;
+	FILE *f;
+	uint8 *buf, *buf2;
+	long size;
+	int x;
+
+	f = fopen("data/test.xm", "rb");
+	fail_unless(f != NULL, "can't open data file");
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	buf = (uint8 *)malloc(size);
+	buf2 = (uint8 *)malloc(size);
+	fail_unless(buf != NULL && buf2 != NULL, "can't alloc buffers");
+	x = fread(buf, 1, size, f);
+	fail_unless(x == size, "fread");
+	fclose(f);
+
+	h = hio_open("data/test.xm", "rb");
+	fail_unless(h != NULL, "hio_open");
+#ifdef HAVE_MMAP
+	fail_unless(HIO_HANDLE_TYPE(h) == HIO_HANDLE_TYPE_MMAP, "not mapped");
+	fail_unless(hio_get_underlying_memory(h) != NULL, "no underlying memory");
+#endif
+	fail_unless(hio_size(h) == size, "hio_size");
+
+	x = hio_read(buf2, 1, size, h);
+	fail_unless(x == size, "hio_read");
+	fail_unless(memcmp(buf, buf2, size) == 0, "data mismatch");
+	fail_unless(hio_error(h) == 0, "hio_error");
+
+	x = hio_read8(h);
+	fail_unless(hio_eof(h) != 0, "eof");
+
+	x = hio_seek(h, 17, SEEK_SET);
+	fail_unless(x == 0, "hio_seek SEEK_SET");
+	x = hio_read32l(h);
+	fail_unless(x == (int)readmem32l(buf + 17), "hio_read32l");
+	x = hio_tell(h);
+	fail_unless(x == 21, "hio_tell");
+
+	/* Replace the mapping with a memory buffer, as the depackers do */
+	memset(buf2, 0, size);
+	x = hio_reopen_mem(buf2, size, 1, h);
+	fail_unless(x == 0, "hio_reopen_mem");
+	fail_unless(HIO_HANDLE_TYPE(h) == HIO_HANDLE_TYPE_MEMORY, "not memory");
+	x = hio_read32l(h);
+	fail_unless(x == 0, "hio_read32l");
+
+	x = hio_close(h);
+	fail_unless(x == 0, "hio_close");
+	free(buf);
+}
+END_TEST
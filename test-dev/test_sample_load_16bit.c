@@ -5,7 +5,7 @@
   s.len = (x); s.lps = (y); s.lpe = (z); s.flg = (w); s.data = NULL; \
 } while (0)
 
-#define CLEAR() do { libxmp_free_sample(&s); } while (0)
+#define CLEAR() do { libxmp_free_sample(&m, &s); } while (0)
 
 TEST(test_sample_load_16bit)
 {
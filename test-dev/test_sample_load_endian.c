@@ -23,7 +23,7 @@ TEST(test_sample_load_endian)
 		fail_unless(memcmp(xxs.data, conv_r1, 10) == 0,
 					"Invalid conversion from big-endian");
 	}
-	libxmp_free_sample(&xxs);
+	libxmp_free_sample(&m, &xxs);
 
 	/* Now the sample is little-endian */
 	libxmp_load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD, &xxs, conv_r0);
@@ -34,6 +34,6 @@ TEST(test_sample_load_endian)
 		fail_unless(memcmp(xxs.data, conv_r0, 10) == 0,
 					"Invalid conversion from little-endian");
 	}
-	libxmp_free_sample(&xxs);
+	libxmp_free_sample(&m, &xxs);
 }
 END_TEST
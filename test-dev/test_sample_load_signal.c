@@ -28,12 +28,12 @@ TEST(test_sample_load_signal)
 	libxmp_load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_UNS, &xxs, buffer0);
 	fail_unless(memcmp(xxs.data, conv_r0, 10) == 0,
 				"Invalid 8-bit conversion");
-	libxmp_free_sample(&xxs);
+	libxmp_free_sample(&m, &xxs);
 
 	xxs.flg = XMP_SAMPLE_16BIT;
 	libxmp_load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_UNS, &xxs, buffer1);
 	fail_unless(memcmp(xxs.data, conv_r1, 20) == 0,
 				"Invalid 16-bit conversion");
-	libxmp_free_sample(&xxs);
+	libxmp_free_sample(&m, &xxs);
 }
 END_TEST